@@ -2,7 +2,8 @@
 path.py
 
 Plugs into the routine module to allow for the easy construction of paths and
-path following.
+path following. Paths are found by the mud itself (see room.path_to); the
+searches written in Python are kept for when rooms need to be ignored.
 '''
 import mud, mudsys, room
 
@@ -133,8 +134,18 @@ def shortest_path_dfs(frm, to, ignore_doors = False, stay_zone = True,
 
     return path
 
-# set whether we are using bfs or dfs as our main pathing method
-shortest_path = shortest_path_bfs
+def shortest_path_native(frm, to, ignore_doors = True, stay_zone = True,
+                         ignore = None):
+    '''calculates the shortest path using the mud's own pathfinding, which
+       remembers paths within a zone until its exits change. Falls back on a
+       breadth-first search if there are rooms to ignore.
+    '''
+    if ignore:
+        return shortest_path_bfs(frm, to, ignore_doors, stay_zone, ignore)
+    return frm.path_to(to, ignore_doors, stay_zone)
+
+# set whether we are using native, bfs or dfs as our main pathing method
+shortest_path = shortest_path_native
 
 def path_to_dirs(path):
     '''takes a path of rooms and converts it to directions'''
@@ -151,7 +162,7 @@ def path_to_dirs(path):
     # return the directions we generated, if any
     return dirs
 
-def build_patrol(rms, reverse = True, ignore_doors = False, stay_zone = True):
+def build_patrol(rms, reverse = True, ignore_doors = True, stay_zone = True):
     '''builds a set of directions that need to be followed to do a patrol
        between the rooms. If reverse is true, also supplies the directions
        to loop back on itself'''
@@ -160,19 +171,18 @@ def build_patrol(rms, reverse = True, ignore_doors = False, stay_zone = True):
         loopback.reverse()
         rms      = rms + loopback[1:]
 
-    path = []
+    dirs = []
     i    = 0
     while i < len(rms) - 1:
-        path.extend(shortest_path(rms[i], rms[i+1], ignore_doors, stay_zone))
+        leg = rms[i].dirs_to(rms[i+1], ignore_doors, stay_zone)
+        if leg != None:
+            dirs.extend(leg)
         i += 1
-    return path_to_dirs(path)
+    return dirs
 
-def step(frm, to, ignore_doors = False, stay_zone = True):
+def step(frm, to, ignore_doors = True, stay_zone = True):
     '''returns the first step needed to take to go from one room to another'''
-    steps = shortest_path(frm, to, ignore_doors, stay_zone)
-    if steps == None or len(steps) <= 1:
-        return None
-    return path_to_dirs(steps)[0]
+    return frm.step_to(to, ignore_doors, stay_zone)
 
 
 
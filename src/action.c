@@ -91,9 +91,9 @@ void stop_all_actions(CHAR_DATA *ch) {
 }
 
 // allows stop_all_actions to run as a hook
-void stop_actions_hook(const char *info) {
+void stop_actions_hook(HOOK_ARGS *args) {
   CHAR_DATA *ch = NULL;
-  hookParseInfo(info, &ch);
+  hookParseArgs(args, &ch);
   stop_all_actions(ch);
 }
 
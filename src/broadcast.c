@@ -0,0 +1,173 @@
+//*****************************************************************************
+//
+// broadcast.c
+//
+// Keeps track of who messages sent to the whole game can reach. Each player we
+// know about remembers which groups they were put under and whether they were
+// put with the outdoor players, so they can be taken back out again without
+// having to search every index for them.
+//
+//*****************************************************************************
+
+#include "mud.h"
+#include "utils.h"
+#include "character.h"
+#include "room.h"
+#include "broadcast.h"
+
+
+
+//*****************************************************************************
+// local datastructures, functions, and defines
+//*****************************************************************************
+
+//
+// where we have put a player
+typedef struct {
+  char *group_bits; // our user groups, as they were when we were listed
+  LIST     *groups; // the groups we are listed under
+  bool    outdoors; // are we listed as being outdoors?
+} BROADCAST_ENTRY;
+
+// every player, and where we have put them
+MAP       *broadcast_entries = NULL;
+
+// the indexes themselves
+LIST      *player_list       = NULL;
+HASHTABLE *group_players     = NULL; // group name : list of players
+LIST      *outdoor_players   = NULL;
+
+BROADCAST_ENTRY *newBroadcastEntry(void) {
+  BROADCAST_ENTRY *entry = malloc(sizeof(BROADCAST_ENTRY));
+  entry->group_bits = strdup("");
+  entry->groups     = newList();
+  entry->outdoors   = FALSE;
+  return entry;
+}
+
+void deleteBroadcastEntry(BROADCAST_ENTRY *entry) {
+  deleteListWith(entry->groups, free);
+  free(entry->group_bits);
+  free(entry);
+}
+
+//
+// returns whether the character should be listed at all
+bool broadcast_reaches(CHAR_DATA *ch) {
+  return (setIn(mobile_set, ch) &&
+	  (!charIsNPC(ch) || charGetSocket(ch) != NULL));
+}
+
+//
+// returns whether the character is in a room that is outdoors
+bool broadcast_is_outdoors(CHAR_DATA *ch) {
+  return (charGetRoom(ch) != NULL &&
+	  roomGetTerrain(charGetRoom(ch)) != TERRAIN_INDOORS &&
+	  roomGetTerrain(charGetRoom(ch)) != TERRAIN_CAVERN);
+}
+
+//
+// take the player out of all of the group lists they are in
+void broadcast_ungroup(CHAR_DATA *ch, BROADCAST_ENTRY *entry) {
+  char *group = NULL;
+  while((group = listPop(entry->groups)) != NULL) {
+    LIST *players = hashGet(group_players, group);
+    if(players != NULL) {
+      listRemove(players, ch);
+      if(listSize(players) == 0)
+	deleteList(hashRemove(group_players, group));
+    }
+    free(group);
+  }
+}
+
+//
+// put the player into the lists for the groups they are in now
+void broadcast_group_up(CHAR_DATA *ch, BROADCAST_ENTRY *entry) {
+  LIST           *groups = parse_keywords(entry->group_bits);
+  LIST_ITERATOR *group_i = newListIterator(groups);
+  char            *group = NULL;
+  ITERATE_LIST(group, group_i) {
+    LIST *players = hashGet(group_players, group);
+    if(players == NULL) {
+      players = newList();
+      hashPut(group_players, group, players);
+    }
+    listQueue(players, ch);
+    listQueue(entry->groups, strdup(group));
+  } deleteListIterator(group_i);
+  deleteListWith(groups, free);
+}
+
+
+
+//*****************************************************************************
+// implementation of broadcast.h
+//*****************************************************************************
+void init_broadcast(void) {
+  broadcast_entries = newMap(NULL, NULL);
+  player_list       = newList();
+  group_players     = newHashtable();
+  outdoor_players   = newList();
+}
+
+void broadcast_update(CHAR_DATA *ch) {
+  BROADCAST_ENTRY *entry = mapGet(broadcast_entries, ch);
+
+  // someone we do not know about, who we still do not need to know about.
+  // This is by far the most common case, so check it first
+  if(entry == NULL && (charIsNPC(ch) && charGetSocket(ch) == NULL))
+    return;
+
+  // a player leaving the game (or an NPC someone has let go of)
+  if(!broadcast_reaches(ch)) {
+    if(entry != NULL) {
+      mapRemove(broadcast_entries, ch);
+      listRemove(player_list, ch);
+      if(entry->outdoors)
+	listRemove(outdoor_players, ch);
+      broadcast_ungroup(ch, entry);
+      deleteBroadcastEntry(entry);
+    }
+    return;
+  }
+
+  // someone new
+  if(entry == NULL) {
+    entry = newBroadcastEntry();
+    mapPut(broadcast_entries, ch, entry);
+    listQueue(player_list, ch);
+  }
+
+  // re-list us if our groups have changed
+  const char *group_bits = bitvectorGetBits(charGetUserGroups(ch));
+  if(strcmp(group_bits, entry->group_bits)) {
+    free(entry->group_bits);
+    entry->group_bits = strdup(group_bits);
+    broadcast_ungroup(ch, entry);
+    broadcast_group_up(ch, entry);
+  }
+
+  // and they might have gone inside or outside
+  bool outdoors = broadcast_is_outdoors(ch);
+  if(outdoors && !entry->outdoors)
+    listQueue(outdoor_players, ch);
+  else if(!outdoors && entry->outdoors)
+    listRemove(outdoor_players, ch);
+  entry->outdoors = outdoors;
+}
+
+LIST *broadcast_players(void) {
+  return player_list;
+}
+
+LIST *broadcast_group(const char *group) {
+  // logs are sent to groups from the moment we boot, before we are initialized
+  if(group_players == NULL)
+    return NULL;
+  return hashGet(group_players, group);
+}
+
+LIST *broadcast_outdoors(void) {
+  return outdoor_players;
+}
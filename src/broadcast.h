@@ -0,0 +1,44 @@
+#ifndef BROADCAST_H
+#define BROADCAST_H
+//*****************************************************************************
+//
+// broadcast.h
+//
+// Keeps track of who messages sent to the whole game can reach, so things like
+// logs, chat, and the weather do not have to look at every mobile in the world
+// to find the few people who will actually hear them. Three indexes are kept:
+// the players in the game, the players in each user group, and the players who
+// are outdoors. "Players" are player characters, plus anything else someone is
+// connected to.
+//
+// Indexes are kept current by calling broadcast_update whenever something that
+// decides where a character belongs changes: when they enter or leave the game
+// or a room, when a socket is attached to or detached from them, when their
+// user groups are changed, or when the terrain of their room changes.
+//
+//*****************************************************************************
+
+//
+// prepare the broadcast indexes for use
+void init_broadcast(void);
+
+//
+// look at the character again, and put them in (or take them out of) each
+// index they now belong in (or no longer belong in)
+void broadcast_update(CHAR_DATA *ch);
+
+//
+// returns the players in the game. The list must not be changed or deleted
+LIST *broadcast_players(void);
+
+//
+// returns the players in a user group. The list must not be changed or
+// deleted. NULL is returned if nobody is in the group
+LIST *broadcast_group(const char *group);
+
+//
+// returns the players in rooms that are not indoors or in caverns. The list
+// must not be changed or deleted
+LIST *broadcast_outdoors(void);
+
+#endif // BROADCAST_H
@@ -20,6 +20,9 @@ void deleteBuffer(BUFFER *buf);
 void        bufferCat   (BUFFER *buf, const char *txt);
 void        bufferCatCh (BUFFER *buf, const char ch);
 
+// concatinate the first len characters of the text to the end of the buffer
+void    bufferCatLength (BUFFER *buf, const char *txt, int len);
+
 // clear the buffer's contents
 void bufferClear(BUFFER *buf);
 
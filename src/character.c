@@ -18,6 +18,9 @@
 #include "auxiliary.h"
 #include "storage.h"
 #include "character.h"
+#include "broadcast.h"
+#include "keyword_index.h"
+#include "visibility.h"
 
 const char *sex_names[NUM_SEXES] = {
   "male",
@@ -298,6 +301,7 @@ BITVECTOR *charGetUserGroups(CHAR_DATA *ch) {
 
 void         charSetSocket    ( CHAR_DATA *ch, SOCKET_DATA *socket) {
   ch->socket = socket;
+  broadcast_update(ch);
 }
 
 void         charSetRoom      ( CHAR_DATA *ch, ROOM_DATA *room) {
@@ -325,6 +329,7 @@ void charAddPrototype(CHAR_DATA *ch, const char *prototype) {
 void         charSetName      ( CHAR_DATA *ch, const char *name) {
   if(ch->name) free(ch->name);
   ch->name = strdupsafe(name);
+  keyword_index_char(ch);
 }
 
 void         charSetSex       ( CHAR_DATA *ch, int sex) {
@@ -333,10 +338,12 @@ void         charSetSex       ( CHAR_DATA *ch, int sex) {
 
 void         charSetPos       ( CHAR_DATA *ch, int pos) {
   ch->position = pos;
+  visibility_changed(ch);
 }
 
 void         charSetHidden    ( CHAR_DATA *ch, int amnt) {
   ch->hidden = amnt;
+  visibility_changed(ch);
 }
 
 void charSetWeight(CHAR_DATA *ch, double amnt) {
@@ -363,6 +370,10 @@ void         charSetUID(CHAR_DATA *ch, int uid) {
   ch->uid = uid;
 }
 
+void         charSetBirth(CHAR_DATA *ch, time_t birth) {
+  ch->birth = birth;
+}
+
 void         charResetBody(CHAR_DATA *ch) {
   charSetBody(ch, raceCreateBody(ch->race));
 }
@@ -529,6 +540,7 @@ CHAR_DATA *charCopy( CHAR_DATA *mob) {
 void charSetKeywords(CHAR_DATA *ch, const char *keywords) {
   if(ch->keywords) free(ch->keywords);
   ch->keywords = strdupsafe(keywords);
+  keyword_index_char(ch);
 }
 
 const char  *charGetKeywords   ( CHAR_DATA *ch) {
@@ -112,6 +112,7 @@ void         charSetMultiName (CHAR_DATA *ch, const char *multi_name);
 void         charSetBody      (CHAR_DATA *ch, BODY_DATA *body);
 void         charSetRace      (CHAR_DATA *ch, const char *race);
 void         charSetUID       (CHAR_DATA *ch, int uid);
+void         charSetBirth     (CHAR_DATA *ch, time_t birth);
 void         charSetLoadroom  (CHAR_DATA *ch, const char *key);
 void         charSetFurniture (CHAR_DATA *ch, OBJ_DATA *furniture);
 void         charSetPos       (CHAR_DATA *ch, int pos);
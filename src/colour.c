@@ -0,0 +1,113 @@
+//*****************************************************************************
+//
+// colour.c
+//
+// Colour codes embedded in outbound text are expanded into escape sequences
+// right before the text is sent to a socket. Every possible code has an entry
+// in a table for each type of terminal, so expanding a code is one lookup.
+// Text between codes is copied over in chunks.
+//
+//*****************************************************************************
+
+#include "mud.h"
+#include "utils.h"
+#include "colour.h"
+
+
+
+//*****************************************************************************
+// local variables, datastructures, functions, and defines
+//*****************************************************************************
+
+// what each code expands to, for each type of terminal. NULL if the character
+// is not a colour code
+char *colour_table[NUM_COLOUR_MODES][256];
+int     colour_len[NUM_COLOUR_MODES][256];
+
+// where we do our expanding before it is copied back to the outbound buffer
+BUFFER *colour_buf = NULL;
+
+//
+// set what a code expands to for one type of terminal
+void colour_table_set(int mode, unsigned char code, const char *seq) {
+  if(colour_table[mode][code] != NULL)
+    free(colour_table[mode][code]);
+  colour_table[mode][code] = (seq ? strdup(seq) : NULL);
+  colour_len[mode][code]   = (seq ? strlen(seq) : 0);
+}
+
+
+
+//*****************************************************************************
+// implementation of colour.h
+//*****************************************************************************
+void init_colour(void) {
+  // the base colours. Lower case is dark, upper case is bright
+  static const char *codes   = "ndrgybpcw";
+  static const char *colours[] = { "0", "30", "31", "32", "33", "34", "35",
+				   "36", "37" };
+  char seq[SMALL_BUFFER];
+  int i;
+
+  colour_buf = newBuffer(MAX_BUFFER);
+  for(i = 0; codes[i] != '\0'; i++) {
+    sprintf(seq, "\033[0;%sm", colours[i]);
+    colourAdd(codes[i], seq, NULL);
+    sprintf(seq, "\033[1;%sm", colours[i]);
+    colourAdd(toupper(codes[i]), seq, NULL);
+  }
+}
+
+void colourAdd(char code, const char *ansi, const char *xterm) {
+  // a marker followed by another marker is always a literal marker
+  if(code == COLOUR_MARKER || code == '\0')
+    return;
+  colour_table_set(COLOUR_NONE, code, "");
+  colour_table_set(COLOUR_16,   code, ansi);
+  colour_table_set(COLOUR_256,  code, (xterm ? xterm : ansi));
+}
+
+void colourRemove(char code) {
+  int mode;
+  for(mode = 0; mode < NUM_COLOUR_MODES; mode++)
+    colour_table_set(mode, code, NULL);
+}
+
+void colourExpand(BUFFER *buf, const char *txt, int mode) {
+  const char *marker = NULL;
+  if(mode < 0 || mode >= NUM_COLOUR_MODES)
+    mode = COLOUR_16;
+
+  while((marker = strchr(txt, COLOUR_MARKER)) != NULL) {
+    unsigned char code = marker[1];
+
+    // copy everything up to the marker
+    if(marker > txt)
+      bufferCatLength(buf, txt, marker - txt);
+
+    // a valid code
+    if(colour_table[mode][code] != NULL) {
+      bufferCatLength(buf, colour_table[mode][code], colour_len[mode][code]);
+      txt = marker + 2;
+    }
+    // not a code. Leave the marker, and keep going after it. Two markers in
+    // a row are turned into one
+    else {
+      bufferCatCh(buf, COLOUR_MARKER);
+      txt = marker + (code == COLOUR_MARKER ? 2 : 1);
+    }
+  }
+
+  // copy whatever is left over
+  bufferCat(buf, txt);
+}
+
+void bufferExpandColour(BUFFER *buf, int mode) {
+  // no codes in the buffer, nothing to do
+  if(strchr(bufferString(buf), COLOUR_MARKER) == NULL)
+    return;
+  bufferClear(colour_buf);
+  colourExpand(colour_buf, bufferString(buf), mode);
+  bufferClear(buf);
+  bufferCatLength(buf, bufferString(colour_buf), bufferLength(colour_buf));
+}
@@ -0,0 +1,51 @@
+#ifndef COLOUR_H
+#define COLOUR_H
+//*****************************************************************************
+//
+// colour.h
+//
+// Colour codes embedded in outbound text (e.g. {r for red, {W for bright
+// white, {n for normal, {{ for a literal brace) are expanded into escape
+// sequences right before the text is sent to a socket, after every
+// process_outbound hook has had its say. How each code is expanded depends on
+// the socket's colour mode: nothing (codes are stripped), the 16 basic ANSI
+// colours, or 256 colours/truecolour. Modules can add their own codes, with a
+// different expansion for each mode.
+//
+//*****************************************************************************
+
+// what sort of colour a socket can display
+#define COLOUR_NONE               0
+#define COLOUR_16                 1
+#define COLOUR_256                2
+#define NUM_COLOUR_MODES          3
+
+// the symbol that starts a colour code
+#define COLOUR_MARKER           '{'
+
+//
+// prepare the base colour codes for use
+void init_colour(void);
+
+//
+// add a new colour code, or change an existing one. ansi is what the code is
+// expanded to for sockets that can display the 16 basic colours. xterm is what
+// it is expanded to for sockets that can display 256 colours or truecolour.
+// If xterm is NULL, ansi is used for those sockets as well. Codes are always
+// stripped from text sent to sockets that cannot display colour.
+void colourAdd(char code, const char *ansi, const char *xterm);
+
+//
+// stop expanding the colour code. It will be sent as-is
+void colourRemove(char code);
+
+//
+// expand all of the colour codes in the text for the given type of terminal,
+// and append the result to the buffer
+void colourExpand(BUFFER *buf, const char *txt, int mode);
+
+//
+// expand all of the colour codes in the buffer for the given type of terminal
+void bufferExpandColour(BUFFER *buf, int mode);
+
+#endif // COLOUR_H
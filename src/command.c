@@ -34,6 +34,7 @@ struct cmd_data {
   char       *name;
   CMD_PTR(func);
   PyObject *pyfunc;
+  PyObject *pyname; // our name as a Python string, for calling Python with
   char *user_group;
   bool  interrupts;
   LIST     *checks;
@@ -44,6 +45,18 @@ typedef struct cmd_check_data {
   PyObject *pyfunc;
 } CMD_CHK_DATA;
 
+// argument tuples we reuse when calling Python commands and checks
+PyObject *py_cmd_args = NULL;
+PyObject *py_chk_args = NULL;
+
+//
+// returns our name as an interned Python string, creating it if need be
+PyObject *cmdGetPyName(CMD_DATA *cmd) {
+  if(cmd->pyname == NULL)
+    cmd->pyname = PyString_InternFromString(cmd->name);
+  return cmd->pyname;
+}
+
 
 
 //*****************************************************************************
@@ -103,6 +116,7 @@ CMD_DATA *newPyCmd(const char *name, void *pyfunc, const char *user_group,
   cmd->name       = strdupsafe(name);
   cmd->checks     = newList();
   cmdPyUpdate(cmd, pyfunc, user_group, interrupts);
+  cmdGetPyName(cmd);
   return cmd;
 }
 
@@ -130,6 +144,7 @@ void deleteCmd(CMD_DATA *cmd) {
   if(cmd->name)       free(cmd->name);
   if(cmd->user_group) free(cmd->user_group);
   if(cmd->pyfunc)     { Py_DECREF(cmd->pyfunc); }
+  if(cmd->pyname)     { Py_DECREF(cmd->pyname); }
   if(cmd->checks)     deleteListWith(cmd->checks, deleteCmdCheck);
   free(cmd);
 }
@@ -151,7 +166,10 @@ void cmdCopyTo(CMD_DATA *from, CMD_DATA *to) {
   if(to->name)       free(to->name);
   if(to->user_group) free(to->user_group);
   if(to->pyfunc)     { Py_DECREF(to->pyfunc); }
+  if(to->pyname)     { Py_DECREF(to->pyname); }
   to->name         = strdup(from->name);
+  to->pyname       = from->pyname;
+  if(to->pyname)     { Py_INCREF(to->pyname); }
   to->user_group   = strdup(from->user_group);
   to->pyfunc       = from->pyfunc;
   if(to->pyfunc)     { Py_INCREF(to->pyfunc); }
@@ -183,6 +201,7 @@ void cmdAddCheck(CMD_DATA *cmd, CMD_CHK(func)) {
 
 void cmdAddPyCheck(CMD_DATA *cmd, void *pyfunc) {
   listPut(cmdGetChecks(cmd), newPyCmdCheck(pyfunc));
+  cmdGetPyName(cmd);
 }
 
 //
@@ -252,31 +271,33 @@ bool max_pos_ok(CHAR_DATA *ch, int minpos) {
 }
 
 bool cmdTryChecks(CHAR_DATA *ch, CMD_DATA *cmd) {
-  bool cmd_ok = TRUE;
-  if(listSize(cmd->checks) > 0) {
-    LIST_ITERATOR *chk_i = newListIterator(cmd->checks);
-    CMD_CHK_DATA    *chk = NULL;
-    ITERATE_LIST(chk, chk_i) {
-      if(chk->func)
-	cmd_ok = (chk->func)(ch, cmd->name);
-      else {
-	PyObject *arglist = Py_BuildValue("Os", charGetPyFormBorrowed(ch), 
-					  cmd->name);
-	PyObject *retval  = PyEval_CallObject(chk->pyfunc, arglist);
-	// check for an error:
-	if(retval == NULL)
-	  log_pyerr("Error running Python command check, %s:", cmd->name);
-	else if(retval == Py_False)
-	  cmd_ok = FALSE;
-
-	// garbage collection
-	Py_XDECREF(retval);
-	Py_XDECREF(arglist);
-      }
-
-      if(cmd_ok == FALSE)
-	break;
-    } deleteListIterator(chk_i);
+  CMD_CHK_DATA *chk = NULL;
+  bool       cmd_ok = TRUE;
+  int             i;
+
+  // checks are run for almost every command typed, so we go through them by
+  // position rather than making an iterator. There are only ever a few
+  for(i = 0; cmd_ok && (chk = listGet(cmd->checks, i)) != NULL; i++) {
+    if(chk->func)
+      cmd_ok = (chk->func)(ch, cmd->name);
+    else {
+      char        owner[SMALL_BUFFER];
+      double      start = script_time_start();
+      PyObject  *retval = PyObject_CallReusingArgs(&py_chk_args, chk->pyfunc,2,
+						   charGetPyFormBorrowed(ch),
+						   cmdGetPyName(cmd));
+      sprintf(owner, "check %s", cmd->name);
+      script_time_stop(start, owner);
+
+      // check for an error:
+      if(retval == NULL)
+	log_pyerr("Error running Python command check, %s:", cmd->name);
+      else if(retval == Py_False)
+	cmd_ok = FALSE;
+
+      // garbage collection
+      Py_XDECREF(retval);
+    }
   }
   return cmd_ok;
 }
@@ -307,16 +328,23 @@ int charTryCmd(CHAR_DATA *ch, CMD_DATA *cmd, char *arg) {
       return TRUE;
     }
     else if(cmd->pyfunc) {
-      PyObject *arglist = Py_BuildValue("Oss", charGetPyFormBorrowed(ch), 
-					cmd->name, arg);
-      PyObject *retval  = PyEval_CallObject(cmd->pyfunc, arglist);
+      char        owner[SMALL_BUFFER];
+      double      start = script_clock();
+      PyObject   *pyarg = PyString_FromString(arg);
+      PyObject  *retval = PyObject_CallReusingArgs(&py_cmd_args, cmd->pyfunc,3,
+						   charGetPyFormBorrowed(ch),
+						   cmdGetPyName(cmd), pyarg);
       // check for an error:
       if(retval == NULL)
 	log_pyerr("Error running Python command, %s:", cmd->name);
 
+      // record how long we took
+      sprintf(owner, "cmd %s", cmd->name);
+      script_usage_add(owner, script_clock() - start, FALSE);
+
       // garbage collection
       Py_XDECREF(retval);
-      Py_XDECREF(arglist);
+      Py_DECREF(pyarg);
       return TRUE;
     }
     // command is null (but there might have been checks)
@@ -15,5 +15,7 @@ COMMAND(cmd_look);
 COMMAND(cmd_groupcmds);
 COMMAND(cmd_more);
 COMMAND(cmd_back);
+COMMAND(cmd_tickstats);
+COMMAND(cmd_idlerooms);
 
 #endif // __COMMANDS_H
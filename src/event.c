@@ -19,11 +19,16 @@
 #include "utils.h"
 #include "character.h"
 #include "hooks.h"
+#include "storage.h"
 #include "event.h"
 
 typedef struct event_data EVENT_DATA;
+typedef struct event_type_data EVENT_TYPE_DATA;
 LIST    *events = NULL;
 
+// event types that know how to store and read themselves, keyed by name
+HASHTABLE *event_types = NULL;
+
 struct event_data {
   void *owner;   // who is the lucky person who owns this event?
   void (*  on_complete)(void *owner, void *data, char *arg);
@@ -35,6 +40,14 @@ struct event_data {
   bool  requeue; // is the event requeue'd after it goes off?
 };
 
+struct event_type_data {
+  char *name;    // the name the event type is stored under
+  void (*  on_complete)(void *owner, void *data, char *arg);
+  bool (*  check_involvement)(void *thing, void *data);
+  STORAGE_SET *(* storer)(void *owner, void *data);
+  bool (*  reader)(STORAGE_SET *set, void **owner, void **data);
+};
+
 
 
 //*****************************************************************************
@@ -69,21 +82,21 @@ void run_event(EVENT_DATA *event) {
     event->on_complete(event->owner, event->data, event->arg);
 }
 
-void interrupt_events_obj_hook(const char *info) {
+void interrupt_events_obj_hook(HOOK_ARGS *args) {
   OBJ_DATA *obj = NULL;
-  hookParseInfo(info, &obj);
+  hookParseArgs(args, &obj);
   interrupt_events_involving(obj);
 }
 
-void interrupt_events_char_hook(const char *info) {
+void interrupt_events_char_hook(HOOK_ARGS *args) {
   CHAR_DATA *ch = NULL;
-  hookParseInfo(info, &ch);
+  hookParseArgs(args, &ch);
   interrupt_events_involving(ch);
 }
 
-void interrupt_events_room_hook(const char *info) {
+void interrupt_events_room_hook(HOOK_ARGS *args) {
   ROOM_DATA *room = NULL;
-  hookParseInfo(info, &room);
+  hookParseArgs(args, &room);
   interrupt_events_involving(room);
 }
 
@@ -93,7 +106,8 @@ void interrupt_events_room_hook(const char *info) {
 // event list handling
 //*****************************************************************************
 void init_events() {
-  events = newList();
+  events      = newList();
+  event_types = newHashtable();
 
   // make sure all events involving the object/char are cancelled when
   // either is extracted from the game
@@ -122,6 +136,23 @@ void interrupt_events_involving(void *thing) {
   deleteListIterator(ev_i);
 }
 
+bool events_involving(void *thing) {
+  LIST_ITERATOR *ev_i = newListIterator(events);
+  EVENT_DATA   *event = NULL;
+  bool          found = FALSE;
+
+  ITERATE_LIST(event, ev_i) {
+    if(event->owner == thing ||
+       (event->check_involvement != NULL && 
+	event->check_involvement(thing, event->data))) {
+      found = TRUE;
+      break;
+    }
+  }
+  deleteListIterator(ev_i);
+  return found;
+}
+
 void start_event(void *owner, 
 		 int   delay,
 		 void *on_complete,
@@ -180,3 +211,84 @@ void pulse_events(int time) {
     }
   } deleteListIterator(ev_i);
 }
+
+
+
+//*****************************************************************************
+// event storage
+//*****************************************************************************
+void register_event_type(const char *name,
+			 void *on_complete,
+			 void *check_involvement,
+			 void *storer,
+			 void *reader) {
+  EVENT_TYPE_DATA *type   = malloc(sizeof(EVENT_TYPE_DATA));
+  type->name              = strdup(name);
+  type->on_complete       = on_complete;
+  type->check_involvement = check_involvement;
+  type->storer            = storer;
+  type->reader            = reader;
+  hashPut(event_types, name, type);
+}
+
+//
+// find the registered event type that completes with on_complete, if any
+EVENT_TYPE_DATA *get_event_type(void *on_complete) {
+  HASH_ITERATOR *type_i = newHashIterator(event_types);
+  EVENT_TYPE_DATA *type = NULL, *found = NULL;
+  const char       *key = NULL;
+  ITERATE_HASH(key, type, type_i) {
+    if(type->on_complete == on_complete) {
+      found = type;
+      break;
+    }
+  } deleteHashIterator(type_i);
+  return found;
+}
+
+STORAGE_SET_LIST *store_events(int *unstored) {
+  STORAGE_SET_LIST *list = new_storage_list();
+  LIST_ITERATOR    *ev_i = newListIterator(events);
+  EVENT_DATA      *event = NULL;
+  *unstored = 0;
+
+  ITERATE_LIST(event, ev_i) {
+    EVENT_TYPE_DATA *type = get_event_type(event->on_complete);
+    STORAGE_SET *data_set = (type ? type->storer(event->owner,event->data):NULL);
+    if(data_set == NULL)
+      (*unstored)++;
+    else {
+      STORAGE_SET *set = new_storage_set();
+      store_string(set, "type",     type->name);
+      store_int   (set, "delay",    event->delay);
+      store_int   (set, "tot_time", event->tot_time);
+      store_bool  (set, "requeue",  event->requeue);
+      store_string(set, "arg",      event->arg);
+      store_set   (set, "data",     data_set);
+      storage_list_put(list, set);
+    }
+  } deleteListIterator(ev_i);
+  return list;
+}
+
+int read_events(STORAGE_SET_LIST *list) {
+  STORAGE_SET *set = NULL;
+  int         read = 0;
+  while( (set = storage_list_next(list)) != NULL) {
+    EVENT_TYPE_DATA *type = hashGet(event_types, read_string(set, "type"));
+    void           *owner = NULL;
+    void            *data = NULL;
+    if(type == NULL || !type->reader(read_set(set, "data"), &owner, &data))
+      continue;
+
+    // queue to the back so we keep the order the events were stored in
+    EVENT_DATA *event = newEvent(owner, read_int(set, "delay"), 
+				 type->on_complete, type->check_involvement,
+				 data, read_string(set, "arg"),
+				 read_bool(set, "requeue"));
+    event->tot_time = read_int(set, "tot_time");
+    listQueue(events, event);
+    read++;
+  }
+  return read;
+}
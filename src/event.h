@@ -39,6 +39,13 @@ void pulse_events(int time);
 void interrupt_events_involving(void *thing);
 
 
+//
+// Returns TRUE if there are any pending events involving "thing", in the
+// same sense as interrupt_events_involving.
+//
+bool events_involving(void *thing);
+
+
 //
 // Put an event into the event handler. When the delay reaches 0, 
 // on_complete is called.
@@ -71,4 +78,37 @@ void start_update(void *owner,
 		  void *data,
 		  const char *arg);
 
+
+//
+// Events are normally lost when the mud reboots or copyovers. An event type
+// that knows how to store and read itself can be carried across a copyover
+// (see snapshot.h). Events are matched to their type by their on_complete
+// function.
+//
+// storer must take the event's owner and data, and return a storage set
+// describing both, or NULL if this particular event cannot be stored. reader
+// takes that storage set, and must fill in the owner and data for the new
+// event. It returns FALSE if the event can no longer be rebuilt (e.g. its 
+// owner no longer exists).
+//
+void register_event_type(const char *name,
+			 void *on_complete,
+			 void *check_involvement,
+			 void *storer,
+			 void *reader);
+
+
+//
+// store all of the pending events that have a registered type. The number of
+// events that could not be stored is put in unstored.
+//
+STORAGE_SET_LIST *store_events(int *unstored);
+
+
+//
+// read in events stored with store_events, and add them to the event handler.
+// Returns how many events were successfully read.
+//
+int read_events(STORAGE_SET_LIST *list);
+
 #endif // __EVENT_H
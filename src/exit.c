@@ -10,6 +10,8 @@
 #include "utils.h"
 #include "storage.h"
 #include "exit.h"
+#include "visibility.h"
+#include "path.h"
 
 #define EX_CLOSED            (1 << 0)
 #define EX_LOCKED            (1 << 1)
@@ -209,11 +211,15 @@ void        exitSetClosable(EXIT_DATA *exit, bool closable) {
 }
 
 void        exitSetClosed(EXIT_DATA *exit, bool closed) {
+  if(exit->room && !closed != !exitIsClosed(exit))
+    path_door_changed(exit->room);
   if(closed)    SET_BIT(exit->status, EX_CLOSED);
   else          REMOVE_BIT(exit->status, EX_CLOSED);
 }
 
 void        exitSetLocked(EXIT_DATA *exit, bool locked) {
+  if(exit->room && !locked != !exitIsLocked(exit))
+    path_door_changed(exit->room);
   if(locked)    SET_BIT(exit->status, EX_LOCKED);
   else          REMOVE_BIT(exit->status, EX_LOCKED);
 }
@@ -225,6 +231,7 @@ void        exitSetKey(EXIT_DATA *exit, const char *key) {
 
 void        exitSetHidden(EXIT_DATA *exit, int hide_lev) {
   exit->hide_lev = hide_lev;
+  visibility_changed(exit);
 }
 
 void        exitSetPickLev(EXIT_DATA *exit, int pick_lev) {
@@ -232,6 +239,8 @@ void        exitSetPickLev(EXIT_DATA *exit, int pick_lev) {
 }
 
 void        exitSetTo(EXIT_DATA *exit, const char *room) {
+  if(exit->room)
+    path_invalidate(exit->room);
   if(exit->to) free(exit->to);
   exit->to = strdupsafe(room);
 }
@@ -73,11 +73,35 @@ FILEBUF *fbopen(const char *fname, const char *mode) {
   return fb;
 }
 
+FILEBUF *fbopen_string(const char *str) {
+  FILEBUF *fb = malloc(sizeof(FILEBUF));
+  fb->fl      = NULL;
+  fb->buf     = newBuffer(strlen(str) + 1);
+  fb->pos     = 0;
+  fb->mode    = FBMODE_READ;
+  bufferCat(fb->buf, str);
+  return fb;
+}
+
+FILEBUF *fbopen_memory(void) {
+  FILEBUF *fb = malloc(sizeof(FILEBUF));
+  fb->fl      = NULL;
+  fb->buf     = newBuffer(1024);
+  fb->pos     = 0;
+  fb->mode    = FBMODE_WRITE;
+  return fb;
+}
+
+const char *fbstring(FILEBUF *fb) {
+  return bufferString(fb->buf);
+}
+
 //
 // close, flush, and delete the buffered file reader
 void fbclose(FILEBUF *fb) {
   fbflush(fb);
-  fclose(fb->fl);
+  if(fb->fl != NULL)
+    fclose(fb->fl);
   deleteBuffer(fb->buf);
   free(fb);
 }
@@ -85,7 +109,8 @@ void fbclose(FILEBUF *fb) {
 //
 // flush the buffered file reader
 void fbflush(FILEBUF *fb) {
-  if(fb->mode == FBMODE_WRITE && bufferLength(fb->buf) > fb->pos) {
+  if(fb->mode == FBMODE_WRITE && fb->fl != NULL &&
+     bufferLength(fb->buf) > fb->pos) {
     const char *to_flush = bufferString(fb->buf);
     fprintf(fb->fl, "%s", to_flush+fb->pos);
     fb->pos = bufferLength(fb->buf);
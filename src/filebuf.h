@@ -15,6 +15,21 @@ typedef struct buffered_file FILEBUF;
 // or appending, specified by the mode
 FILEBUF *fbopen(const char *fname, const char *mode);
 
+//
+// create a new buffered file reader that reads from a string already in
+// memory, instead of from a file on disk
+FILEBUF *fbopen_string(const char *str);
+
+//
+// create a new buffered file writer that writes to a string in memory instead
+// of to a file on disk. The string can be gotten with fbstring before closing
+FILEBUF *fbopen_memory(void);
+
+//
+// return everything that has been written to, or is to be read from, the
+// buffered file
+const char *fbstring(FILEBUF *buf);
+
 //
 // close, flush, and delete the buffered file reader
 void fbclose(FILEBUF *buf);
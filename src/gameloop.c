@@ -24,7 +24,17 @@
 #include "storage.h"
 #include "races.h"
 #include "inform.h"
+#include "colour.h"
 #include "hooks.h"
+#include "snapshot.h"
+#include "world_image.h"
+#include "path.h"
+#include "population.h"
+#include "broadcast.h"
+#include "keyword_index.h"
+#include "visibility.h"
+#include "jobs.h"
+#include "idle_rooms.h"
 
 
 
@@ -93,6 +103,13 @@ PROPERTY_TABLE *sock_table = NULL; // a table of socks by UID, for quick lookup
 BUFFER           *greeting = NULL; // message seen when a socket connects
 BUFFER               *motd = NULL; // what characters see when they log on
 
+// statistics on how long our pulses take to run
+int            tick_pulses = 0;    // pulses run since the stats were cleared
+int            tick_lagged = 0;    // pulses that took longer than a pulse
+double           tick_busy = 0;    // seconds spent running pulses
+double            tick_max = 0;    // the longest pulse we've run
+double             tick_gc = 0;    // seconds of slack spent collecting garbage
+
 
 
 //
@@ -102,10 +119,15 @@ int main(int argc, char **argv)
   extern fd_set fSet;
   int i;
   bool fCopyOver = FALSE;
+  bool fWorldImage = FALSE;
 
   /************************************************************/
   /*                      PARSE OPTIONS                       */
   /************************************************************/
+  // we're just packing the world into an image, not running the mud
+  if(argc == 2 && !strcasecmp(argv[1], "-worldimage"))
+    fWorldImage = TRUE;
+
   for(i = 1; i < argc-1; i++) {
     if(!strcasecmp(argv[i], "-copyover")) {
       fCopyOver = TRUE;
@@ -171,6 +193,10 @@ int main(int argc, char **argv)
   // make a new world
   gameworld = newWorld();
 
+  // if all we're doing is packing the world into an image, do it and quit
+  if(fWorldImage)
+    return (worldImageBuild(WORLD_PATH) ? 0 : 1);
+
 
 
   /************************************************************/
@@ -193,12 +219,36 @@ int main(int argc, char **argv)
   log_string("Initializing inform system.");
   init_inform();
 
+  log_string("Initializing colour codes.");
+  init_colour();
+
+  log_string("Initializing broadcast indexes.");
+  init_broadcast();
+
+  log_string("Initializing keyword indexes.");
+  init_keyword_index();
+
+  log_string("Initializing population counts.");
+  init_population();
+
+  log_string("Initializing idle room unloading.");
+  init_idle_rooms();
+
   log_string("Initializing room resets.");
   init_room_reset();
 
+  log_string("Initializing pathfinding.");
+  init_path();
+
   log_string("Initializing MUD settings.");
   init_mud_settings();
 
+  log_string("Initializing visibility memory.");
+  init_visibility();
+
+  log_string("Starting worker threads.");
+  init_jobs();
+
   log_string("Preparing auxiliary data for usage.");
   init_auxiliaries();
 
@@ -211,6 +261,9 @@ int main(int argc, char **argv)
   log_string("Initializing event handler.");
   init_events();
 
+  log_string("Initializing world snapshots.");
+  init_snapshot();
+
   log_string("Initializing logging system.");
   init_logs();
 
@@ -285,9 +338,20 @@ int main(int argc, char **argv)
   log_string("Loading gameworld.");
   load_muddata();
 
+  // if we're copying over, try to pick up where we left off. Otherwise,
   // force-pulse everything once
-  log_string("Force-resetting world");
-  worldForceReset(gameworld);
+  if(fCopyOver && snapshot_restore_world())
+    log_string("Restored world from snapshot");
+  else {
+    log_string("Force-resetting world");
+    worldForceReset(gameworld);
+  }
+
+  // let us know how well our compiled script cache served us
+  int cache_hits = 0, cache_misses = 0;
+  script_cache_stats(&cache_hits, &cache_misses);
+  log_string("Script cache: %d compiled scripts loaded, %d had to be compiled.",
+	     cache_hits, cache_misses);
 
 
 
@@ -319,6 +383,9 @@ int main(int argc, char **argv)
   log_string("Entering game loop");
   game_loop(control);
 
+  // make sure no work is left half done
+  jobs_finish();
+
   // run our finalize hooks
   hookRun("shutdown", "");
 
@@ -346,40 +413,69 @@ void update_handler()
   pulse_actions(1);
   pulse_events(1);
 
-  // pulse world
-  // we don't want to be on the same schedule as
-  // everything else, that updates every PULSES_PER_SECOND. 
-  // We want to be on a schedule that updates every minute or so.
-  if((num_updates % (1 MINUTE)) == 0)
-    worldPulse(gameworld);
+  // pulse world. Zones only pulse once a minute or so, but each one does it
+  // on a different pulse so they do not all reset at once
+  worldPulse(gameworld, num_updates);
+
+  // run some of the room resets that are waiting to happen
+  reset_queue_pulse();
+
+  // unload rooms that nobody has been near in a while
+  idle_rooms_pulse();
+
+  // handle the results of work finished since the last pulse
+  jobs_pulse();
 
   // if we have final extractions pending, do them
-  CHAR_DATA *ch = NULL;
-  while((ch = (CHAR_DATA *)listPop(mobs_to_delete)) != NULL)
-    extract_mobile_final(ch);
-  OBJ_DATA *obj = NULL;
-  while((obj = (OBJ_DATA *)listPop(objs_to_delete)) != NULL)
-    extract_obj_final(obj);
-  ROOM_DATA *room = NULL;
-  while((room = (ROOM_DATA *)listPop(rooms_to_delete)) != NULL)
-    extract_room_final(room);
-  char *str = NULL;
-  while((str = (char *)listPop(strs_to_delete)) != NULL)
-    free(str);
-  BUFFER *buf = NULL;
-  while((buf = (BUFFER *)listPop(bufs_to_delete)) != NULL)
-    deleteBuffer(buf);
+  extract_pending();
+
+  // forget who could see what this pulse
+  visibility_pulse();
 }
 
 
 
+//
+// show how long pulses are taking to run, and where the time goes
+COMMAND(cmd_tickstats) {
+  if(!strcasecmp(arg, "clear")) {
+    tick_pulses = tick_lagged = 0;
+    tick_busy   = tick_max    = tick_gc = 0;
+    script_gc_stats_clear();
+    reset_queue_stats_clear();
+    visibility_stats_clear();
+    jobs_stats_clear();
+    send_to_char(ch, "Tick statistics cleared.\r\n");
+  }
+  else {
+    BUFFER *buf = newBuffer(MAX_BUFFER);
+    bprintf(buf, "Pulses run:         %d (%d per second)\r\n", tick_pulses,
+	    PULSES_PER_SECOND);
+    bprintf(buf, "Average pulse:      %.2f ms\r\n",
+	    (tick_pulses ? tick_busy * 1000 / tick_pulses : 0));
+    bprintf(buf, "Longest pulse:      %.2f ms\r\n", tick_max * 1000);
+    bprintf(buf, "Pulses that lagged: %d\r\n", tick_lagged);
+    bprintf(buf, "Slack spent on GC:  %.1f ms\r\n\r\n", tick_gc * 1000);
+    script_gc_stats(buf);
+    bprintf(buf, "\r\n");
+    reset_queue_stats(buf);
+    bprintf(buf, "\r\n");
+    visibility_stats(buf);
+    bprintf(buf, "\r\n");
+    jobs_stats(buf);
+    page_string(charGetSocket(ch), bufferString(buf));
+    deleteBuffer(buf);
+  }
+}
+
 void game_loop(int control)   
 {
   static struct timeval tv;
-  struct timeval last_time, new_time;
+  struct timeval last_time, new_time, gc_time;
   extern fd_set fSet;
   extern fd_set rFd;
   long secs, usecs;
+  double busy;
 
   /* set this for the first loop */
   gettimeofday(&last_time, NULL);
@@ -406,7 +502,7 @@ void game_loop(int control)
       if ((newConnection = accept(control, (struct sockaddr*) &sock, &socksize)) >=0) {
         SOCKET_DATA *newsock = new_socket(newConnection);
 	if(newsock != NULL) {
-	  hookRun("receive_connection", hookBuildInfo("sk", newsock));
+	  hookRun("receive_connection", "sk", newsock);
 	  socketBustPrompt(newsock);
 	}
       }
@@ -422,11 +518,27 @@ void game_loop(int control)
     /* send socket output */
     output_handler();
 
+    // note how long the pulse took. Whatever time is left over, we can use
+    // for collecting Python's garbage
+    gettimeofday(&new_time, NULL);
+    busy = (new_time.tv_sec  - last_time.tv_sec) + 
+           (new_time.tv_usec - last_time.tv_usec) / 1000000.0;
+    tick_pulses++;
+    tick_busy += busy;
+    tick_max   = MAX(tick_max, busy);
+    if(busy > 1.0 / PULSES_PER_SECOND)
+      tick_lagged++;
+    if(script_gc_pulse(MAX(0, 1.0 / PULSES_PER_SECOND - busy)) > 0) {
+      gettimeofday(&gc_time, NULL);
+      tick_gc += (gc_time.tv_sec  - new_time.tv_sec) + 
+	         (gc_time.tv_usec - new_time.tv_usec) / 1000000.0;
+      new_time = gc_time;
+    }
+
     /*
      * Here we sleep out the rest of the pulse, thus forcing
      * SocketMud(tm) (NakedMud) to run at PULSES_PER_SECOND pulses each second.
      */
-    gettimeofday(&new_time, NULL);
 
     // get the time right now, and calculate how long we should sleep
     usecs = (int) (last_time.tv_usec -  new_time.tv_usec) + 1000000 / PULSES_PER_SECOND;
@@ -20,6 +20,10 @@
 #include "hooks.h"
 #include "handler.h"
 #include "commands.h"
+#include "population.h"
+#include "broadcast.h"
+#include "keyword_index.h"
+#include "visibility.h"
 
 
 
@@ -95,9 +99,12 @@ void obj_to_game(OBJ_DATA *obj) {
   // set and list storage, for objects physically 'in' the game
   listPut(object_list, obj);
   setPut(object_set, obj);
+  population_obj(obj, NULL, 1);
+  keyword_index_obj(obj);
+  visibility_changed(obj);
 
   // execute all of our to_game hooks
-  hookRun("obj_to_game", hookBuildInfo("obj", obj));
+  hookRun("obj_to_game", "obj", obj);
 
   // also add all contents
   if(listSize(objGetContents(obj)) > 0) {
@@ -186,7 +193,7 @@ void room_to_game(ROOM_DATA *room) {
   listPut(room_list, room);
 
   // execute all of our to_game hooks
-  hookRun("room_to_game", hookBuildInfo("rm", room));
+  hookRun("room_to_game", "rm", room);
 
   // add contents
   if(listSize(roomGetContents(room)) > 0) {
@@ -296,9 +303,13 @@ void char_to_game(CHAR_DATA *ch) {
   
   setPut(mobile_set, ch);
   listPut(mobile_list, ch);
+  population_char(ch, NULL, 1);
+  broadcast_update(ch);
+  keyword_index_char(ch);
+  visibility_changed(ch);
 
   // execute all of our to_game hooks
-  hookRun("char_to_game", hookBuildInfo("ch", ch));
+  hookRun("char_to_game", "ch", ch);
 
   // also add inventory
   if(listSize(charGetInventory(ch)) > 0) {
@@ -327,7 +338,7 @@ void exit_from_game(EXIT_DATA *exit) {
 
 void obj_from_game(OBJ_DATA *obj) {
   // go through all of our fromgame hooks
-  hookRun("obj_from_game", hookBuildInfo("obj", obj));
+  hookRun("obj_from_game", "obj", obj);
 
   // also remove everything that is contained within the object
   if(listSize(objGetContents(obj)) > 0) {
@@ -338,14 +349,18 @@ void obj_from_game(OBJ_DATA *obj) {
     deleteListIterator(cont_i);
   }
 
-  if(setRemove(object_set, obj))
+  if(setRemove(object_set, obj)) {
     listRemove(object_list, obj);
+    population_obj(obj, NULL, -1);
+    keyword_index_obj(obj);
+    visibility_changed(obj);
+  }
   propertyTableRemove(obj_table, objGetUID(obj));
 }
 
 void room_from_game(ROOM_DATA *room) {
   // go through all of our fromgame hooks
-  hookRun("room_from_game", hookBuildInfo("rm", room));
+  hookRun("room_from_game", "rm", room);
 
   // also remove all the objects contained within the room
   if(listSize(roomGetContents(room)) > 0) {
@@ -376,12 +391,13 @@ void room_from_game(ROOM_DATA *room) {
 
   if(setRemove(room_set, room))
     listRemove(room_list, room);
+  population_forget_room(room);
   propertyTableRemove(room_table, roomGetUID(room));
 }
 
 void char_from_game(CHAR_DATA *ch) {
   // go through all of our fromgame hooks, then remove us from the mobile list
-  hookRun("char_from_game", hookBuildInfo("ch", ch));
+  hookRun("char_from_game", "ch", ch);
 
   // also remove inventory
   if(listSize(charGetInventory(ch)) > 0) {
@@ -403,8 +419,13 @@ void char_from_game(CHAR_DATA *ch) {
   }
   deleteList(eq);
 
-  if(setRemove(mobile_set, ch))
+  if(setRemove(mobile_set, ch)) {
     listRemove(mobile_list, ch);
+    population_char(ch, NULL, -1);
+    broadcast_update(ch);
+    keyword_index_char(ch);
+    visibility_changed(ch);
+  }
   propertyTableRemove(mob_table, charGetUID(ch));
 }
 
@@ -413,7 +434,8 @@ void obj_from_char(OBJ_DATA *obj) {
     CHAR_DATA *ch = objGetCarrier(obj);
     listRemove(charGetInventory(objGetCarrier(obj)), obj);
     objSetCarrier(obj, NULL);
-    hookRun("obj_from_char", hookBuildInfo("obj ch", obj, ch));
+    visibility_changed(obj);
+    hookRun("obj_from_char", "obj ch", obj, ch);
   }
 }
 
@@ -422,7 +444,8 @@ void obj_from_obj(OBJ_DATA *obj) {
     OBJ_DATA *container = objGetContainer(obj);
     listRemove(objGetContents(objGetContainer(obj)), obj);
     objSetContainer(obj, NULL);
-    hookRun("obj_from_obj", hookBuildInfo("obj obj", obj, container));
+    visibility_changed(obj);
+    hookRun("obj_from_obj", "obj obj", obj, container);
   }
 }
 
@@ -430,36 +453,45 @@ void obj_from_room(OBJ_DATA *obj) {
   if(objGetRoom(obj)) {
     ROOM_DATA *room = objGetRoom(obj);
     listRemove(roomGetContents(objGetRoom(obj)), obj);
+    population_obj(obj, room, -1);
     objSetRoom(obj, NULL);
-    hookRun("obj_from_room", hookBuildInfo("obj rm", obj, room));
+    visibility_changed(obj);
+    hookRun("obj_from_room", "obj rm", obj, room);
   }
 }
 
 void obj_to_char(OBJ_DATA *obj, CHAR_DATA *ch) {
   listPut(charGetInventory(ch), obj);
   objSetCarrier(obj, ch);
-  hookRun("obj_to_char", hookBuildInfo("obj ch", obj, ch));
+  visibility_changed(obj);
+  hookRun("obj_to_char", "obj ch", obj, ch);
 }
 
 void obj_to_obj(OBJ_DATA *obj, OBJ_DATA *to) {
   listPut(objGetContents(to), obj);
   objSetContainer(obj, to);
-  hookRun("obj_to_obj", hookBuildInfo("obj obj", obj, to));
+  visibility_changed(obj);
+  hookRun("obj_to_obj", "obj obj", obj, to);
 }
 
 void obj_to_room(OBJ_DATA *obj, ROOM_DATA *room) {
   listPut(roomGetContents(room), obj);
+  population_obj(obj, room, 1);
   objSetRoom(obj, room);
-  hookRun("obj_to_room", hookBuildInfo("obj rm", obj, room));
+  visibility_changed(obj);
+  hookRun("obj_to_room", "obj rm", obj, room);
 }
 
 void char_from_room(CHAR_DATA *ch) {
   if(charGetRoom(ch) != NULL) {
     ROOM_DATA *room = charGetRoom(ch);
-    hookRun("char_from_room", hookBuildInfo("ch rm", ch, room));
+    hookRun("char_from_room", "ch rm", ch, room);
     charSetLastRoom(ch, charGetRoom(ch));
     roomRemoveChar(charGetRoom(ch), ch);
+    population_char(ch, room, -1);
     charSetRoom(ch, NULL);
+    broadcast_update(ch);
+    visibility_changed(ch);
   }
 }
 
@@ -467,8 +499,11 @@ void char_to_room(CHAR_DATA *ch, ROOM_DATA *room) {
   if(charGetRoom(ch))
     char_from_room(ch);
   roomAddChar(room, ch);
+  population_char(ch, room, 1);
   charSetRoom(ch, room);
-  hookRun("char_to_room", hookBuildInfo("ch rm", ch, room));
+  broadcast_update(ch);
+  visibility_changed(ch);
+  hookRun("char_to_room", "ch rm", ch, room);
 }
 
 void char_from_furniture(CHAR_DATA *ch) {
@@ -497,6 +532,7 @@ bool do_equip(CHAR_DATA *ch, OBJ_DATA *obj, const char *pos, bool by_name) {
   if((by_name  && bodyEquipPosnames(charGetBody(ch), obj, pos)) ||
      (!by_name && bodyEquipPostypes(charGetBody(ch), obj, pos))) {
     objSetWearer(obj, ch);
+    visibility_changed(obj);
     return TRUE;
   }
   return FALSE;
@@ -556,7 +592,7 @@ bool try_equip(CHAR_DATA *ch, OBJ_DATA *obj, const char *wanted_pos,
   }
 
   if(success == TRUE)
-    hookRun("equip", hookBuildInfo("ch obj", ch, obj));
+    hookRun("equip", "ch obj", ch, obj);
 
   return success;
 }
@@ -564,6 +600,7 @@ bool try_equip(CHAR_DATA *ch, OBJ_DATA *obj, const char *wanted_pos,
 bool do_unequip(CHAR_DATA *ch, OBJ_DATA *obj) {
   if(bodyUnequip(charGetBody(ch), obj)) {
     objSetWearer(obj, NULL);
+    visibility_changed(obj);
     return TRUE;
   }
   return FALSE;
@@ -571,13 +608,13 @@ bool do_unequip(CHAR_DATA *ch, OBJ_DATA *obj) {
 
 bool try_unequip(CHAR_DATA *ch, OBJ_DATA *obj) {
   if(objGetWearer(obj) == ch) {
-    hookRun("pre_unequip", hookBuildInfo("ch obj", ch, obj));
+    hookRun("pre_unequip", "ch obj", ch, obj);
 
     // if wearer == ch, this should never fail
     bool success = do_unequip(ch, obj);
 
     if(success == TRUE)
-      hookRun("unequip", hookBuildInfo("ch obj", ch, obj));
+      hookRun("unequip", "ch obj", ch, obj);
     else
       log_string("ERROR: failed to unequip obj when wearer == ch");
     return success;
@@ -787,6 +824,21 @@ void *find_in_obj(CHAR_DATA *looker,
 }
 
 
+//
+// move everything in a list of things we just found to the list of everything
+// we have found so far, skipping things we had already found. The list of
+// things we just found is deleted afterwards
+void find_all_merge(LIST *found_list, SET *found_set, LIST *more) {
+  void *thing = NULL;
+  while((thing = listPop(more)) != NULL) {
+    if(!setIn(found_set, thing)) {
+      setPut(found_set, thing);
+      listPut(found_list, thing);
+    }
+  }
+  deleteList(more);
+}
+
 LIST *find_all(CHAR_DATA *looker, const char *at, bitvector_t find_types,
 	       bitvector_t find_scope, int *found_type) {
   if(found_type)
@@ -797,16 +849,13 @@ LIST *find_all(CHAR_DATA *looker, const char *at, bitvector_t find_types,
   /************************************************************/
   if(find_types == FIND_TYPE_OBJ) {
     LIST *obj_list = newList();
+    SET     *found = newSet();
     
     // get everything from our inventory
     if(IS_SET(find_scope, FIND_SCOPE_INV)) {
       LIST *inv_objs = find_all_objs(looker,charGetInventory(looker), at, NULL,
 				     (IS_SET(find_scope, FIND_SCOPE_VISIBLE)));
-      OBJ_DATA *obj = NULL;
-      while( (obj = listPop(inv_objs)) != NULL)
-	if(!listIn(obj_list, obj))
-	  listPut(obj_list, obj);
-      deleteList(inv_objs);
+      find_all_merge(obj_list, found, inv_objs);
     }
 
     // get everything from the room
@@ -815,11 +864,7 @@ LIST *find_all(CHAR_DATA *looker, const char *at, bitvector_t find_types,
 				      roomGetContents(charGetRoom(looker)),
 				      at, NULL,
 				     (IS_SET(find_scope, FIND_SCOPE_VISIBLE)));
-      OBJ_DATA *obj = NULL;
-      while( (obj = listPop(room_objs)) != NULL)
-	if(!listIn(obj_list, obj))
-	  listPut(obj_list, obj);
-      deleteList(room_objs);
+      find_all_merge(obj_list, found, room_objs);
     }
 
     // get everything we are wearing
@@ -831,11 +876,7 @@ LIST *find_all(CHAR_DATA *looker, const char *at, bitvector_t find_types,
       LIST *eq_objs = find_all_objs(looker, equipment, at, NULL,
 				    (IS_SET(find_scope, FIND_SCOPE_VISIBLE)));
       deleteList(equipment);
-      OBJ_DATA *obj = NULL;
-      while( (obj = listPop(eq_objs)) != NULL)
-	if(!listIn(obj_list, obj))
-	  listPut(obj_list, obj);
-      deleteList(eq_objs);
+      find_all_merge(obj_list, found, eq_objs);
     }
 
     // get everything in the world
@@ -843,13 +884,11 @@ LIST *find_all(CHAR_DATA *looker, const char *at, bitvector_t find_types,
       LIST *wld_objs = find_all_objs(looker,
 				     object_list, at, NULL, 
 				     (IS_SET(find_scope, FIND_SCOPE_VISIBLE)));
-      OBJ_DATA *obj = NULL;
-      while( (obj = listPop(wld_objs)) != NULL)
-	if(!listIn(obj_list, obj))
-	  listPut(obj_list, obj);
-      deleteList(wld_objs);
+      find_all_merge(obj_list, found, wld_objs);
     }
 
+    deleteSet(found);
+
     // if we didn't find anything, return NULL
     if(listSize(obj_list) < 1) {
       deleteList(obj_list);
@@ -867,6 +906,7 @@ LIST *find_all(CHAR_DATA *looker, const char *at, bitvector_t find_types,
   /************************************************************/
   else if(find_types == FIND_TYPE_CHAR) {
     LIST *char_list = newList();
+    SET      *found = newSet();
 
     // find everyone in the room
     if(IS_SET(find_scope, FIND_SCOPE_ROOM)) {
@@ -874,11 +914,7 @@ LIST *find_all(CHAR_DATA *looker, const char *at, bitvector_t find_types,
 				       roomGetCharacters(charGetRoom(looker)),
 				       at, NULL,
 				       (IS_SET(find_scope,FIND_SCOPE_VISIBLE)));
-      CHAR_DATA *ch = NULL;
-      while( (ch = listPop(room_chars)) != NULL)
-	if(!listIn(char_list, ch))
-	  listPut(char_list, ch);
-      deleteList(room_chars);
+      find_all_merge(char_list, found, room_chars);
     }
 
     // find everyone in the world
@@ -887,13 +923,11 @@ LIST *find_all(CHAR_DATA *looker, const char *at, bitvector_t find_types,
 				       mobile_list,
 				       at, NULL,
 				       (IS_SET(find_scope,FIND_SCOPE_VISIBLE)));
-      CHAR_DATA *ch = NULL;
-      while( (ch = listPop(wld_chars)) != NULL)
-	if(!listIn(char_list, ch))
-	  listPut(char_list, ch);
-      deleteList(wld_chars);
+      find_all_merge(char_list, found, wld_chars);
     }
 
+    deleteSet(found);
+
     // if we didn't find anything, return NULL
     if(listSize(char_list) < 1) {
       deleteList(char_list);
@@ -1027,7 +1061,7 @@ void *find_one(CHAR_DATA *looker,
 
     // no exit... are we using an abbreviation?
     if(exit == NULL && (dirGetAbbrevNum(at) != DIR_NONE))
-      exit = roomGetExit(charGetRoom(looker), dirGetName(dirGetAbbrevNum(at)));
+      exit = roomGetDirExit(charGetRoom(looker), dirGetAbbrevNum(at));
 
     // we found one
     if(exit && (!IS_SET(find_scope, FIND_SCOPE_VISIBLE) || 
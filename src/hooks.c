@@ -33,14 +33,118 @@
 // local functions, variables, and definitions
 //*****************************************************************************
 
+// the most arguments a hook can be run with
+#define HOOK_MAX_ARGS           10
+
+// the types of arguments a hook can take
+#define HOOK_ARG_CHAR            0
+#define HOOK_ARG_OBJ             1
+#define HOOK_ARG_ROOM            2
+#define HOOK_ARG_EXIT            3
+#define HOOK_ARG_SOCK            4
+#define HOOK_ARG_STR             5
+#define HOOK_ARG_INT             6
+#define HOOK_ARG_DBL             7
+
+struct hook_args {
+  int                  num;
+  int types[HOOK_MAX_ARGS];
+  union {
+    void              *ptr;
+    const char        *str;
+    int                num;
+    double             dbl;
+  } vals[HOOK_MAX_ARGS];
+  BUFFER             *info; // our string form, if it has been built
+};
+
+// a function that is called whenever a hook is run
+typedef struct {
+  void (* func)(const char *, HOOK_ARGS *);
+  bool (* wants)(const char *);
+} HOOK_MONITOR;
+
 // the table of all our installed hooks
 HASHTABLE *hook_table   = NULL;
 
 // the list of functions called whenever a hook is run
 LIST *monitors = NULL;
 
-// a buffer for building hook info on
-BUFFER      *info_buf = NULL;
+//
+// figure out what type of argument the format token starting at fmt is, and
+// return where the next token starts. Returns -1 for an unknown type
+int hook_arg_type(const char **fmt) {
+  const char *start = *fmt;
+  int           len = 0, type = -1;
+  while(start[len] && !isspace(start[len]))
+    len++;
+  *fmt = start + len;
+  while(isspace(**fmt))
+    (*fmt)++;
+
+  if(len == 2 && !strncasecmp(start, "ch", 2))
+    type = HOOK_ARG_CHAR;
+  else if(len == 3 && !strncasecmp(start, "obj", 3))
+    type = HOOK_ARG_OBJ;
+  else if((len == 2 && !strncasecmp(start, "rm", 2)) ||
+	  (len == 4 && !strncasecmp(start, "room", 4)))
+    type = HOOK_ARG_ROOM;
+  else if((len == 2 && !strncasecmp(start, "ex", 2)) ||
+	  (len == 4 && !strncasecmp(start, "exit", 4)))
+    type = HOOK_ARG_EXIT;
+  else if((len == 2 && !strncasecmp(start, "sk", 2)) ||
+	  (len == 4 && !strncasecmp(start, "sock", 4)))
+    type = HOOK_ARG_SOCK;
+  else if(len == 3 && !strncasecmp(start, "str", 3))
+    type = HOOK_ARG_STR;
+  else if(len == 3 && !strncasecmp(start, "int", 3))
+    type = HOOK_ARG_INT;
+  else if(len == 3 && !strncasecmp(start, "dbl", 3))
+    type = HOOK_ARG_DBL;
+  return type;
+}
+
+//
+// returns whether a C hook or monitor cares about hooks of the given type
+bool hook_has_listeners(const char *type, LIST *list) {
+  if(list != NULL && listSize(list) > 0)
+    return TRUE;
+  else {
+    LIST_ITERATOR *mon_i = newListIterator(monitors);
+    HOOK_MONITOR    *mon = NULL;
+    bool          wanted = FALSE;
+    ITERATE_LIST(mon, mon_i) {
+      if(mon->wants == NULL || mon->wants(type)) {
+	wanted = TRUE;
+	break;
+      }
+    } deleteListIterator(mon_i);
+    return wanted;
+  }
+}
+
+//
+// run all of the C hooks and monitors for a hook type, with the given args
+void hook_run_args(const char *type, LIST *list, HOOK_ARGS *args) {
+  if(list != NULL) {
+    LIST_ITERATOR *list_i = newListIterator(list);
+    void (* func)(HOOK_ARGS *) = NULL;
+    ITERATE_LIST(func, list_i) {
+      func(args);
+    } deleteListIterator(list_i);
+  }
+
+  // run our monitors
+  LIST_ITERATOR *mon_i = newListIterator(monitors);
+  HOOK_MONITOR    *mon = NULL;
+  ITERATE_LIST(mon, mon_i) {
+    if(mon->wants == NULL || mon->wants(type))
+      mon->func(type, args);
+  } deleteListIterator(mon_i);
+
+  if(args->info != NULL)
+    deleteBuffer(args->info);
+}
 
 
 
@@ -50,16 +154,15 @@ BUFFER      *info_buf = NULL;
 void init_hooks(void) {
   // make our required variables
   hook_table = newHashtable();
-  info_buf   = newBuffer(1);
   monitors   = newList();
 }
 
-void hookRemove(const char *type, void (* func)(const char *)) {
+void hookRemove(const char *type, void (* func)(HOOK_ARGS *)) {
   LIST *list = hashGet(hook_table, type);
   if(list != NULL) listRemove(list, func);
 }
 
-void hookAdd(const char *type, void (* func)(const char *)) {
+void hookAdd(const char *type, void (* func)(HOOK_ARGS *)) {
   LIST *list = hashGet(hook_table, type);
   if(list == NULL) {
     list = newList();
@@ -68,73 +171,184 @@ void hookAdd(const char *type, void (* func)(const char *)) {
   listQueue(list, func);
 }
 
-void hookAddMonitor(void (* func)(const char *, const char *)) {
-  listQueue(monitors, func);
+void hookAddMonitor(void (* func)(const char *, HOOK_ARGS *),
+		    bool (* wants)(const char *)) {
+  HOOK_MONITOR *mon = malloc(sizeof(HOOK_MONITOR));
+  mon->func  = func;
+  mon->wants = wants;
+  listQueue(monitors, mon);
 }
 
-void hookRun(const char *type, const char *info) {
+void hookRun(const char *type, const char *format, ...) {
   LIST *list = hashGet(hook_table, type);
-  char *info_dup = strdup(info);
-  if(list != NULL) {
-    LIST_ITERATOR *list_i = newListIterator(list);
-    void (* func)(const char *) = NULL;
-    ITERATE_LIST(func, list_i) {
-      func(info_dup);
-    } deleteListIterator(list_i);
-  }
 
-  // run our monitors
-  LIST_ITERATOR *mon_i = newListIterator(monitors);
-  void (* mon)(const char *, const char *) = NULL;
-  ITERATE_LIST(mon, mon_i) {
-    mon(type, info_dup);
-  } deleteListIterator(mon_i);
-  free(info_dup);
+  // nothing is listening; don't bother
+  if(!hook_has_listeners(type, list))
+    return;
+  else {
+    HOOK_ARGS args;
+    va_list vargs;
+    args.num  = 0;
+    args.info = NULL;
+
+    va_start(vargs, format);
+    while(*format && args.num < HOOK_MAX_ARGS) {
+      int argtype = hook_arg_type(&format);
+      switch(argtype) {
+      case HOOK_ARG_STR:
+	args.vals[args.num].str = va_arg(vargs, const char *);
+	break;
+      case HOOK_ARG_INT:
+	args.vals[args.num].num = va_arg(vargs, int);
+	break;
+      case HOOK_ARG_DBL:
+	args.vals[args.num].dbl = va_arg(vargs, double);
+	break;
+      case -1:
+	log_string("ERROR: hook %s run with an unknown argument type.", type);
+	va_end(vargs);
+	return;
+      default:
+	args.vals[args.num].ptr = va_arg(vargs, void *);
+	break;
+      }
+      args.types[args.num++] = argtype;
+    }
+    va_end(vargs);
+
+    hook_run_args(type, list, &args);
+  }
 }
 
-const char *hookBuildInfo(const char *format, ...) {
-  // clear our workspace
-  bufferClear(info_buf);
+void hookRunInfo(const char *type, const char *info) {
+  LIST *list = hashGet(hook_table, type);
+  if(!hook_has_listeners(type, list))
+    return;
+  else {
+    LIST           *tokens = parse_hook_info_tokens(info);
+    LIST_ITERATOR *token_i = newListIterator(tokens);
+    char            *token = NULL;
+    HOOK_ARGS         args;
+    int id = 0;
+    args.num  = 0;
+    args.info = NULL;
 
-  // parse out all of our tokens
-  LIST *tokens           = parse_strings(format, ' ');
-  LIST_ITERATOR *token_i = newListIterator(tokens);
-  char *token            = NULL;
-  int   len              = listSize(tokens);
-  int   count            = 0;
+    ITERATE_LIST(token, token_i) {
+      if(args.num >= HOOK_MAX_ARGS)
+	break;
+      else if(*token == HOOK_STR_MARKER) {
+	token[strlen(token)-1] = '\0';
+	args.types[args.num]    = HOOK_ARG_STR;
+	args.vals[args.num].str = token + 1;
+      }
+      else if(isdigit(*token) || *token == '-') {
+	// integer or double?
+	if(next_letter_in(token, '.') > -1) {
+	  args.types[args.num]    = HOOK_ARG_DBL;
+	  args.vals[args.num].dbl = atof(token);
+	}
+	else {
+	  args.types[args.num]    = HOOK_ARG_INT;
+	  args.vals[args.num].num = atoi(token);
+	}
+      }
+      else {
+	const char *fmt = token;
+	char *dot = strchr(token, '.');
+	if(dot == NULL)
+	  continue;
+	*dot = ' ';
+	id   = atoi(dot + 1);
+	args.types[args.num] = hook_arg_type(&fmt);
+	switch(args.types[args.num]) {
+	case HOOK_ARG_CHAR:
+	  args.vals[args.num].ptr = propertyTableGet(mob_table, id);
+	  break;
+	case HOOK_ARG_OBJ:
+	  args.vals[args.num].ptr = propertyTableGet(obj_table, id);
+	  break;
+	case HOOK_ARG_ROOM:
+	  args.vals[args.num].ptr = propertyTableGet(room_table, id);
+	  break;
+	case HOOK_ARG_EXIT:
+	  args.vals[args.num].ptr = propertyTableGet(exit_table, id);
+	  break;
+	case HOOK_ARG_SOCK:
+	  args.vals[args.num].ptr = propertyTableGet(sock_table, id);
+	  break;
+	default:
+	  continue;
+	}
+      }
+      args.num++;
+    } deleteListIterator(token_i);
 
-  // go through all of our tokens
+    hook_run_args(type, list, &args);
+    deleteListWith(tokens, free);
+  }
+}
+
+void hookParseArgs(HOOK_ARGS *args, ...) {
   va_list vargs;
-  va_start(vargs, format);
-  ITERATE_LIST(token, token_i) {
-    if(!strcasecmp(token, "ch"))
-      bprintf(info_buf, "ch.%d", charGetUID(va_arg(vargs, CHAR_DATA *)));
-    else if(!strcasecmp(token, "obj"))
-      bprintf(info_buf, "obj.%d", objGetUID(va_arg(vargs, OBJ_DATA *)));
-    else if(!strcasecmp(token, "rm") || !strcasecmp(token, "room"))
-      bprintf(info_buf, "rm.%d", roomGetUID(va_arg(vargs, ROOM_DATA *)));
-    else if(!strcasecmp(token, "ex") || !strcasecmp(token, "exit"))
-      bprintf(info_buf, "ex.%d", exitGetUID(va_arg(vargs, EXIT_DATA *)));
-    else if(!strcasecmp(token, "sk") || !strcasecmp(token, "sock"))
-      bprintf(info_buf, "sk.%d", socketGetUID(va_arg(vargs, SOCKET_DATA *)));
-    else if(!strcasecmp(token, "str"))
-      bprintf(info_buf, "%c%s%c", HOOK_STR_MARKER, va_arg(vargs, char *), HOOK_STR_MARKER);
-    else if(!strcasecmp(token, "int"))
-      bprintf(info_buf, "%d", va_arg(vargs, int));
-    else if(!strcasecmp(token, "dbl"))
-      bprintf(info_buf, "%lf", va_arg(vargs, double));
-    // unknown type -- abort!
-    else
+  int i;
+  va_start(vargs, args);
+  for(i = 0; i < args->num; i++) {
+    switch(args->types[i]) {
+    case HOOK_ARG_STR:
+      *va_arg(vargs, char **) = strdupsafe(args->vals[i].str);
       break;
-
-    // add a space for the next token to be printed
-    if(count < len - 1)
-      bprintf(info_buf, " ");
-    count++;
-  } deleteListIterator(token_i);
-  deleteListWith(tokens, free);
+    case HOOK_ARG_INT:
+      *va_arg(vargs, int *) = args->vals[i].num;
+      break;
+    case HOOK_ARG_DBL:
+      *va_arg(vargs, double *) = args->vals[i].dbl;
+      break;
+    default:
+      *va_arg(vargs, void **) = args->vals[i].ptr;
+      break;
+    }
+  }
   va_end(vargs);
-  return bufferString(info_buf);
+}
+
+const char *hookArgsInfo(HOOK_ARGS *args) {
+  if(args->info == NULL) {
+    int i;
+    args->info = newBuffer(1);
+    for(i = 0; i < args->num; i++) {
+      void *ptr = args->vals[i].ptr;
+      if(i > 0)
+	bprintf(args->info, " ");
+      switch(args->types[i]) {
+      case HOOK_ARG_CHAR:
+	bprintf(args->info, "ch.%d",  (ptr ? charGetUID(ptr)   : NOTHING));
+	break;
+      case HOOK_ARG_OBJ:
+	bprintf(args->info, "obj.%d", (ptr ? objGetUID(ptr)    : NOTHING));
+	break;
+      case HOOK_ARG_ROOM:
+	bprintf(args->info, "rm.%d",  (ptr ? roomGetUID(ptr)   : NOTHING));
+	break;
+      case HOOK_ARG_EXIT:
+	bprintf(args->info, "ex.%d",  (ptr ? exitGetUID(ptr)   : NOTHING));
+	break;
+      case HOOK_ARG_SOCK:
+	bprintf(args->info, "sk.%d",  (ptr ? socketGetUID(ptr) : NOTHING));
+	break;
+      case HOOK_ARG_STR:
+	bprintf(args->info, "%c%s%c", HOOK_STR_MARKER, args->vals[i].str,
+		HOOK_STR_MARKER);
+	break;
+      case HOOK_ARG_INT:
+	bprintf(args->info, "%d", args->vals[i].num);
+	break;
+      case HOOK_ARG_DBL:
+	bprintf(args->info, "%lf", args->vals[i].dbl);
+	break;
+      }
+    }
+  }
+  return bufferString(args->info);
 }
 
 //
@@ -174,65 +388,3 @@ LIST *parse_hook_info_tokens(const char *info) {
   deleteBuffer(buf);
   return tokens;
 }
-
-void hookParseInfo(const char *info, ...) {
-  // parse out all of our tokens
-  LIST *tokens           = parse_hook_info_tokens(info);
-  LIST_ITERATOR *token_i = newListIterator(tokens);
-  char *token            = NULL;
-
-  // id number we'll need for parsing some values
-  int id = 0;
-
-  // go through all of our tokens
-  va_list vargs;
-  va_start(vargs, info);
-  ITERATE_LIST(token, token_i) {
-    if(startswith(token, "ch")) {
-      sscanf(token, "ch.%d", &id);
-      *va_arg(vargs, CHAR_DATA **) = propertyTableGet(mob_table, id);
-    }
-    else if(startswith(token, "obj")) {
-      sscanf(token, "obj.%d", &id);
-      *va_arg(vargs, OBJ_DATA **) = propertyTableGet(obj_table, id);
-    }
-    else if(startswith(token, "rm")) {
-      sscanf(token, "rm.%d", &id);
-      *va_arg(vargs, ROOM_DATA **) = propertyTableGet(room_table, id);
-    }
-    else if(startswith(token, "room")) {
-      sscanf(token, "room.%d", &id);
-      *va_arg(vargs, ROOM_DATA **) = propertyTableGet(room_table, id);
-    }
-    else if(startswith(token, "ex")) {
-      sscanf(token, "ex.%d", &id);
-      *va_arg(vargs, EXIT_DATA **) = propertyTableGet(exit_table, id);
-    }
-    else if(startswith(token, "exit")) {
-      sscanf(token, "exit.%d", &id);
-      *va_arg(vargs, EXIT_DATA **) = propertyTableGet(exit_table, id);
-    }
-    else if(startswith(token, "sk")) {
-      sscanf(token, "sk.%d", &id);
-      *va_arg(vargs, SOCKET_DATA **) = propertyTableGet(sock_table, id);
-    }
-    else if(startswith(token, "sock")) {
-      sscanf(token, "sk.%d", &id);
-      *va_arg(vargs, SOCKET_DATA **) = propertyTableGet(sock_table, id);
-    }
-    else if(*token == HOOK_STR_MARKER) {
-      char *str = strdup(token + 1);
-      str[strlen(str)-1] = '\0';
-      *va_arg(vargs, char **) = str;
-    }
-    else if(isdigit(*token)) {
-      // integer or double?
-      if(next_letter_in(token, '.') > -1)
-	*va_arg(vargs, double *) = atof(token);
-      else
-	*va_arg(vargs, int *) = atoi(token);
-    }
-  } deleteListIterator(token_i);
-  deleteListWith(tokens, free);
-  va_end(vargs);
-}
@@ -27,16 +27,51 @@
 // strings with escape sequences, this could be deadly.
 #define HOOK_STR_MARKER '\032'
 
+//
+// the arguments a hook was run with. C hooks are handed the arguments exactly
+// as they were supplied, and pull them out with hookParseArgs. Python hooks
+// work with a string form of them (see hookArgsInfo).
+typedef struct hook_args HOOK_ARGS;
+
 //
 // prepare hooks for use
 void init_hooks(void);
 
-void hookRun(const char *type, const char *info);
-void hookAdd(const char *type, void (* func)(const char *));
-void hookAddMonitor(void (* func)(const char *, const char *));
-void hookRemove(const char *type, void (* func)(const char *));
-void hookParseInfo(const char *info, ...);
-const char *hookBuildInfo(const char *format, ...);
+//
+// Run all of the hooks of the specified type. The format is a space-separated
+// list of the types of the arguments that follow: ch, obj, rm, ex, sk, str,
+// int, and dbl. If nothing is listening for hooks of this type, this returns
+// without doing any work.
+//   e.g. hookRun("obj_to_char", "obj ch", obj, ch);
+void hookRun(const char *type, const char *format, ...);
+
+//
+// run a hook from the string form of its arguments (e.g. if it came from
+// Python). See hookArgsInfo
+void hookRunInfo(const char *type, const char *info);
+
+void hookAdd(const char *type, void (* func)(HOOK_ARGS *));
+
+//
+// add a function that is called whenever any type of hook is run. If wants is
+// not NULL, the monitor is only called for the types of hooks wants returns
+// TRUE for.
+void hookAddMonitor(void (* func)(const char *, HOOK_ARGS *),
+		    bool (* wants)(const char *));
+void hookRemove(const char *type, void (* func)(HOOK_ARGS *));
+
+//
+// pull out the arguments a hook was run with. Takes pointers to variables of
+// the appropriate type, in the order of the hook's arguments. Strings are
+// copied, and must be freed after use.
+//   e.g. hookParseArgs(args, &obj, &ch);
+void hookParseArgs(HOOK_ARGS *args, ...);
+
+//
+// returns the string form of the hook's arguments, built the first time it is
+// needed: entities are written as "ch.uid", "obj.uid", etc..., and strings are
+// surrounded by HOOK_STR_MARKER
+const char *hookArgsInfo(HOOK_ARGS *args);
 LIST *parse_hook_info_tokens(const char *info);
 
 #endif // HOOKS_H
@@ -0,0 +1,526 @@
+//*****************************************************************************
+//
+// idle_rooms.c
+//
+// Unloads rooms that have sat idle for too long, and reads them back in when
+// they are next needed. For a description of what gets unloaded and when, see
+// idle_rooms.h
+//
+// Rooms are kept in a queue, in the order they were last put on it. Each pulse
+// we look at the front of the queue. A room that has had something come or go
+// since it was put on the queue goes to the back again, as does one that is
+// busy. That way, we never have to look at more than a few rooms a pulse to
+// find the ones that have gone idle.
+//
+//*****************************************************************************
+
+#include "mud.h"
+#include "utils.h"
+#include "storage.h"
+#include "world.h"
+#include "room.h"
+#include "character.h"
+#include "object.h"
+#include "body.h"
+#include "handler.h"
+#include "hooks.h"
+#include "event.h"
+#include "action.h"
+#include "snapshot.h"
+#include "population.h"
+#include "room_reset.h"
+#include "path.h"
+#include "idle_rooms.h"
+
+// how much of the heap is in use can only be found out on newer glibcs
+#ifdef __GLIBC__
+#include <malloc.h>
+#if __GLIBC_PREREQ(2, 33)
+#define HAVE_MALLINFO2
+#endif
+#endif
+
+
+
+//*****************************************************************************
+// mandatory modules
+//*****************************************************************************
+#include "scripts/scripts.h"
+
+
+
+//*****************************************************************************
+// local datastructures, functions, and defines
+//*****************************************************************************
+
+// the most rooms we look at off the front of the queue each pulse
+#define IDLE_ROOMS_PER_PULSE     20
+
+//
+// a room that is loaded, and how long it has been idle for
+typedef struct {
+  ROOM_DATA     *room;
+  char           *key;
+  time_t       active; // the last time something came or went
+  time_t       queued; // when we were last put on the back of the queue
+  bool           born; // do we know what we looked like when we were made?
+  unsigned long birth; // if so, a hash of how we looked
+  bool           gone; // we left the game; drop us when we reach the front
+} IDLE_ROOM;
+
+//
+// a room that has been unloaded
+typedef struct {
+  char           *data; // the room and everything in it, stored as a string
+  LIST      *mob_protos; // the prototypes of the mobiles it holds...
+  LIST      *obj_protos; // ...and of the objects, still counted as in game
+  bool           born;
+  unsigned long birth;
+  bool      reset_due; // did a reset come due while we were unloaded?
+} UNLOADED_ROOM;
+
+// the rooms we are watching, by key, and the order we look at them in
+HASHTABLE *idle_rooms  = NULL;
+LIST      *idle_queue  = NULL;
+
+// the rooms that have been unloaded, by key
+HASHTABLE *unloaded_rooms = NULL;
+
+// how much we have done since boot
+int    rooms_discarded = 0; // unloaded rooms that were just thrown out
+int    rooms_stored    = 0; // unloaded rooms that were stored
+int    rooms_restored  = 0; // stored rooms that were read back in
+int    rooms_kept      = 0; // idle rooms that were too busy to unload
+long   unload_freed    = 0; // how much the heap shrank by when unloading
+long   unloaded_bytes  = 0; // how big our stored rooms are right now
+
+IDLE_ROOM *newIdleRoom(ROOM_DATA *room) {
+  IDLE_ROOM *idle = malloc(sizeof(IDLE_ROOM));
+  idle->room   = room;
+  idle->key    = strdup(roomGetClass(room));
+  idle->active = current_time;
+  idle->queued = current_time;
+  idle->born   = FALSE;
+  idle->birth  = 0;
+  idle->gone   = FALSE;
+  return idle;
+}
+
+void deleteIdleRoom(IDLE_ROOM *idle) {
+  free(idle->key);
+  free(idle);
+}
+
+UNLOADED_ROOM *newUnloadedRoom(char *data) {
+  UNLOADED_ROOM *unloaded = malloc(sizeof(UNLOADED_ROOM));
+  unloaded->data       = data;
+  unloaded->mob_protos = newList();
+  unloaded->obj_protos = newList();
+  unloaded->born       = FALSE;
+  unloaded->birth      = 0;
+  unloaded->reset_due  = FALSE;
+  unloaded_bytes      += strlen(data);
+  return unloaded;
+}
+
+void deleteUnloadedRoom(UNLOADED_ROOM *unloaded) {
+  unloaded_bytes -= strlen(unloaded->data);
+  free(unloaded->data);
+  deleteListWith(unloaded->mob_protos, free);
+  deleteListWith(unloaded->obj_protos, free);
+  free(unloaded);
+}
+
+//
+// returns how much of the heap is in use, or 0 if we cannot tell
+long heap_in_use(void) {
+#ifdef HAVE_MALLINFO2
+  struct mallinfo2 info = mallinfo2();
+  return (long)info.uordblks;
+#else
+  return 0;
+#endif
+}
+
+//
+// returns a hash of how the room looks, minus anything that changes each time
+// it is stored
+unsigned long room_hash(ROOM_DATA *room) {
+  STORAGE_SET    *set = roomStore(room);
+  char           *str = storage_write_string(set);
+  unsigned long  hash = string_hash(str);
+  storage_close(set);
+  free(str);
+  return hash;
+}
+
+//
+// start watching a room that has come into the game
+void idle_room_track(ROOM_DATA *room) {
+  IDLE_ROOM *old = hashGet(idle_rooms, roomGetClass(room));
+  if(old != NULL)
+    old->gone = TRUE;
+  IDLE_ROOM *idle = newIdleRoom(room);
+  hashPut(idle_rooms, idle->key, idle);
+  listQueue(idle_queue, idle);
+}
+
+//
+// something came or went in the room
+void idle_room_touch(ROOM_DATA *room) {
+  IDLE_ROOM *idle = hashGet(idle_rooms, roomGetClass(room));
+  if(idle != NULL && idle->room == room)
+    idle->active = current_time;
+}
+
+//
+// returns whether the object, or anything in it, is being used by something
+// that would not like it to disappear
+bool idle_obj_busy(OBJ_DATA *obj) {
+  if(objPyFormHeld(obj) || events_involving(obj))
+    return TRUE;
+
+  bool           busy = FALSE;
+  LIST_ITERATOR *cont_i = newListIterator(objGetContents(obj));
+  OBJ_DATA        *cont = NULL;
+  ITERATE_LIST(cont, cont_i) {
+    if((busy = idle_obj_busy(cont)) == TRUE)
+      break;
+  } deleteListIterator(cont_i);
+  return busy;
+}
+
+//
+// returns whether a character, or anything they have, is being used by
+// something that would not like it to disappear. Players always are
+bool idle_char_busy(CHAR_DATA *ch) {
+  if(!charIsNPC(ch) || charGetSocket(ch) != NULL || charPyFormHeld(ch) ||
+     events_involving(ch) || is_acting(ch, ~(bitvector_t)0))
+    return TRUE;
+
+  bool           busy = FALSE;
+  LIST_ITERATOR *inv_i = newListIterator(charGetInventory(ch));
+  OBJ_DATA        *obj = NULL;
+  ITERATE_LIST(obj, inv_i) {
+    if((busy = idle_obj_busy(obj)) == TRUE)
+      break;
+  } deleteListIterator(inv_i);
+
+  LIST *eq = bodyGetAllEq(charGetBody(ch));
+  while(!busy && (obj = listPop(eq)) != NULL)
+    busy = idle_obj_busy(obj);
+  deleteList(eq);
+  return busy;
+}
+
+bool idle_room_busy(ROOM_DATA *room) {
+  if(roomPyFormHeld(room) || events_involving(room))
+    return TRUE;
+
+  bool           busy = FALSE;
+  LIST_ITERATOR *ch_i = newListIterator(roomGetCharacters(room));
+  CHAR_DATA       *ch = NULL;
+  ITERATE_LIST(ch, ch_i) {
+    if((busy = idle_char_busy(ch)) == TRUE)
+      break;
+  } deleteListIterator(ch_i);
+  if(busy)
+    return TRUE;
+
+  LIST_ITERATOR *obj_i = newListIterator(roomGetContents(room));
+  OBJ_DATA        *obj = NULL;
+  ITERATE_LIST(obj, obj_i) {
+    if((busy = idle_obj_busy(obj)) == TRUE)
+      break;
+  } deleteListIterator(obj_i);
+  return busy;
+}
+
+//
+// remember the prototypes of an object and everything in it, so they can stay
+// counted while their room is unloaded
+void idle_note_obj(UNLOADED_ROOM *unloaded, OBJ_DATA *obj) {
+  listPut(unloaded->obj_protos, strdup(objGetPrototypes(obj)));
+  LIST_ITERATOR *cont_i = newListIterator(objGetContents(obj));
+  OBJ_DATA        *cont = NULL;
+  ITERATE_LIST(cont, cont_i) {
+    idle_note_obj(unloaded, cont);
+  } deleteListIterator(cont_i);
+}
+
+void idle_note_contents(UNLOADED_ROOM *unloaded, ROOM_DATA *room) {
+  LIST_ITERATOR *ch_i = newListIterator(roomGetCharacters(room));
+  CHAR_DATA       *ch = NULL;
+  OBJ_DATA       *obj = NULL;
+  ITERATE_LIST(ch, ch_i) {
+    listPut(unloaded->mob_protos, strdup(charGetPrototypes(ch)));
+    LIST_ITERATOR *inv_i = newListIterator(charGetInventory(ch));
+    ITERATE_LIST(obj, inv_i) {
+      idle_note_obj(unloaded, obj);
+    } deleteListIterator(inv_i);
+    LIST *eq = bodyGetAllEq(charGetBody(ch));
+    while((obj = listPop(eq)) != NULL)
+      idle_note_obj(unloaded, obj);
+    deleteList(eq);
+  } deleteListIterator(ch_i);
+
+  LIST_ITERATOR *obj_i = newListIterator(roomGetContents(room));
+  ITERATE_LIST(obj, obj_i) {
+    idle_note_obj(unloaded, obj);
+  } deleteListIterator(obj_i);
+}
+
+//
+// add the unloaded room's contents to (or take them from) the game's counts
+void idle_count_contents(UNLOADED_ROOM *unloaded, int amount) {
+  LIST_ITERATOR *proto_i = newListIterator(unloaded->mob_protos);
+  char            *proto = NULL;
+  ITERATE_LIST(proto, proto_i) {
+    population_dormant(proto, TRUE, amount);
+  } deleteListIterator(proto_i);
+
+  proto_i = newListIterator(unloaded->obj_protos);
+  ITERATE_LIST(proto, proto_i) {
+    population_dormant(proto, FALSE, amount);
+  } deleteListIterator(proto_i);
+}
+
+//
+// unload a room. If it is the same as it was when it was made from its
+// prototype, it is thrown out. Otherwise, it is stored to be read back in later
+void idle_room_unload(IDLE_ROOM *idle) {
+  ROOM_DATA *room = idle->room;
+  bool  pristine = (idle->born &&
+		    listSize(roomGetCharacters(room)) == 0 &&
+		    listSize(roomGetContents(room))   == 0 &&
+		    room_hash(room) == idle->birth);
+
+  if(pristine)
+    rooms_discarded++;
+  else {
+    STORAGE_SET        *set = snapshot_room_store(room);
+    UNLOADED_ROOM *unloaded = newUnloadedRoom(storage_write_string(set));
+    storage_close(set);
+    unloaded->born  = idle->born;
+    unloaded->birth = idle->birth;
+    idle_note_contents(unloaded, room);
+    hashPut(unloaded_rooms, idle->key, unloaded);
+    rooms_stored++;
+  }
+
+  path_room_unloading(room);
+  extract_room(room);
+
+  // the room's contents are only counted out once they are fully extracted
+  UNLOADED_ROOM *unloaded = hashGet(unloaded_rooms, idle->key);
+  long               heap = heap_in_use();
+  extract_pending();
+  unload_freed += heap - heap_in_use();
+  if(!pristine)
+    idle_count_contents(unloaded, 1);
+}
+
+//
+// keep track of rooms coming and going, and what is going on in them
+void idle_room_to_game_hook(HOOK_ARGS *args) {
+  ROOM_DATA *room = NULL;
+  hookParseArgs(args, &room);
+  idle_room_track(room);
+}
+
+void idle_room_from_game_hook(HOOK_ARGS *args) {
+  ROOM_DATA *room = NULL;
+  hookParseArgs(args, &room);
+  IDLE_ROOM *idle = hashGet(idle_rooms, roomGetClass(room));
+  if(idle != NULL && idle->room == room) {
+    hashRemove(idle_rooms, idle->key);
+    idle->gone = TRUE;
+  }
+}
+
+void idle_char_room_hook(HOOK_ARGS *args) {
+  CHAR_DATA   *ch = NULL;
+  ROOM_DATA *room = NULL;
+  hookParseArgs(args, &ch, &room);
+  idle_room_touch(room);
+}
+
+void idle_obj_room_hook(HOOK_ARGS *args) {
+  OBJ_DATA   *obj = NULL;
+  ROOM_DATA *room = NULL;
+  hookParseArgs(args, &obj, &room);
+  idle_room_touch(room);
+}
+
+
+
+//*****************************************************************************
+// implementation of idle_rooms.h
+//*****************************************************************************
+void init_idle_rooms(void) {
+  idle_rooms     = newHashtable();
+  idle_queue     = newList();
+  unloaded_rooms = newHashtable();
+
+  hookAdd("room_to_game",   idle_room_to_game_hook);
+  hookAdd("room_from_game", idle_room_from_game_hook);
+  hookAdd("char_to_room",   idle_char_room_hook);
+  hookAdd("char_from_room", idle_char_room_hook);
+  hookAdd("obj_to_room",    idle_obj_room_hook);
+  hookAdd("obj_from_room",  idle_obj_room_hook);
+}
+
+void idle_rooms_pulse(void) {
+  int idle_time = mudsettingGetInt("room_idle_time");
+  if(idle_time <= 0)
+    return;
+
+  IDLE_ROOM *idle = NULL;
+  int     checked = 0;
+  while(checked < IDLE_ROOMS_PER_PULSE &&
+	(idle = listGet(idle_queue, 0)) != NULL &&
+	(idle->gone || current_time - idle->queued >= idle_time)) {
+    listPop(idle_queue);
+    checked++;
+
+    // the room already left the game
+    if(idle->gone) {
+      deleteIdleRoom(idle);
+      continue;
+    }
+
+    // see if anything has happened since we were last put on the queue. If
+    // it has, or we are busy, go to the back of the line
+    if(current_time - idle->active < idle_time ||
+       roomIsExtracted(idle->room) || idle_room_busy(idle->room)) {
+      if(current_time - idle->active >= idle_time)
+	rooms_kept++;
+      idle->queued = current_time;
+      listQueue(idle_queue, idle);
+      continue;
+    }
+
+    // we're idle. Unload us. Extracting the room stops us being watched, and
+    // we are not on the queue any more, so nothing else will delete us
+    idle_room_unload(idle);
+    if(hashGet(idle_rooms, idle->key) == idle)
+      hashRemove(idle_rooms, idle->key);
+    deleteIdleRoom(idle);
+  }
+}
+
+void idle_room_born(ROOM_DATA *room) {
+  IDLE_ROOM *idle = hashGet(idle_rooms, roomGetClass(room));
+  if(idle != NULL && idle->room == room) {
+    idle->born  = TRUE;
+    idle->birth = room_hash(room);
+  }
+}
+
+ROOM_DATA *idle_room_restore(const char *key) {
+  UNLOADED_ROOM *unloaded = hashRemove(unloaded_rooms, key);
+  if(unloaded == NULL)
+    return NULL;
+
+  STORAGE_SET *set = storage_read_string(unloaded->data);
+  ROOM_DATA  *room = snapshot_room_read(set);
+  storage_close(set);
+
+  // the contents are about to be counted again as they come into the game
+  idle_count_contents(unloaded, -1);
+  worldPutRoom(gameworld, roomGetClass(room), room);
+  room_to_game(room);
+
+  IDLE_ROOM *idle = hashGet(idle_rooms, roomGetClass(room));
+  if(idle != NULL && idle->room == room) {
+    idle->born  = unloaded->born;
+    idle->birth = unloaded->birth;
+  }
+  if(unloaded->reset_due)
+    do_resets(room);
+  deleteUnloadedRoom(unloaded);
+  rooms_restored++;
+  return room;
+}
+
+bool idle_room_defer_reset(const char *key) {
+  UNLOADED_ROOM *unloaded = hashGet(unloaded_rooms, key);
+  if(unloaded == NULL)
+    return FALSE;
+  unloaded->reset_due = TRUE;
+  return TRUE;
+}
+
+//
+// store the prototypes an unloaded room is holding on to
+STORAGE_SET *idle_store_proto(char *proto) {
+  STORAGE_SET *set = new_storage_set();
+  store_string(set, "protos", proto);
+  return set;
+}
+
+char *idle_read_proto(STORAGE_SET *set) {
+  return strdup(read_string(set, "protos"));
+}
+
+STORAGE_SET_LIST *idle_rooms_store(void) {
+  STORAGE_SET_LIST   *list = new_storage_list();
+  HASH_ITERATOR   *room_i = newHashIterator(unloaded_rooms);
+  const char         *key = NULL;
+  UNLOADED_ROOM *unloaded = NULL;
+  ITERATE_HASH(key, unloaded, room_i) {
+    STORAGE_SET *set = new_storage_set();
+    store_string(set, "key",       key);
+    store_string(set, "data",      unloaded->data);
+    store_bool  (set, "reset_due", unloaded->reset_due);
+    store_list  (set, "mobs", gen_store_list(unloaded->mob_protos,
+					     idle_store_proto));
+    store_list  (set, "objs", gen_store_list(unloaded->obj_protos,
+					     idle_store_proto));
+    storage_list_put(list, set);
+  } deleteHashIterator(room_i);
+  return list;
+}
+
+void idle_rooms_read(STORAGE_SET_LIST *list) {
+  STORAGE_SET *set = NULL;
+  while( (set = storage_list_next(list)) != NULL) {
+    const char *key = read_string(set, "key");
+    if(hashIn(unloaded_rooms, key) || worldRoomLoaded(gameworld, key))
+      continue;
+    UNLOADED_ROOM *unloaded = newUnloadedRoom(strdup(read_string(set,"data")));
+    unloaded->reset_due = read_bool(set, "reset_due");
+    deleteListWith(unloaded->mob_protos, free);
+    deleteListWith(unloaded->obj_protos, free);
+    unloaded->mob_protos = gen_read_list(read_list(set, "mobs"),
+					 idle_read_proto);
+    unloaded->obj_protos = gen_read_list(read_list(set, "objs"),
+					 idle_read_proto);
+    idle_count_contents(unloaded, 1);
+    hashPut(unloaded_rooms, key, unloaded);
+  }
+}
+
+//
+// show how many rooms are loaded and unloaded, and what unloading has saved
+COMMAND(cmd_idlerooms) {
+  BUFFER *buf = newBuffer(MAX_BUFFER);
+  int idle_time = mudsettingGetInt("room_idle_time");
+  if(idle_time <= 0)
+    bprintf(buf, "Idle rooms are never unloaded (set room_idle_time to turn "
+	    "on).\r\n");
+  else
+    bprintf(buf, "Rooms are unloaded after %d seconds idle.\r\n", idle_time);
+  bprintf(buf, "Rooms loaded:           %d\r\n", listSize(room_list));
+  bprintf(buf, "Rooms stored unloaded:  %d (%ld kb)\r\n",
+	  hashSize(unloaded_rooms), unloaded_bytes / 1024);
+  bprintf(buf, "Rooms thrown out:       %d\r\n", rooms_discarded);
+  bprintf(buf, "Rooms stored:           %d\r\n", rooms_stored);
+  bprintf(buf, "Rooms read back in:     %d\r\n", rooms_restored);
+  bprintf(buf, "Idle rooms kept busy:   %d\r\n", rooms_kept);
+#ifdef HAVE_MALLINFO2
+  bprintf(buf, "Memory freed unloading: %ld kb\r\n", unload_freed / 1024);
+#endif
+  page_string(charGetSocket(ch), bufferString(buf));
+  deleteBuffer(buf);
+}
@@ -0,0 +1,53 @@
+#ifndef IDLE_ROOMS_H
+#define IDLE_ROOMS_H
+//*****************************************************************************
+//
+// idle_rooms.h
+//
+// Rooms are loaded from their prototypes the first time they are needed, and
+// normally stay loaded for as long as the mud is up. On big worlds, most of
+// them sit untouched for most of that time. If the "room_idle_time" mud
+// setting is turned on, then once nothing has come into or left a room for
+// that many seconds, the room is unloaded, as long as no players are in it, no
+// events or actions involve it or anything in it, and no scripts are holding
+// on to it or anything in it. It is off (0) by default.
+//
+// If a room is just as it was when it was made from its prototype, it is
+// simply thrown out. Otherwise, it and everything in it is written to a string
+// in the same way snapshots do, and read back in (with the same UIDs) the next
+// time worldGetRoom asks for it. While it is unloaded, its mobiles and objects
+// still count towards their prototypes' populations, and any reset that comes
+// due for it is run when it is read back in.
+//
+//*****************************************************************************
+
+//
+// prepare idle room unloading for use
+void init_idle_rooms(void);
+
+//
+// unload some of the rooms that have been idle for too long. Should be called
+// once per pulse, before final extractions are done
+void idle_rooms_pulse(void);
+
+//
+// the world has just made the room from its prototype. Remember how it looks,
+// so we know later whether it has changed
+void idle_room_born(ROOM_DATA *room);
+
+//
+// if the room with the key has been unloaded, read it back in, put it in the
+// world and the game, and return it. Otherwise, return NULL
+ROOM_DATA *idle_room_restore(const char *key);
+
+//
+// if the room with the key has been unloaded, note that it is due a reset and
+// return TRUE. The reset will be run when the room is read back in
+bool idle_room_defer_reset(const char *key);
+
+//
+// store and read the rooms that are unloaded, for snapshots
+STORAGE_SET_LIST *idle_rooms_store(void);
+void               idle_rooms_read(STORAGE_SET_LIST *list);
+
+#endif // IDLE_ROOMS_H
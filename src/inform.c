@@ -23,6 +23,7 @@
 #include "log.h"
 #include "inform.h"
 #include "hooks.h"
+#include "broadcast.h"
 
 
 
@@ -134,10 +135,10 @@ void look_at_obj(CHAR_DATA *ch, OBJ_DATA *obj) {
   bufferCat(charGetLookBuffer(ch), objGetDesc(obj));
 
   // do all of the preprocessing on the new descriptions
-  hookRun("preprocess_obj_desc", hookBuildInfo("obj ch", obj, ch));
+  hookRun("preprocess_obj_desc", "obj ch", obj, ch);
 
   // append anything that might also go onto it
-  hookRun("append_obj_desc", hookBuildInfo("obj ch", obj, ch));
+  hookRun("append_obj_desc", "obj ch", obj, ch);
 
   // colorize all of the edescs
   edescTagDesc(charGetLookBuffer(ch), objGetEdescs(obj), "{c", "{n");
@@ -150,7 +151,7 @@ void look_at_obj(CHAR_DATA *ch, OBJ_DATA *obj) {
   else
     send_to_char(ch, "{n%s", bufferString(charGetLookBuffer(ch)));
 
-  hookRun("look_at_obj", hookBuildInfo("obj ch", obj, ch));
+  hookRun("look_at_obj", "obj ch", obj, ch);
   send_to_char(ch, "{n");
 }
 
@@ -161,10 +162,10 @@ void look_at_exit(CHAR_DATA *ch, EXIT_DATA *exit) {
   bufferCat(charGetLookBuffer(ch), exitGetDesc(exit));
 
   // do all of our preprocessing of the description before we show it
-  hookRun("preprocess_exit_desc", hookBuildInfo("ex ch", exit, ch));
+  hookRun("preprocess_exit_desc", "ex ch", exit, ch);
 
   // append anything that might also go onto it
-  hookRun("append_exit_desc", hookBuildInfo("ex ch", exit, ch));
+  hookRun("append_exit_desc", "ex ch", exit, ch);
 
   // colorize all of the edescs
   edescTagDesc(charGetLookBuffer(ch), roomGetEdescs(exitGetRoom(exit)), 
@@ -179,7 +180,7 @@ void look_at_exit(CHAR_DATA *ch, EXIT_DATA *exit) {
   else
     send_to_char(ch, "{n%s", bufferString(charGetLookBuffer(ch)));
 
-  hookRun("look_at_exit", hookBuildInfo("ex ch", exit, ch));
+  hookRun("look_at_exit", "ex ch", exit, ch);
   send_to_char(ch, "{n");
 }
 
@@ -205,13 +206,11 @@ void list_room_exits(CHAR_DATA *ch, ROOM_DATA *room) {
   EXIT_DATA     *exit = NULL;
   ROOM_DATA       *to = NULL;
   int               i = 0;
-  LIST       *ex_list = roomGetExitNames(room);
-  LIST_ITERATOR *ex_i = newListIterator(ex_list);
-  char           *dir = NULL;
+  const char     *dir = NULL;
 
   // first, we list all of the normal exit
   for(i = 0; i < NUM_DIRS; i++) {
-    if( (exit = roomGetExit(room, dirGetName(i))) != NULL) {
+    if( (exit = roomGetDirExit(room, i)) != NULL) {
       // make sure the destination exists
       if( (to = worldGetRoom(gameworld, exitGetToFull(exit))) == NULL)
 	log_string("ERROR: room %s heads %s to room %s, which does not exist.",
@@ -222,9 +221,8 @@ void list_room_exits(CHAR_DATA *ch, ROOM_DATA *room) {
   }
 
   // next, we list all of the special exits
-  ITERATE_LIST(dir, ex_i) {
+  ITERATE_EXITS(dir, exit, room, i) {
     if(dirGetNum(dir) == DIR_NONE) {
-      exit = roomGetExit(room, dir);
       // make sure the destination exists
       if( (to = worldGetRoom(gameworld, exitGetToFull(exit))) == NULL)
 	log_string("ERROR: room %s heads %s to room %s, which does not exist.",
@@ -232,8 +230,7 @@ void list_room_exits(CHAR_DATA *ch, ROOM_DATA *room) {
       else if(can_see_exit(ch, exit))
 	list_one_exit(ch, exit, dir);
     }
-  } deleteListIterator(ex_i);
-  deleteListWith(ex_list, free);
+  }
 }
 
 
@@ -242,10 +239,10 @@ void look_at_char(CHAR_DATA *ch, CHAR_DATA *vict) {
   bufferCat(charGetLookBuffer(ch), charGetDesc(vict));
 
   // preprocess our desc before it it sent to the person
-  hookRun("preprocess_char_desc", hookBuildInfo("ch ch", vict, ch));
+  hookRun("preprocess_char_desc", "ch ch", vict, ch);
 
   // append anything that might also go onto it
-  hookRun("append_char_desc", hookBuildInfo("ch ch", vict, ch));
+  hookRun("append_char_desc", "ch ch", vict, ch);
 
   // format and send it
   bufferFormat(charGetLookBuffer(ch), SCREEN_WIDTH, PARA_INDENT);
@@ -255,7 +252,7 @@ void look_at_char(CHAR_DATA *ch, CHAR_DATA *vict) {
   else
     send_to_char(ch, "{n%s{n", bufferString(charGetLookBuffer(ch)));
 
-  hookRun("look_at_char", hookBuildInfo("ch ch", vict, ch));
+  hookRun("look_at_char", "ch ch", vict, ch);
 }
 
 
@@ -271,10 +268,10 @@ void look_at_room(CHAR_DATA *ch, ROOM_DATA *room) {
   bufferCat(charGetLookBuffer(ch), roomGetDesc(room));
 
   // do all of our preprocessing of the description before we show it
-  hookRun("preprocess_room_desc", hookBuildInfo("rm ch", room, ch));
+  hookRun("preprocess_room_desc", "rm ch", room, ch);
 
   // append anything that might also go onto it
-  hookRun("append_room_desc", hookBuildInfo("rm ch", room, ch));
+  hookRun("append_room_desc", "rm ch", room, ch);
 
   // colorize all of the edescs
   edescTagDesc(charGetLookBuffer(ch), roomGetEdescs(room), "{c", "{n");
@@ -283,14 +280,14 @@ void look_at_room(CHAR_DATA *ch, ROOM_DATA *room) {
   bufferFormat(charGetLookBuffer(ch), SCREEN_WIDTH, PARA_INDENT);
 
   // do any post-processing we might have
-  hookRun("postprocess_room_desc", hookBuildInfo("rm ch", room, ch));
+  hookRun("postprocess_room_desc", "rm ch", room, ch);
 
   if(bufferLength(charGetLookBuffer(ch)) == 0)
     send_to_char(ch, "{n%s\r\n", NOTHING_SPECIAL);
   else
     send_to_char(ch, "{n%s", bufferString(charGetLookBuffer(ch)));
 
-  hookRun("look_at_room", hookBuildInfo("rm ch", room, ch));
+  hookRun("look_at_room", "rm ch", room, ch);
   send_to_char(ch, "{n");
 }
 
@@ -312,13 +309,10 @@ void send_outdoors(const char *format, ...) {
     va_end(args);
 
     // send it out to everyone
-    LIST_ITERATOR *list_i = newListIterator(mobile_list);
+    LIST_ITERATOR *list_i = newListIterator(broadcast_outdoors());
     CHAR_DATA *ch = NULL;
     ITERATE_LIST(ch, list_i)
-      if(charGetRoom(ch) != NULL &&
-	 roomGetTerrain(charGetRoom(ch)) != TERRAIN_INDOORS &&
-	 roomGetTerrain(charGetRoom(ch)) != TERRAIN_CAVERN)
-	text_to_char(ch, buf);
+      text_to_char(ch, buf);
     deleteListIterator(list_i);
   }
 }
@@ -347,7 +341,7 @@ void send_to_char(CHAR_DATA *ch, const char *format, ...) {
     vsnprintf(buf, MAX_BUFFER, format, args);
     va_end(args);
     text_to_char(ch, buf);
-    hookRun("char_receive_text", hookBuildInfo("ch str", ch, buf));
+    hookRun("char_receive_text", "ch str", ch, buf);
     return;
   }
 }
@@ -382,14 +376,27 @@ void send_to_groups(const char *groups, const char *format, ...) {
   vsnprintf(buf, MAX_BUFFER, format, args);
   va_end(args);
 
-  LIST_ITERATOR *ch_i = newListIterator(mobile_list);
-  CHAR_DATA       *ch = NULL;
-
-  ITERATE_LIST(ch, ch_i) {
-    if(!charGetSocket(ch) || !bitIsSet(charGetUserGroups(ch), groups))
+  // go through the players in each group. Someone in more than one of the
+  // groups only gets the message once
+  LIST          *group_list = parse_keywords(groups);
+  LIST_ITERATOR    *group_i = newListIterator(group_list);
+  SET                 *sent = newSet();
+  char               *group = NULL;
+  CHAR_DATA             *ch = NULL;
+  ITERATE_LIST(group, group_i) {
+    LIST *players = broadcast_group(group);
+    if(players == NULL)
       continue;
-    text_to_char(ch, buf);
-  } deleteListIterator(ch_i);
+    LIST_ITERATOR *ch_i = newListIterator(players);
+    ITERATE_LIST(ch, ch_i) {
+      if(!charGetSocket(ch) || setIn(sent, ch))
+	continue;
+      setPut(sent, ch);
+      text_to_char(ch, buf);
+    } deleteListIterator(ch_i);
+  } deleteListIterator(group_i);
+  deleteListWith(group_list, free);
+  deleteSet(sent);
 }
 
 
@@ -521,8 +528,197 @@ COMMAND(cmd_commands) {
 //*****************************************************************************
 // below this line are all of the subfunctions related to the message() 
 // function
+//
+// A message is broken into its literal text and its $ codes once, when it is
+// sent. How a code comes out for someone depends only on whether they can see
+// the thing the code is about, so everyone who can see the same things sees
+// the same text. Each of those texts is only made once per message, for the
+// first person who needs it, and given to everyone else who needs it after.
 //*****************************************************************************
 
+// which things a message is about. Also used for which of them someone can see
+#define MSSG_CH           (1 << 0)
+#define MSSG_VICT         (1 << 1)
+#define MSSG_OBJ          (1 << 2)
+#define MSSG_VOBJ         (1 << 3)
+#define MSSG_NUM_SIGHTS         16 // every combination of the above
+
+//
+// one piece of a message: literal text, or a $ code to fill in
+typedef struct {
+  char         code; // the $ code, or '\0' if this is literal text
+  const char   *str; // where our literal text starts in the message...
+  int           len; // ...and how long it is
+} MSSG_SPAN;
+
+typedef struct {
+  MSSG_SPAN  *spans;
+  int     num_spans;
+  int         about; // which things the message's codes are about
+  CHAR_DATA     *ch;
+  CHAR_DATA   *vict;
+  OBJ_DATA     *obj;
+  OBJ_DATA    *vobj;
+  char *made[MSSG_NUM_SIGHTS]; // the text, for people who see certain things
+} MSSG_TEMPLATE;
+
+//
+// returns which thing a $ code is about, or 0 if it is not about anything
+int mssg_code_about(char code) {
+  switch(code) {
+  case 'n': case 'm': case 's': case 'e': return MSSG_CH;
+  case 'N': case 'M': case 'S': case 'E': return MSSG_VICT;
+  case 'o': case 'a':                     return MSSG_OBJ;
+  case 'O': case 'A':                     return MSSG_VOBJ;
+  default:                                return 0;
+  }
+}
+
+//
+// break a message up into its text and $ codes. Codes with nothing to fill
+// them in, and codes we do not know, are left out
+MSSG_TEMPLATE *newMssgTemplate(const char *str,
+			       CHAR_DATA *ch, CHAR_DATA *vict,
+			       OBJ_DATA *obj, OBJ_DATA *vobj) {
+  MSSG_TEMPLATE *tmpl = calloc(1, sizeof(MSSG_TEMPLATE));
+  const char     *pos = str;
+  int           codes = 0;
+  tmpl->ch   = ch;
+  tmpl->vict = vict;
+  tmpl->obj  = obj;
+  tmpl->vobj = vobj;
+
+  // every code can split one piece of text into two
+  while((pos = strchr(pos, '$')) != NULL) {
+    codes++;
+    pos++;
+  }
+  tmpl->spans = malloc(sizeof(MSSG_SPAN) * (2 * codes + 1));
+
+  const char *text = str;
+  for(pos = str; *pos != '\0'; pos++) {
+    if(*pos != '$')
+      continue;
+
+    // finish off the text we were reading. $$ is kept as part of it
+    int len = pos - text + (pos[1] == '$' ? 1 : 0);
+    if(len > 0) {
+      MSSG_SPAN *span = tmpl->spans + tmpl->num_spans++;
+      span->code = '\0';
+      span->str  = text;
+      span->len  = len;
+    }
+
+    // a $ at the very end has nothing after it
+    if(*(++pos) == '\0')
+      return tmpl;
+    text = pos + 1;
+
+    int about = mssg_code_about(*pos);
+    if((about == MSSG_CH   && ch   != NULL) ||
+       (about == MSSG_VICT && vict != NULL) ||
+       (about == MSSG_OBJ  && obj  != NULL) ||
+       (about == MSSG_VOBJ && vobj != NULL)) {
+      MSSG_SPAN *span = tmpl->spans + tmpl->num_spans++;
+      span->code  = *pos;
+      tmpl->about |= about;
+    }
+  }
+
+  // and the text after our last code
+  if(pos > text) {
+    MSSG_SPAN *span = tmpl->spans + tmpl->num_spans++;
+    span->code = '\0';
+    span->str  = text;
+    span->len  = pos - text;
+  }
+  return tmpl;
+}
+
+void deleteMssgTemplate(MSSG_TEMPLATE *tmpl) {
+  int i;
+  for(i = 0; i < MSSG_NUM_SIGHTS; i++)
+    if(tmpl->made[i] != NULL)
+      free(tmpl->made[i]);
+  free(tmpl->spans);
+  free(tmpl);
+}
+
+//
+// returns which of the things the message is about the character can see
+int mssg_sight(MSSG_TEMPLATE *tmpl, CHAR_DATA *to) {
+  int sight = 0;
+  if(IS_SET(tmpl->about, MSSG_CH)   && can_see_char(to, tmpl->ch))
+    SET_BIT(sight, MSSG_CH);
+  if(IS_SET(tmpl->about, MSSG_VICT) && can_see_char(to, tmpl->vict))
+    SET_BIT(sight, MSSG_VICT);
+  if(IS_SET(tmpl->about, MSSG_OBJ)  && can_see_obj(to, tmpl->obj))
+    SET_BIT(sight, MSSG_OBJ);
+  if(IS_SET(tmpl->about, MSSG_VOBJ) && can_see_obj(to, tmpl->vobj))
+    SET_BIT(sight, MSSG_VOBJ);
+  return sight;
+}
+
+//
+// returns what a $ code comes out as for someone who can see the things in
+// sight
+const char *mssg_fill_code(MSSG_TEMPLATE *tmpl, char code, int sight) {
+  bool  see_ch = IS_SET(sight, MSSG_CH);
+  bool see_vch = IS_SET(sight, MSSG_VICT);
+  switch(code) {
+  case 'n': return (see_ch  ? charGetName(tmpl->ch)   : SOMEONE);
+  case 'N': return (see_vch ? charGetName(tmpl->vict) : SOMEONE);
+  case 'm': return (see_ch  ? HIMHER(tmpl->ch)        : SOMEONE);
+  case 'M': return (see_vch ? HIMHER(tmpl->vict)      : SOMEONE);
+  case 's': return (see_ch  ? HISHER(tmpl->ch)        : SOMEONE"'s");
+  case 'S': return (see_vch ? HISHER(tmpl->vict)      : SOMEONE"'s");
+  case 'e': return (see_ch  ? HESHE(tmpl->ch)         : SOMEONE);
+  case 'E': return (see_vch ? HESHE(tmpl->vict)       : SOMEONE);
+  case 'o':
+    return (IS_SET(sight, MSSG_OBJ)  ? objGetName(tmpl->obj)  : SOMETHING);
+  case 'O':
+    return (IS_SET(sight, MSSG_VOBJ) ? objGetName(tmpl->vobj) : SOMETHING);
+  case 'a':
+    return AN((IS_SET(sight, MSSG_OBJ) ? objGetName(tmpl->obj) : SOMETHING));
+  case 'A':
+    return AN((IS_SET(sight, MSSG_VOBJ) ? objGetName(tmpl->vobj):SOMETHING));
+  default:  return "";
+  }
+}
+
+//
+// returns the message as it looks to someone who can see the things in sight.
+// It is made the first time it is asked for, and kept until the template is
+// deleted
+const char *mssg_make(MSSG_TEMPLATE *tmpl, int sight) {
+  if(tmpl->made[sight] == NULL) {
+    static char buf[MAX_BUFFER];
+    int i, len = 0;
+    for(i = 0; i < tmpl->num_spans && len < MAX_BUFFER - 1; i++) {
+      MSSG_SPAN *span = tmpl->spans + i;
+      if(span->code == '\0')
+	len += snprintf(buf + len, MAX_BUFFER - len, "%.*s",
+			span->len, span->str);
+      else
+	len += snprintf(buf + len, MAX_BUFFER - len, "%s",
+			mssg_fill_code(tmpl, span->code, sight));
+    }
+    if(len < MAX_BUFFER)
+      snprintf(buf + len, MAX_BUFFER - len, "{n\r\n");
+    tmpl->made[sight] = strdup(buf);
+  }
+  return tmpl->made[sight];
+}
+
+//
+// send the message to one person
+void mssg_send(MSSG_TEMPLATE *tmpl, CHAR_DATA *to) {
+  // if there's nothing to send the message to, don't go through all
+  // the work it takes to figure out how it looks to them
+  if(charGetSocket(to) != NULL)
+    text_to_char(to, mssg_make(tmpl, mssg_sight(tmpl, to)));
+}
+
 //
 // Send a message out
 //
@@ -544,98 +740,11 @@ void send_message(CHAR_DATA *to,
 		  const char *str,
 		  CHAR_DATA *ch, CHAR_DATA *vict,
 		  OBJ_DATA *obj, OBJ_DATA *vobj) {
-  static char buf[MAX_BUFFER];
-  int i, j;
-  *buf = '\0';
-
-  // if there's nothing to send the message to, don't go through all
-  // the work it takes to parse the string
   if(charGetSocket(to) == NULL)
     return;
-
-  for(i = 0, j = 0; str[i] != '\0'; i++) {
-    if(str[i] != '$') {
-      buf[j] = str[i];
-      j++;
-    }
-    else {
-      i++;
-
-      switch(str[i]) {
-      case 'n':
-	if(!ch) break;
-	sprintf(buf+j, see_char_as(to, ch));
-	while(buf[j] != '\0') j++;
-	break;
-      case 'N':
-	if(!vict) break;
-	sprintf(buf+j, see_char_as(to, vict));
-	while(buf[j] != '\0') j++;
-	break;
-      case 'm':
-	if(!ch) break;
-	sprintf(buf+j, (can_see_char(to, ch) ? HIMHER(ch) : SOMEONE));
-	while(buf[j] != '\0') j++;
-	break;
-      case 'M':
-	if(!vict) break;
-	sprintf(buf+j, (can_see_char(to, vict) ? HIMHER(vict) : SOMEONE));
-	while(buf[j] != '\0') j++;
-	break;
-      case 's':
-	if(!ch) break;
-	sprintf(buf+j, (can_see_char(to, ch) ? HISHER(ch) :SOMEONE"'s"));
-	while(buf[j] != '\0') j++;
-	break;
-      case 'S':
-	if(!vict) break;
-	sprintf(buf+j, (can_see_char(to, vict) ? HISHER(vict) :SOMEONE"'s"));
-	while(buf[j] != '\0') j++;
-	break;
-      case 'e':
-	if(!ch) break;
-	sprintf(buf+j, (can_see_char(to, ch) ? HESHE(ch) : SOMEONE));
-	while(buf[j] != '\0') j++;
-	break;
-      case 'E':
-	if(!vict) break;
-	sprintf(buf+j, (can_see_char(to, vict) ? HESHE(vict) : SOMEONE));
-	while(buf[j] != '\0') j++;
-	break;
-      case 'o':
-	if(!obj) break;
-	sprintf(buf+j, see_obj_as(to, obj));
-	while(buf[j] != '\0') j++;
-	break;
-      case 'O':
-	if(!vobj) break;
-	sprintf(buf+j, see_obj_as(to, vobj));
-	while(buf[j] != '\0') j++;
-	break;
-      case 'a':
-	if(!obj) break;
-	sprintf(buf+j, AN(see_obj_as(to, obj)));
-	while(buf[j] != '\0') j++;
-	break;
-      case 'A':
-	if(!vobj) break;
-	sprintf(buf+j, AN(see_obj_as(to, vobj)));
-	while(buf[j] != '\0') j++;
-	break;
-      case '$':
-	buf[j] = '$';
-	j++;
-	break;
-      default:
-	// do nothing
-	break;
-      }
-    }
-  }
-
-  //  buf[0] = toupper(buf[0]);
-  sprintf(buf+j, "{n\r\n");
-  text_to_char(to, buf);
+  MSSG_TEMPLATE *tmpl = newMssgTemplate(str, ch, vict, obj, vobj);
+  mssg_send(tmpl, to);
+  deleteMssgTemplate(tmpl);
 }
 
 
@@ -646,6 +755,8 @@ void message(CHAR_DATA *ch,  CHAR_DATA *vict,
   if(!mssg || !*mssg)
     return;
 
+  MSSG_TEMPLATE *tmpl = newMssgTemplate(mssg, ch, vict, obj, vobj);
+
   // what's our scope?
   if(IS_SET(range, TO_VICT) && vict &&
      (!hide_nosee ||
@@ -653,16 +764,16 @@ void message(CHAR_DATA *ch,  CHAR_DATA *vict,
       // object if there is no character
       ((!ch || can_see_char(vict, ch)) &&
        (ch  || (!obj || can_see_obj(vict, obj))))))
-    send_message(vict, mssg, ch, vict, obj, vobj);
+    mssg_send(tmpl, vict);
 
   // characters can always see themselves. No need to do checks here
   if(IS_SET(range, TO_CHAR) && ch)
-    send_message(ch, mssg, ch, vict, obj, vobj);
+    mssg_send(tmpl, ch);
 
   LIST *recipients = NULL;
   // check if the scope of this message is everyone in the world
   if(IS_SET(range, TO_WORLD))
-    recipients = mobile_list;
+    recipients = broadcast_players();
   else if(IS_SET(range, TO_ROOM) && charGetRoom(ch) != NULL)
     recipients = roomGetCharacters(charGetRoom(ch));
 
@@ -676,8 +787,9 @@ void message(CHAR_DATA *ch,  CHAR_DATA *vict,
       // if we wanted to send to ch or vict, we would have already...
       if(rec == vict || rec == ch)
 	continue;
-      // skip by people who are in the game but not in the world yet
-      if(charGetRoom(rec) == NULL)
+      // skip by people who are in the game but not in the world yet, and
+      // people who would not see the message anyways
+      if(charGetRoom(rec) == NULL || charGetSocket(rec) == NULL)
 	continue;
       if(rec == ch ||
 	 (!hide_nosee ||
@@ -685,9 +797,11 @@ void message(CHAR_DATA *ch,  CHAR_DATA *vict,
 	  // object if there is no character
 	  ((!ch || can_see_char(rec, ch)) &&
 	   (ch  || (!obj || can_see_obj(rec, obj))))))
-      send_message(rec, mssg, ch, vict, obj, vobj);
+	mssg_send(tmpl, rec);
     } deleteListIterator(rec_i);
   }
+
+  deleteMssgTemplate(tmpl);
 }
 
 void mssgprintf(CHAR_DATA *ch, CHAR_DATA *vict, 
@@ -713,89 +827,82 @@ void mssgprintf(CHAR_DATA *ch, CHAR_DATA *vict,
 //
 // appends all of our exit extra descriptions to the room description.
 void exit_append_room_hook(BUFFER *buf, ROOM_DATA *room, CHAR_DATA *ch) {
-  LIST       *exnames = roomGetExitNames(room);
-  LIST       *ex_same = newList(); // leads to room w/ same name
-  LIST       *ex_diff = newList(); // leads to room w/ diff name
-  LIST     *ex_closed = newList(); // there is a closed door blocking us
-  LIST_ITERATOR *ex_i = newListIterator(exnames);
-  char            *ex = NULL;
+  int       num_exits = roomGetNumExits(room);
+  if(num_exits == 0)
+    return;
+
+  // exits are remembered by their number in the room
+  int ex_same[num_exits];   // leads to room w/ same name
+  int ex_diff[num_exits];   // leads to room w/ diff name
+  int ex_closed[num_exits]; // there is a closed door blocking us
+  int num_same = 0, num_diff = 0, num_closed = 0;
+  const char     *ex = NULL;
+  EXIT_DATA    *exit = NULL;
+  int             i = 0;
 
   // figure out our exits that lead to same-room-name 
   // or different-room-name destinations.
-  ITERATE_LIST(ex, ex_i) {
-    EXIT_DATA *exit = roomGetExit(room, ex);
+  ITERATE_EXITS(ex, exit, room, i) {
     ROOM_DATA *dest = worldGetRoom(gameworld, exitGetToFull(exit));
     if(dest && can_see_exit(ch, exit) && dirGetNum(ex) != DIR_NONE) {
       if(exitIsClosed(exit))
-	listPut(ex_closed, ex);
+	ex_closed[num_closed++] = i;
       else if(!strcasecmp(roomGetName(room), roomGetName(dest)))
-	listPush(ex_same, ex);
+	ex_same[num_same++] = i;
       else
-	listQueue(ex_diff, ex);
+	ex_diff[num_diff++] = i;
     }
-  } deleteListIterator(ex_i);
+  }
 
   // append info for dirs that are blocked by doors
-  ex_i = newListIterator(ex_closed);
-  ITERATE_LIST(ex, ex_i) {
-    EXIT_DATA *exit = roomGetExit(room, ex);
+  for(i = 0; i < num_closed; i++) {
+    roomGetExitAt(room, ex_closed[i], &ex, &exit);
     bprintf(buf, " %s%s, you see %s.",
 	    (dirGetNum(ex) == DIR_NONE ? "At the exit " : ""), ex,
 	    (*exitGetName(exit) ? exitGetName(exit) : "a door"));
-  } deleteListIterator(ex_i);
+  }
 
   // append info for dirs that exit to other room names
-  ex_i = newListIterator(ex_diff);
-  ITERATE_LIST(ex, ex_i) {
-    ROOM_DATA *dest = worldGetRoom(gameworld, exitGetToFull(roomGetExit(room, ex)));
+  for(i = 0; i < num_diff; i++) {
+    roomGetExitAt(room, ex_diff[i], &ex, &exit);
+    ROOM_DATA *dest = worldGetRoom(gameworld, exitGetToFull(exit));
     bprintf(buf, " Continuing %s would take you to %s.", ex, roomGetName(dest));
-  } deleteListIterator(ex_i);
+  }
 
   // and now print stuff for exits that go to rooms with the name name
-  if(listSize(ex_same) > 0) {
+  if(num_same > 0) {
     // if we just have a couple exits, list them off
-    if(listSize(ex_same) <= 3) {
-      char *list = print_list(ex_same, identity_func, NULL);
-      bprintf(buf, " %s continues %s.", roomGetName(room), list);
-      free(list);
+    if(num_same <= 3) {
+      bprintf(buf, " %s continues", roomGetName(room));
+      for(i = 0; i < num_same; i++) {
+	roomGetExitAt(room, ex_same[i], &ex, &exit);
+	bprintf(buf, "%s%s", (i == 0 ? " " : (i < num_same - 1 ? ", " :
+					      (i == 1 ? " and " : ", and "))),
+		ex);
+      }
+      bprintf(buf, ".");
     }
     // else display in bulk
     else {
       bprintf(buf, " All %sdiretions continue to %s.", 
-	      (listSize(ex_same) == listSize(exnames) ? "" : "other "),
+	      (num_same == num_exits ? "" : "other "),
 	      roomGetName(room));
     }
   }
-
-  // clean up our garbage
-  deleteList(ex_diff);
-  deleteList(ex_same);
-  deleteList(ex_closed);
-  deleteListWith(exnames, free);
 }
 
-void exit_append_hook(const char *info) {
+void exit_append_hook(HOOK_ARGS *args) {
   // before anything, figure out some basic information like our dir and dest
   EXIT_DATA     *exit = NULL;
   CHAR_DATA       *ch = NULL;
-  hookParseInfo(info, &exit, &ch);
+  hookParseArgs(args, &exit, &ch);
 
   BUFFER         *buf = charGetLookBuffer(ch);
   ROOM_DATA     *room = exitGetRoom(exit);
   ROOM_DATA     *dest = worldGetRoom(gameworld, exitGetToFull(exit));
-  LIST       *exnames = roomGetExitNames(room);
-  LIST_ITERATOR *ex_i = newListIterator(exnames);
-  char            *ex = NULL;
-  char           *dir = NULL;
 
   // figure out which direction we came from
-  ITERATE_LIST(ex, ex_i) {
-    if(roomGetExit(room, ex) == exit) {
-      dir = strdup(ex);
-      break;
-    }
-  } deleteListIterator(ex_i);
-  deleteListWith(exnames, free);
+  const char     *dir = roomGetExitDir(room, exit);
 
   // tell us where it would take us
   if(dest && !*exitGetDesc(exit) && !exitIsClosed(exit)) {
@@ -813,15 +920,12 @@ void exit_append_hook(const char *info) {
 	    (*exitGetName(exit) ? exitGetName(exit) : "a door"),
 	    (exitIsClosed(exit) ? "closed" : "open"));
   }
-
-  // garbage collection
-  if(dir) free(dir);
 }
 
-void exit_look_hook(const char *info) {
+void exit_look_hook(HOOK_ARGS *args) {
   EXIT_DATA *exit = NULL;
   CHAR_DATA   *ch = NULL;
-  hookParseInfo(info, &exit, &ch);
+  hookParseArgs(args, &exit, &ch);
   // the door is not closed, list off the people we can see as well
   if(!exitIsClosed(exit)) {
     ROOM_DATA *room = worldGetRoom(gameworld, exitGetToFull(exit));
@@ -830,10 +934,10 @@ void exit_look_hook(const char *info) {
   }
 }
 
-void room_look_hook(const char *info) {
+void room_look_hook(HOOK_ARGS *args) {
   ROOM_DATA *room = NULL;
   CHAR_DATA   *ch = NULL;
-  hookParseInfo(info, &room, &ch);
+  hookParseArgs(args, &room, &ch);
   list_room_exits(ch, room);
   list_room_contents(ch, room);
 }
@@ -54,6 +54,8 @@ void init_commands() {
   //add_cmd("groupcmds",  NULL, cmd_groupcmds,   "player", FALSE);
   add_cmd("look",       "l",  cmd_look,        "player", FALSE);
   add_cmd("more",       NULL, cmd_more,        "player", FALSE);
+  add_cmd("tickstats",  NULL, cmd_tickstats,   "admin",  FALSE);
+  add_cmd("idlerooms",  NULL, cmd_idlerooms,   "admin",  FALSE);
   add_cmd_check("look",        chk_conscious);
 }
 
@@ -327,8 +329,8 @@ void do_cmd(CHAR_DATA *ch, char *arg, bool aliases_ok)  {
 	  // run the check
 	  if((ret = charTryCmd(ch, check, arg)) != -1) {
 	    if(ret == TRUE)
-	      hookRun("command", hookBuildInfo("ch str str",
-					       ch,cmdGetName(cmd),arg));
+	      hookRun("command", "ch str str",
+					       ch,cmdGetName(cmd),arg);
  	    found = TRUE;
 	    break;
 	  }
@@ -342,7 +344,7 @@ void do_cmd(CHAR_DATA *ch, char *arg, bool aliases_ok)  {
       // execute the command
       if((ret = charTryCmd(ch, cmd, arg)) != -1) {
 	if(ret == TRUE)
-	  hookRun("command",hookBuildInfo("ch str str",ch,cmdGetName(cmd),arg));
+	  hookRun("command","ch str str",ch,cmdGetName(cmd),arg);
 	found = TRUE;
 	break;
       }
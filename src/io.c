@@ -9,6 +9,8 @@
 #include <stdarg.h>
 #include <ctype.h>
 #include <stdlib.h>
+#include <fcntl.h>
+#include <pthread.h>
 
 /* include main header file */
 #include "mud.h"
@@ -17,6 +19,164 @@
 //extern FILE *stderr;
 time_t current_time;
 
+
+
+//*****************************************************************************
+// asynchronous appending to files
+//
+// Writing logs used to mean an fopen, fprintf, and fclose for every line. Now
+// lines are put on a queue, and a background thread writes them out. The
+// files most recently written to are kept open, so busy logs are not reopened
+// for every line.
+//*****************************************************************************
+
+// how many lines can be waiting to be written before we have to wait
+#define APPEND_QUEUE_SIZE     1024
+
+// how many files we keep open at once
+#define APPEND_OPEN_FILES        8
+
+typedef struct {
+  char *file;
+  char *text;
+} APPEND_ENTRY;
+
+typedef struct {
+  char          *file;
+  FILE            *fp;
+  unsigned long  used; // when we were last written to, for dropping old files
+} APPEND_FILE;
+
+APPEND_ENTRY   append_queue[APPEND_QUEUE_SIZE];
+int             append_head = 0;     // the next entry to be written
+int            append_count = 0;     // how many entries are waiting
+bool            append_busy = FALSE; // is the writer writing a batch?
+APPEND_FILE     append_open[APPEND_OPEN_FILES];
+unsigned long  append_clock = 0;
+
+pthread_mutex_t append_lock  = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t  append_ready = PTHREAD_COND_INITIALIZER; // there is work to do
+pthread_cond_t  append_done  = PTHREAD_COND_INITIALIZER; // work has been done
+pthread_once_t  append_once  = PTHREAD_ONCE_INIT;
+
+//
+// find an open handle for the file, opening it if we need to. If we are
+// already keeping as many files open as we can, close the least recently used
+FILE *append_get_file(const char *file) {
+  int i, oldest = 0;
+  for(i = 0; i < APPEND_OPEN_FILES; i++) {
+    if(append_open[i].file && !strcmp(append_open[i].file, file)) {
+      append_open[i].used = ++append_clock;
+      return append_open[i].fp;
+    }
+    if(append_open[i].used < append_open[oldest].used)
+      oldest = i;
+  }
+
+  FILE *fp = fopen(file, "a");
+  if(fp == NULL)
+    return NULL;
+
+  // our handles should not be inherited by the new process on copyover
+  fcntl(fileno(fp), F_SETFD, FD_CLOEXEC);
+  if(append_open[oldest].file) {
+    fclose(append_open[oldest].fp);
+    free(append_open[oldest].file);
+  }
+  append_open[oldest].file = strdup(file);
+  append_open[oldest].fp   = fp;
+  append_open[oldest].used = ++append_clock;
+  return fp;
+}
+
+//
+// the background writer. Takes everything waiting on the queue, writes it all
+// out, and then goes back to waiting
+void *append_writer(void *arg) {
+  APPEND_ENTRY batch[APPEND_QUEUE_SIZE];
+  int i, size;
+
+  block_thread_signals();
+  pthread_mutex_lock(&append_lock);
+  for(;;) {
+    while(append_count == 0)
+      pthread_cond_wait(&append_ready, &append_lock);
+
+    // take everything that is waiting, and let writers continue
+    for(size = 0; append_count > 0; size++, append_count--) {
+      batch[size] = append_queue[append_head];
+      append_head = (append_head + 1) % APPEND_QUEUE_SIZE;
+    }
+    append_busy = TRUE;
+    pthread_cond_broadcast(&append_done);
+    pthread_mutex_unlock(&append_lock);
+
+    for(i = 0; i < size; i++) {
+      FILE *fp = append_get_file(batch[i].file);
+      if(fp == NULL)
+	fprintf(stderr, "cannot open %s for appending\n", batch[i].file);
+      else
+	fputs(batch[i].text, fp);
+      free(batch[i].file);
+      free(batch[i].text);
+    }
+    for(i = 0; i < APPEND_OPEN_FILES; i++)
+      if(append_open[i].fp)
+	fflush(append_open[i].fp);
+
+    pthread_mutex_lock(&append_lock);
+    append_busy = FALSE;
+    pthread_cond_broadcast(&append_done);
+  }
+  return NULL;
+}
+
+//
+// start up our writer the first time something needs appending
+void append_start(void) {
+  pthread_t      thread;
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+  pthread_create(&thread, &attr, append_writer, NULL);
+  pthread_attr_destroy(&attr);
+
+  // make sure nothing is lost when we exit normally
+  atexit(flush_appends);
+}
+
+void append_to_file(const char *file, const char *fmt, ...) {
+  va_list args;
+  char    *text = NULL;
+  int      size = 0;
+
+  va_start(args, fmt);
+  size = vsnprintf(NULL, 0, fmt, args);
+  va_end(args);
+  text = malloc(size + 1);
+  va_start(args, fmt);
+  vsnprintf(text, size + 1, fmt, args);
+  va_end(args);
+
+  pthread_once(&append_once, append_start);
+  pthread_mutex_lock(&append_lock);
+  while(append_count == APPEND_QUEUE_SIZE)
+    pthread_cond_wait(&append_done, &append_lock);
+  append_queue[(append_head+append_count) % APPEND_QUEUE_SIZE].file = 
+    strdup(file);
+  append_queue[(append_head+append_count) % APPEND_QUEUE_SIZE].text = text;
+  append_count++;
+  pthread_cond_signal(&append_ready);
+  pthread_mutex_unlock(&append_lock);
+}
+
+void flush_appends(void) {
+  pthread_mutex_lock(&append_lock);
+  while(append_count > 0 || append_busy)
+    pthread_cond_wait(&append_done, &append_lock);
+  pthread_mutex_unlock(&append_lock);
+}
+
 /*
  * Nifty little extendable logfunction,
  * if it wasn't for Erwins social editor,
@@ -25,7 +185,6 @@ time_t current_time;
  */
 void log_string(const char *txt, ...)
 {
-  FILE *fp;
   char logfile[MAX_BUFFER];
   char buf[MAX_BUFFER];
   char *strtime = get_time();
@@ -38,16 +197,7 @@ void log_string(const char *txt, ...)
   /* point to the correct logfile */
   snprintf(logfile, MAX_BUFFER, "../log/%6.6s.log", strtime);
 
-  /* try to open logfile */
-  if ((fp = fopen(logfile, "a")) == NULL)
-  {
-    communicate(NULL, "log: cannot open logfile", COMM_LOG);
-    return;
-  }
-
-  fprintf(fp, "%s: %s\n", strtime, buf);
-  fclose(fp);
-
+  append_to_file(logfile, "%s: %s\n", strtime, buf);
   communicate(NULL, buf, COMM_LOG);
 }
 
@@ -59,7 +209,6 @@ void log_string(const char *txt, ...)
  */
 void bug(const char *txt, ...)
 {
-  FILE *fp;
   char buf[MAX_BUFFER];
   va_list args;
   char *strtime = get_time();
@@ -68,16 +217,7 @@ void bug(const char *txt, ...)
   vsnprintf(buf, MAX_BUFFER, txt, args);
   va_end(args);
 
-  /* try to open logfile */
-  if ((fp = fopen("../log/bugs.txt", "a")) == NULL)
-  {
-    communicate(NULL, "bug: cannot open bugfile", COMM_LOG);
-    return;
-  }
-
-  fprintf(fp, "%s: %s\n", strtime, buf);
-  fclose(fp);
-
+  append_to_file("../log/bugs.txt", "%s: %s\n", strtime, buf);
   communicate(NULL, buf, COMM_LOG);
 }
 
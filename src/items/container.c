@@ -473,10 +473,10 @@ void container_to_proto(CONTAINER_DATA *data, BUFFER *buf) {
 //*****************************************************************************
 // hooks
 //*****************************************************************************
-void container_append_hook(const char *info) {
+void container_append_hook(HOOK_ARGS *args) {
   OBJ_DATA *obj = NULL;
   CHAR_DATA *ch = NULL;
-  hookParseInfo(info, &obj, &ch);
+  hookParseArgs(args, &obj, &ch);
 
   if(objIsType(obj, "container")) {
     bprintf(charGetLookBuffer(ch), " It is %s%s.", 
@@ -485,10 +485,10 @@ void container_append_hook(const char *info) {
   }
 }
 
-void container_look_hook(const char *info) {
+void container_look_hook(HOOK_ARGS *args) {
   OBJ_DATA *obj = NULL;
   CHAR_DATA *ch = NULL;
-  hookParseInfo(info, &obj, &ch);
+  hookParseArgs(args, &obj, &ch);
 
   if(objIsType(obj, "container") && !containerIsClosed(obj)) {
     LIST *vis_contents = find_all_objs(ch, objGetContents(obj), "", 
@@ -257,10 +257,10 @@ int PyObj_setfurntype(PyObject *self, PyObject *value, void *closure) {
 //*****************************************************************************
 // hooks
 //*****************************************************************************
-void furniture_append_hook(const char *info) {
+void furniture_append_hook(HOOK_ARGS *args) {
   OBJ_DATA *obj = NULL;
   CHAR_DATA *ch = NULL;
-  hookParseInfo(info, &obj, &ch);
+  hookParseArgs(args, &obj, &ch);
 
   if(objIsType(obj, "furniture")) {
     int num_sitters = listSize(objGetUsers(obj));
@@ -173,8 +173,8 @@ COMMAND(cmd_enter) {
       else
 	message(ch, NULL, obj, NULL, TRUE, TO_ROOM,
 		"$n arrives after travelling through $o.");
-      hookRun("enter_portal", hookBuildInfo("ch obj", ch, obj));
-      hookRun("enter", hookBuildInfo("ch rm", ch, dest));
+      hookRun("enter_portal", "ch obj", ch, obj);
+      hookRun("enter", "ch rm", ch, dest);
     }
   }
 }
@@ -361,10 +361,10 @@ int PyObj_setportalentermssg(PyObject *self, PyObject *value, void *closure) {
 //*****************************************************************************
 // add our hookds
 //*****************************************************************************
-void portal_look_hook(const char *info) {
+void portal_look_hook(HOOK_ARGS *args) {
   OBJ_DATA *obj = NULL;
   CHAR_DATA *ch = NULL;
-  hookParseInfo(info, &obj, &ch);
+  hookParseArgs(args, &obj, &ch);
 
   if(objIsType(obj, "portal")) {
     ROOM_DATA *dest = worldGetRoom(gameworld, portalGetSmartDest(obj));
@@ -77,10 +77,10 @@ const char *wornTypeGetPositions(const char *type) {
 
 //
 // append information about where the item can be worn
-void append_worn_hook(const char *info) {
+void append_worn_hook(HOOK_ARGS *args) {
   OBJ_DATA *obj = NULL;
   CHAR_DATA *ch = NULL;
-  hookParseInfo(info, &obj, &ch);
+  hookParseArgs(args, &obj, &ch);
 
   if(objIsType(obj, "worn")) {
     bprintf(charGetLookBuffer(ch),"When worn, this item covers bodyparts: %s.",
@@ -0,0 +1,441 @@
+//*****************************************************************************
+//
+// jobs.c
+//
+// A fixed pool of worker threads. Each worker has its own deque of jobs; new
+// jobs are dealt out to the workers in turn, and workers take the newest job
+// off of their own deque. A worker with nothing left to do steals the oldest
+// job from another worker's deque before going to sleep. Finished jobs are put
+// on a completion queue, which the game thread works through each pulse.
+//
+// Only the game thread starts jobs and calls their completions, so the table
+// of pending jobs is never touched by the workers.
+//
+//*****************************************************************************
+
+#include <pthread.h>
+#include <sys/time.h>
+#include <zlib.h>
+
+#include "mud.h"
+#include "utils.h"
+#include "jobs.h"
+
+
+
+//*****************************************************************************
+// local datastructures, functions, and defines
+//*****************************************************************************
+
+// how many jobs a deque can hold before it has to grow
+#define JOB_DEQUE_SIZE          16
+
+// how much bigger than its input we first guess decompressed data will be
+#define JOB_INFLATE_GUESS        4
+
+typedef struct job_data JOB;
+struct job_data {
+  int                                 id;
+  void   *(* work)(void *data);
+  void    (* done)(void *data, void *result);
+  void                             *data;
+  void                           *result;
+  bool                          finished; // guarded by done_lock
+  JOB                              *next; // the next job waiting to complete
+};
+
+//
+// one worker's jobs. Jobs are numbered upwards as they are added; the oldest
+// is numbered top, and bottom is the number the next job will get
+typedef struct {
+  pthread_mutex_t  lock;
+  JOB            **jobs;
+  int          capacity;
+  int               top;
+  int            bottom;
+} JOB_DEQUE;
+
+// the workers, and their jobs
+pthread_t      *job_workers = NULL;
+JOB_DEQUE       *job_deques = NULL;
+int             num_workers = 0;
+
+// how many jobs are sitting in deques, for workers deciding whether to sleep
+pthread_mutex_t   pool_lock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t    pool_wake = PTHREAD_COND_INITIALIZER;
+int             jobs_queued = 0;
+
+// jobs that are finished and waiting for their completions to be called
+pthread_mutex_t   done_lock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t    done_cond = PTHREAD_COND_INITIALIZER;
+JOB              *done_head = NULL;
+JOB              *done_tail = NULL;
+int              done_count = 0;
+int         jobs_unfinished = 0; // started, but not yet finished
+
+// how long the work has taken. Guarded by done_lock
+int                jobs_run = 0;
+double            jobs_time = 0;
+double             jobs_max = 0;
+
+// game thread only; every job that has not had its completion called
+MAP           *pending_jobs = NULL;
+int             next_job_id = 1;
+int              next_deque = 0;
+
+//
+// the number of seconds that have passed since some time in the past
+double job_clock(void) {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  return now.tv_sec + now.tv_usec / 1000000.0;
+}
+
+void job_deque_push(JOB_DEQUE *deque, JOB *job) {
+  pthread_mutex_lock(&deque->lock);
+  if(deque->bottom - deque->top == deque->capacity) {
+    JOB **jobs = malloc(sizeof(JOB *) * deque->capacity * 2);
+    int i;
+    for(i = deque->top; i < deque->bottom; i++)
+      jobs[i - deque->top] = deque->jobs[i % deque->capacity];
+    free(deque->jobs);
+    deque->jobs      = jobs;
+    deque->bottom   -= deque->top;
+    deque->top       = 0;
+    deque->capacity *= 2;
+  }
+  deque->jobs[deque->bottom++ % deque->capacity] = job;
+  pthread_mutex_unlock(&deque->lock);
+}
+
+//
+// take the newest job off of the deque. Only its own worker does this
+JOB *job_deque_pop(JOB_DEQUE *deque) {
+  JOB *job = NULL;
+  pthread_mutex_lock(&deque->lock);
+  if(deque->bottom > deque->top)
+    job = deque->jobs[--deque->bottom % deque->capacity];
+  pthread_mutex_unlock(&deque->lock);
+  return job;
+}
+
+//
+// take the oldest job off of the deque. Other workers do this
+JOB *job_deque_steal(JOB_DEQUE *deque) {
+  JOB *job = NULL;
+  pthread_mutex_lock(&deque->lock);
+  if(deque->bottom > deque->top)
+    job = deque->jobs[deque->top++ % deque->capacity];
+  pthread_mutex_unlock(&deque->lock);
+  return job;
+}
+
+//
+// find the worker something to do; from its own deque if it can, or from
+// someone else's if it cannot. Returns NULL if there is nothing to do
+JOB *job_take(int worker) {
+  JOB *job = job_deque_pop(&job_deques[worker]);
+  int i;
+  for(i = 1; job == NULL && i < num_workers; i++)
+    job = job_deque_steal(&job_deques[(worker + i) % num_workers]);
+
+  if(job != NULL) {
+    pthread_mutex_lock(&pool_lock);
+    jobs_queued--;
+    pthread_mutex_unlock(&pool_lock);
+  }
+  return job;
+}
+
+//
+// do a job's work, and put it on the completion queue
+void job_run(JOB *job) {
+  double start = job_clock();
+  job->result  = job->work(job->data);
+  double  time = job_clock() - start;
+
+  pthread_mutex_lock(&done_lock);
+  job->finished = TRUE;
+  if(done_tail == NULL)
+    done_head = job;
+  else
+    done_tail->next = job;
+  done_tail = job;
+  done_count++;
+  jobs_unfinished--;
+  jobs_run++;
+  jobs_time += time;
+  jobs_max   = MAX(jobs_max, time);
+  pthread_cond_broadcast(&done_cond);
+  pthread_mutex_unlock(&done_lock);
+}
+
+//
+// a worker. Works while there is work, and sleeps while there is not
+void *job_worker(void *arg) {
+  int worker = (int)(long)arg;
+  block_thread_signals();
+  for(;;) {
+    JOB *job = job_take(worker);
+    if(job != NULL)
+      job_run(job);
+    else {
+      pthread_mutex_lock(&pool_lock);
+      while(jobs_queued <= 0)
+	pthread_cond_wait(&pool_wake, &pool_lock);
+      pthread_mutex_unlock(&pool_lock);
+    }
+  }
+  return NULL;
+}
+
+//
+// take a job off of the completion queue. Must be called with done_lock held
+void job_unqueue(JOB *job) {
+  JOB *prev = NULL, *curr = done_head;
+  while(curr != NULL && curr != job) {
+    prev = curr;
+    curr = curr->next;
+  }
+  if(curr == NULL)
+    return;
+  if(prev == NULL)
+    done_head  = curr->next;
+  else
+    prev->next = curr->next;
+  if(done_tail == curr)
+    done_tail  = prev;
+  curr->next = NULL;
+  done_count--;
+}
+
+//
+// call a finished job's completion, and get rid of it
+void job_complete(JOB *job) {
+  mapRemove(pending_jobs, (void *)(long)job->id);
+  if(job->done != NULL)
+    job->done(job->data, job->result);
+  free(job);
+}
+
+
+
+//*****************************************************************************
+// implementation of jobs.h
+//*****************************************************************************
+void init_jobs(void) {
+  pending_jobs = newMap(NULL, NULL);
+  num_workers  = MAX(0, mudsettingGetInt("worker_threads"));
+  if(num_workers == 0)
+    return;
+
+  job_workers = malloc(sizeof(pthread_t) * num_workers);
+  job_deques  = malloc(sizeof(JOB_DEQUE) * num_workers);
+
+  // every deque must be ready before anyone tries to steal from it
+  int i;
+  for(i = 0; i < num_workers; i++) {
+    pthread_mutex_init(&job_deques[i].lock, NULL);
+    job_deques[i].jobs     = malloc(sizeof(JOB *) * JOB_DEQUE_SIZE);
+    job_deques[i].capacity = JOB_DEQUE_SIZE;
+    job_deques[i].top      = 0;
+    job_deques[i].bottom   = 0;
+  }
+
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+  for(i = 0; i < num_workers; i++)
+    pthread_create(&job_workers[i], &attr, job_worker, (void *)(long)i);
+  pthread_attr_destroy(&attr);
+}
+
+int job_start(void *(* work)(void *data),
+	      void  (* done)(void *data, void *result),
+	      void *data) {
+  JOB *job      = malloc(sizeof(JOB));
+  job->id       = next_job_id++;
+  job->work     = work;
+  job->done     = done;
+  job->data     = data;
+  job->result   = NULL;
+  job->finished = FALSE;
+  job->next     = NULL;
+  if(next_job_id <= 0)
+    next_job_id = 1;
+  mapPut(pending_jobs, (void *)(long)job->id, job);
+
+  pthread_mutex_lock(&done_lock);
+  jobs_unfinished++;
+  pthread_mutex_unlock(&done_lock);
+
+  // no workers; do it ourself
+  if(num_workers == 0)
+    job_run(job);
+  else {
+    job_deque_push(&job_deques[next_deque], job);
+    next_deque = (next_deque + 1) % num_workers;
+    pthread_mutex_lock(&pool_lock);
+    jobs_queued++;
+    pthread_cond_signal(&pool_wake);
+    pthread_mutex_unlock(&pool_lock);
+  }
+  return job->id;
+}
+
+bool job_pending(int job) {
+  return mapIn(pending_jobs, (void *)(long)job);
+}
+
+bool job_wait(int id) {
+  JOB *job = mapGet(pending_jobs, (void *)(long)id);
+  if(job == NULL)
+    return FALSE;
+
+  pthread_mutex_lock(&done_lock);
+  while(!job->finished)
+    pthread_cond_wait(&done_cond, &done_lock);
+  job_unqueue(job);
+  pthread_mutex_unlock(&done_lock);
+  job_complete(job);
+  return TRUE;
+}
+
+void jobs_pulse(void) {
+  // completions can start jobs of their own; those wait until the next pulse
+  pthread_mutex_lock(&done_lock);
+  int count = done_count;
+  pthread_mutex_unlock(&done_lock);
+
+  for(; count > 0; count--) {
+    pthread_mutex_lock(&done_lock);
+    JOB *job = done_head;
+    if(job != NULL)
+      job_unqueue(job);
+    pthread_mutex_unlock(&done_lock);
+    // someone waited for it from within another completion
+    if(job == NULL)
+      break;
+    job_complete(job);
+  }
+}
+
+void jobs_finish(void) {
+  // completions can start more jobs; keep going until everything is done
+  for(;;) {
+    pthread_mutex_lock(&done_lock);
+    while(jobs_unfinished > 0)
+      pthread_cond_wait(&done_cond, &done_lock);
+    bool done = (done_count == 0);
+    pthread_mutex_unlock(&done_lock);
+    if(done)
+      break;
+    jobs_pulse();
+  }
+}
+
+void jobs_stats(BUFFER *buf) {
+  pthread_mutex_lock(&done_lock);
+  bprintf(buf, "Worker threads:   %d\r\n", num_workers);
+  bprintf(buf, "Jobs run:         %d (%d pending)\r\n", jobs_run,
+	  mapSize(pending_jobs));
+  bprintf(buf, "Average job:      %.2f ms\r\n",
+	  (jobs_run ? jobs_time * 1000 / jobs_run : 0));
+  bprintf(buf, "Longest job:      %.2f ms\r\n", jobs_max * 1000);
+  pthread_mutex_unlock(&done_lock);
+}
+
+void jobs_stats_clear(void) {
+  pthread_mutex_lock(&done_lock);
+  jobs_run  = 0;
+  jobs_time = jobs_max = 0;
+  pthread_mutex_unlock(&done_lock);
+}
+
+
+
+//*****************************************************************************
+// work functions for common jobs
+//*****************************************************************************
+JOB_BYTES *newJobBytes(const char *bytes, int len) {
+  JOB_BYTES *data = malloc(sizeof(JOB_BYTES));
+  data->bytes = malloc(len + 1);
+  data->len   = len;
+  if(bytes != NULL)
+    memcpy(data->bytes, bytes, len);
+  data->bytes[len] = '\0';
+  return data;
+}
+
+void deleteJobBytes(JOB_BYTES *data) {
+  free(data->bytes);
+  free(data);
+}
+
+void *job_read_file(void *path) {
+  FILE *fp = fopen(((JOB_BYTES *)path)->bytes, "rb");
+  if(fp == NULL)
+    return NULL;
+
+  JOB_BYTES *data = NULL;
+  if(fseek(fp, 0, SEEK_END) == 0) {
+    long size = ftell(fp);
+    rewind(fp);
+    if(size >= 0) {
+      data = newJobBytes(NULL, size);
+      data->len = fread(data->bytes, 1, size, fp);
+      data->bytes[data->len] = '\0';
+    }
+  }
+  fclose(fp);
+  return data;
+}
+
+void *job_compress(void *bytes) {
+  JOB_BYTES   *in = bytes;
+  uLongf      len = compressBound(in->len);
+  JOB_BYTES *data = newJobBytes(NULL, len);
+  if(compress((Bytef *)data->bytes, &len, (Bytef *)in->bytes, in->len)!=Z_OK){
+    deleteJobBytes(data);
+    return NULL;
+  }
+  data->len = len;
+  data->bytes[len] = '\0';
+  return data;
+}
+
+void *job_decompress(void *bytes) {
+  JOB_BYTES   *in = bytes;
+  int       space = MAX(in->len * JOB_INFLATE_GUESS, 64);
+  JOB_BYTES *data = newJobBytes(NULL, space);
+  z_stream   zstr;
+  int         ret = Z_OK;
+
+  memset(&zstr, 0, sizeof(zstr));
+  if(inflateInit(&zstr) != Z_OK) {
+    deleteJobBytes(data);
+    return NULL;
+  }
+  zstr.next_in  = (Bytef *)in->bytes;
+  zstr.avail_in = in->len;
+
+  // inflate as much as we can, and make more room whenever we run out
+  for(;;) {
+    zstr.next_out  = (Bytef *)data->bytes + zstr.total_out;
+    zstr.avail_out = space - zstr.total_out;
+    ret = inflate(&zstr, Z_NO_FLUSH);
+    if(ret != Z_OK || zstr.avail_out > 0)
+      break;
+    space *= 2;
+    data->bytes = realloc(data->bytes, space + 1);
+  }
+  inflateEnd(&zstr);
+
+  if(ret != Z_STREAM_END) {
+    deleteJobBytes(data);
+    return NULL;
+  }
+  data->len = zstr.total_out;
+  data->bytes[data->len] = '\0';
+  return data;
+}
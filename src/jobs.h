@@ -0,0 +1,83 @@
+#ifndef JOBS_H
+#define JOBS_H
+//*****************************************************************************
+//
+// jobs.h
+//
+// Runs work that takes a while, but does not need to touch the game, on a
+// small pool of worker threads. A job is made of two functions. The first does
+// the work on a worker thread, and hands back a result. It must only use the
+// data it was given - no characters, rooms, objects, sockets, Python, logging,
+// or anything else the game thread might be using at the same time. The
+// second is called on the game thread, during the pulse after the work is
+// done, with the data and the result, and can do whatever it likes with them.
+//
+// How many workers there are is set by the mud setting "worker_threads". If it
+// is below zero, there are none, and work is done on the game thread as soon
+// as the job is started. Its completion is still called during the next pulse.
+//
+//*****************************************************************************
+
+//
+// start up the workers
+void init_jobs(void);
+
+//
+// start a job. Returns a handle for the job, which is never 0. done may be
+// NULL, if nothing needs to be done with the result
+int job_start(void *(* work)(void *data),
+	      void  (* done)(void *data, void *result),
+	      void *data);
+
+//
+// returns whether the job has not yet had its completion called
+bool job_pending(int job);
+
+//
+// wait for a job to be finished, and call its completion straight away,
+// instead of during the next pulse. Returns FALSE if the job was not pending
+bool job_wait(int job);
+
+//
+// call the completions of every job that was finished before the pulse
+// started. Called once each pulse by the game loop
+void jobs_pulse(void);
+
+//
+// wait for every job to be finished, and call their completions. Used before
+// a copyover or shutdown, so no results are lost
+void jobs_finish(void);
+
+//
+// append how many jobs have been run, and how long they took, to the buffer,
+// or start counting again from zero
+void jobs_stats      (BUFFER *buf);
+void jobs_stats_clear(void);
+
+
+
+//*****************************************************************************
+// work functions for common jobs
+//*****************************************************************************
+
+//
+// raw bytes handed to and back from the common jobs. The bytes may contain
+// nulls, and are always followed by one that is not counted in len
+typedef struct {
+  char *bytes;
+  int     len;
+} JOB_BYTES;
+
+JOB_BYTES *newJobBytes(const char *bytes, int len);
+void    deleteJobBytes(JOB_BYTES *bytes);
+
+//
+// each takes a JOB_BYTES, and returns a new one that must be deleted, or NULL
+// if the job could not be done. job_read_file takes the name of the file as
+// its bytes, and returns what is in the file. job_compress and job_decompress
+// compress and decompress with zlib
+void *job_read_file (void *path);
+void *job_compress  (void *bytes);
+void *job_decompress(void *bytes);
+
+#endif // JOBS_H
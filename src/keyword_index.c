@@ -0,0 +1,343 @@
+//*****************************************************************************
+//
+// keyword_index.c
+//
+// Keeps mobiles and objects indexed by the first few letters of each of their
+// keywords, so searches by name only have to check the things that share the
+// first few letters of what is being looked for. The world's indexes are kept
+// in the same order as mobile_list and object_list, and a container's index in
+// the same order as the container, so 2.sword still finds the same sword.
+//
+//*****************************************************************************
+
+#include "mud.h"
+#include "utils.h"
+#include "character.h"
+#include "object.h"
+#include "room.h"
+#include "keyword_index.h"
+
+
+
+//*****************************************************************************
+// local datastructures, functions, and defines
+//*****************************************************************************
+
+// how many letters of a keyword things are indexed under. Searches for names
+// shorter than this cannot use an index
+#define KEYWORD_PREFIX_LEN          3
+
+// how many things a container must hold before it is worth indexing, and how
+// many containers we keep indexes for at once
+#define KEYWORD_CONTAINER_MIN      32
+#define KEYWORD_CONTAINERS_MAX     64
+
+//
+// where we have put something in the world's index
+typedef struct {
+  char        *indexed; // the keywords we were indexed under
+  LIST       *prefixes; // the prefixes we are listed under
+  unsigned long  order; // when we entered the game. Later is earlier in lists
+} KEYWORD_ENTRY;
+
+//
+// what we know about one large container
+typedef struct {
+  unsigned long list_stamp; // the container's stamp when we last looked
+  HASHTABLE       *buckets; // prefix : list. NULL until our second look
+} CONTAINER_INDEX;
+
+// everything in the world's index, and where we have put it
+MAP          *keyword_entries = NULL;
+unsigned long   keyword_order = 0;
+
+// the world's indexes themselves
+HASHTABLE        *world_chars = NULL; // prefix : list of mobiles in the game
+HASHTABLE         *world_objs = NULL; // prefix : list of objects in the game
+
+// the containers we are indexing, and the order we started indexing them in
+MAP        *container_indexes = NULL;
+LIST         *container_order = NULL;
+
+// what we return when an index says nothing could be called a name
+LIST           *no_candidates = NULL;
+
+KEYWORD_ENTRY *newKeywordEntry(void) {
+  KEYWORD_ENTRY *entry = malloc(sizeof(KEYWORD_ENTRY));
+  entry->indexed  = strdup("");
+  entry->prefixes = newList();
+  entry->order    = ++keyword_order;
+  return entry;
+}
+
+void deleteKeywordEntry(KEYWORD_ENTRY *entry) {
+  deleteListWith(entry->prefixes, free);
+  free(entry->indexed);
+  free(entry);
+}
+
+void deleteKeywordBuckets(HASHTABLE *buckets) {
+  deleteHashtableWith(buckets, deleteList);
+}
+
+CONTAINER_INDEX *newContainerIndex(void) {
+  CONTAINER_INDEX *index = malloc(sizeof(CONTAINER_INDEX));
+  index->list_stamp = 0;
+  index->buckets    = NULL;
+  return index;
+}
+
+void deleteContainerIndex(CONTAINER_INDEX *index) {
+  if(index->buckets != NULL)
+    deleteKeywordBuckets(index->buckets);
+  free(index);
+}
+
+//
+// returns the text a character's names are checked against
+const char *char_keyword_text(CHAR_DATA *ch) {
+  return (charIsNPC(ch) ? charGetKeywords(ch) : charGetName(ch));
+}
+
+//
+// add the first few letters of each keyword in text (or, if whole is TRUE, of
+// the text itself) to a list of prefixes, once each. Keywords start at the
+// same places is_keyword starts comparing at, and a keyword's prefix runs past
+// its end, just like is_keyword's comparisons do
+void keyword_prefixes(const char *text, bool whole, LIST *prefixes) {
+  while(*text != '\0') {
+    if(!whole)
+      while(isspace(*text) || *text == ',')
+	text++;
+
+    char prefix[KEYWORD_PREFIX_LEN + 1];
+    int i;
+    for(i = 0; i < KEYWORD_PREFIX_LEN && text[i] != '\0'; i++)
+      prefix[i] = tolower(text[i]);
+    prefix[i] = '\0';
+    if(i == KEYWORD_PREFIX_LEN && !listGetWith(prefixes, prefix, strcmp))
+      listQueue(prefixes, strdup(prefix));
+
+    if(whole)
+      break;
+    while(*text != '\0' && *text != ',')
+      text++;
+  }
+}
+
+//
+// orders things in the world's buckets the same way they are in mobile_list
+// and object_list; the last to enter the game comes first
+int keyword_order_cmp(const void *thing1, const void *thing2) {
+  KEYWORD_ENTRY *entry1 = mapGet(keyword_entries, thing1);
+  KEYWORD_ENTRY *entry2 = mapGet(keyword_entries, thing2);
+  return (entry1->order > entry2->order ? -1 : entry1->order < entry2->order);
+}
+
+//
+// puts the thing in the bucket for each of its prefixes. If ordered, it goes
+// where keyword_order_cmp says it belongs. Otherwise, it goes at the end
+void keyword_bucket_up(HASHTABLE *buckets, void *thing, LIST *prefixes,
+		       bool ordered) {
+  LIST_ITERATOR *prefix_i = newListIterator(prefixes);
+  char            *prefix = NULL;
+  ITERATE_LIST(prefix, prefix_i) {
+    LIST *bucket = hashGet(buckets, prefix);
+    if(bucket == NULL) {
+      bucket = newList();
+      hashPut(buckets, prefix, bucket);
+    }
+    if(ordered)
+      listPutWith(bucket, thing, keyword_order_cmp);
+    else
+      listQueue(bucket, thing);
+  } deleteListIterator(prefix_i);
+}
+
+//
+// take the thing out of all of the world's buckets it is in. Empty buckets
+// are kept, since someone might be in the middle of searching through them
+void keyword_unlist(HASHTABLE *world, void *thing, KEYWORD_ENTRY *entry) {
+  char *prefix = NULL;
+  while((prefix = listPop(entry->prefixes)) != NULL) {
+    LIST *bucket = hashGet(world, prefix);
+    if(bucket != NULL)
+      listRemove(bucket, thing);
+    free(prefix);
+  }
+}
+
+//
+// something in a container has had its keywords changed. If we are indexing
+// the container, forget what we knew about it
+void keyword_container_changed(LIST *container) {
+  CONTAINER_INDEX *index = NULL;
+  if(container != NULL &&
+     (index = mapGet(container_indexes, container)) != NULL) {
+    if(index->buckets != NULL)
+      deleteKeywordBuckets(index->buckets);
+    index->buckets    = NULL;
+    index->list_stamp = 0;
+  }
+}
+
+//
+// bring the thing's place in the world's index up to date. Container is the
+// list the thing is in, if any
+void keyword_index_thing(HASHTABLE *world, void *thing, bool in_game,
+			 LIST *container, const char *text, bool whole) {
+  // things are made and named well before the game starts up
+  if(keyword_entries == NULL)
+    return;
+
+  KEYWORD_ENTRY *entry = mapGet(keyword_entries, thing);
+
+  // leaving the game
+  if(!in_game) {
+    if(entry != NULL) {
+      keyword_unlist(world, thing, entry);
+      mapRemove(keyword_entries, thing);
+      deleteKeywordEntry(entry);
+    }
+    // something outside of the game has been renamed, and might be in a
+    // container someone will search
+    else
+      keyword_container_changed(container);
+    return;
+  }
+
+  // entering the game
+  if(entry == NULL) {
+    entry = newKeywordEntry();
+    mapPut(keyword_entries, thing, entry);
+  }
+  // renamed while in the game
+  else if(strcmp(entry->indexed, text)) {
+    keyword_unlist(world, thing, entry);
+    keyword_container_changed(container);
+  }
+  else
+    return;
+
+  free(entry->indexed);
+  entry->indexed = strdup(text);
+  keyword_prefixes(text, whole, entry->prefixes);
+  keyword_bucket_up(world, thing, entry->prefixes, TRUE);
+}
+
+//
+// returns the index for a container of characters (or objects), if we have
+// looked at it before and it has not changed since. Containers are only
+// indexed the second time they are looked at, so those that change between
+// every search are not indexed for nothing
+HASHTABLE *container_buckets(LIST *list, bool chars) {
+  if(listSize(list) < KEYWORD_CONTAINER_MIN)
+    return NULL;
+
+  CONTAINER_INDEX *index = mapGet(container_indexes, list);
+  if(index == NULL) {
+    index = newContainerIndex();
+    mapPut(container_indexes, list, index);
+    listQueue(container_order, list);
+    if(listSize(container_order) > KEYWORD_CONTAINERS_MAX)
+      deleteContainerIndex(mapRemove(container_indexes,
+				     listPop(container_order)));
+  }
+  else if(index->list_stamp == listGetStamp(list)) {
+    if(index->buckets == NULL) {
+      index->buckets = newHashtable();
+      LIST      *prefixes = newList();
+      LIST_ITERATOR *th_i = newListIterator(list);
+      void         *thing = NULL;
+      char        *prefix = NULL;
+      ITERATE_LIST(thing, th_i) {
+	if(chars)
+	  keyword_prefixes(char_keyword_text(thing), !charIsNPC(thing),
+			   prefixes);
+	else
+	  keyword_prefixes(objGetKeywords(thing), FALSE, prefixes);
+	keyword_bucket_up(index->buckets, thing, prefixes, FALSE);
+	while((prefix = listPop(prefixes)) != NULL)
+	  free(prefix);
+      } deleteListIterator(th_i);
+      deleteList(prefixes);
+    }
+    return index->buckets;
+  }
+  // it has changed since we last looked; forget what we knew
+  else if(index->buckets != NULL) {
+    deleteKeywordBuckets(index->buckets);
+    index->buckets = NULL;
+  }
+
+  index->list_stamp = listGetStamp(list);
+  return NULL;
+}
+
+//
+// the work behind keyword_narrow_chars and keyword_narrow_objs
+LIST *keyword_narrow(LIST *list, const char *name, const char *prototype,
+		     bool chars) {
+  // we also need to find things that are not called name
+  if(keyword_entries == NULL || name == NULL || (prototype && *prototype) ||
+     strlen(name) < KEYWORD_PREFIX_LEN)
+    return list;
+
+  HASHTABLE *buckets = NULL;
+  if(list == mobile_list)
+    buckets = world_chars;
+  else if(list == object_list)
+    buckets = world_objs;
+  else
+    buckets = container_buckets(list, chars);
+  if(buckets == NULL)
+    return list;
+
+  char prefix[KEYWORD_PREFIX_LEN + 1];
+  strncpy(prefix, name, KEYWORD_PREFIX_LEN);
+  prefix[KEYWORD_PREFIX_LEN] = '\0';
+  LIST *bucket = hashGet(buckets, prefix);
+  return (bucket != NULL ? bucket : no_candidates);
+}
+
+
+
+//*****************************************************************************
+// implementation of keyword_index.h
+//*****************************************************************************
+void init_keyword_index(void) {
+  keyword_entries   = newMap(NULL, NULL);
+  world_chars       = newHashtable();
+  world_objs        = newHashtable();
+  container_indexes = newMap(NULL, NULL);
+  container_order   = newList();
+  no_candidates     = newList();
+}
+
+void keyword_index_char(CHAR_DATA *ch) {
+  LIST *container = NULL;
+  if(charGetRoom(ch) != NULL)
+    container = roomGetCharacters(charGetRoom(ch));
+  keyword_index_thing(world_chars, ch, setIn(mobile_set, ch), container,
+		      char_keyword_text(ch), !charIsNPC(ch));
+}
+
+void keyword_index_obj(OBJ_DATA *obj) {
+  LIST *container = NULL;
+  if(objGetRoom(obj) != NULL)
+    container = roomGetContents(objGetRoom(obj));
+  else if(objGetCarrier(obj) != NULL)
+    container = charGetInventory(objGetCarrier(obj));
+  else if(objGetContainer(obj) != NULL)
+    container = objGetContents(objGetContainer(obj));
+  keyword_index_thing(world_objs, obj, setIn(object_set, obj), container,
+		      objGetKeywords(obj), FALSE);
+}
+
+LIST *keyword_narrow_chars(LIST *list,const char *name,const char *prototype){
+  return keyword_narrow(list, name, prototype, TRUE);
+}
+
+LIST *keyword_narrow_objs(LIST *list, const char *name,const char *prototype){
+  return keyword_narrow(list, name, prototype, FALSE);
+}
@@ -0,0 +1,40 @@
+#ifndef KEYWORD_INDEX_H
+#define KEYWORD_INDEX_H
+//*****************************************************************************
+//
+// keyword_index.h
+//
+// Lets searches by name (find_char, find_obj, count_chars, and the like) look
+// at only the few things that might be called what we are looking for, instead
+// of every thing in a list. Everything in the game is kept indexed by the first
+// few letters of each of its keywords (or, for players, of their name). Large
+// containers - crowded rooms, big inventories, full chests - are indexed the
+// second time they are searched without having changed since the first.
+//
+// The world's index is kept current by calling keyword_index_char and
+// keyword_index_obj when a mobile or object enters or leaves the game, and
+// when its keywords (or a player's name) are changed.
+//
+//*****************************************************************************
+
+//
+// prepare the keyword indexes for use
+void init_keyword_index(void);
+
+//
+// look at the mobile or object again, and put it in (or take it out of) the
+// world's index under its current keywords
+void keyword_index_char(CHAR_DATA *ch);
+void keyword_index_obj (OBJ_DATA  *obj);
+
+//
+// returns the things in a list of characters (or objects) that might be
+// called name, in the same order they appear in the list. If the list is not
+// indexed, or the search cannot use an index (e.g. the name is too short, or
+// we are also looking for instances of a prototype), the list itself is
+// returned. Either way, what is returned must not be changed or deleted, and
+// each thing must still be checked with charIsName or objIsName
+LIST *keyword_narrow_chars(LIST *list, const char *name,const char *prototype);
+LIST *keyword_narrow_objs (LIST *list, const char *name,const char *prototype);
+
+#endif // KEYWORD_INDEX_H
@@ -11,6 +11,9 @@
 // the list until the iterator count goes down to 0; until then, the items are
 // flagged as removed so they are not touched.
 //
+// Every list is also stamped each time its contents or their order change, so
+// things that remember something about a list can tell if it is out of date.
+//
 //*****************************************************************************
 
 #include <stdlib.h>
@@ -40,8 +43,19 @@ struct list {
   int size;                // how many elements are in the list?
   int iterators;           // how many iterators are going over us?
   char remove_pending;     // do we have to do a remove when the iterators die?
+  unsigned long stamp;     // changed every time our contents are changed
 };
 
+// the last stamp given to a list. Stamps are never reused, so a new list that
+// takes the place of a deleted one will never be mistaken for it. Worker
+// threads use lists of their own, so stamps are handed out atomically
+unsigned long last_list_stamp = 0;
+
+//
+// mark that the list's contents have changed
+#define LIST_CHANGED(L) \
+  ((L)->stamp = __sync_add_and_fetch(&last_list_stamp, 1))
+
 
 //
 // Delete a list node, and all nodes attached to it
@@ -134,6 +148,7 @@ LIST *newList() {
   L->size           = 0;
   L->iterators      = 0;
   L->remove_pending = FALSE;
+  LIST_CHANGED(L);
   return L;
 };
 
@@ -158,6 +173,7 @@ void listPut(LIST *L, void *elem) {
   L->size++;
   if(L->tail == NULL)
     L->tail = N;
+  LIST_CHANGED(L);
 };
 
 
@@ -176,6 +192,7 @@ void listQueue(LIST *L, void *elem) {
     L->tail       = N;
   }
   L->size++;
+  LIST_CHANGED(L);
 }
 
 
@@ -215,6 +232,7 @@ int listRemove(LIST *L, const void *elem) {
     if(L->iterators > 0) {
       N->removed = TRUE;
       L->size--;
+      LIST_CHANGED(L);
       L->remove_pending = TRUE;
       return TRUE;
     }
@@ -223,6 +241,7 @@ int listRemove(LIST *L, const void *elem) {
       N->next = NULL;
       deleteListNode(N);
       L->size--;
+      LIST_CHANGED(L);
       if(L->size == 0)
 	L->tail = NULL;
       return TRUE;
@@ -238,6 +257,7 @@ int listRemove(LIST *L, const void *elem) {
 	  N->next->removed = TRUE;
 	  L->remove_pending = TRUE;
 	  L->size--;
+	  LIST_CHANGED(L);
 	  return TRUE;
 	}
 	else {
@@ -248,6 +268,7 @@ int listRemove(LIST *L, const void *elem) {
 	  tmp->next = NULL;
 	  deleteListNode(tmp);
 	  L->size--;
+	  LIST_CHANGED(L);
 	  return TRUE;
 	}
       }
@@ -268,6 +289,10 @@ int listSize(LIST *L) {
   return L->size;
 }
 
+unsigned long listGetStamp(LIST *L) {
+  return L->stamp;
+}
+
 void *listGet(LIST *L, unsigned int num) {
   LIST_NODE *node = L->head;
   unsigned int i;
@@ -325,6 +350,7 @@ void *listRemoveWith(LIST *L, const void *cmpto, void *func) {
       N->removed = TRUE;
       L->remove_pending = TRUE;
       L->size--;
+      LIST_CHANGED(L);
       return N->elem;
     }
     else {
@@ -333,6 +359,7 @@ void *listRemoveWith(LIST *L, const void *cmpto, void *func) {
       N->next = NULL;
       deleteListNode(N);
       L->size--;
+      LIST_CHANGED(L);
       if(L->size == 0)
 	L->tail = NULL;
       return elem;
@@ -349,6 +376,7 @@ void *listRemoveWith(LIST *L, const void *cmpto, void *func) {
 	  N->next->removed = TRUE;
 	  L->remove_pending = TRUE;
 	  L->size--;
+	  LIST_CHANGED(L);
 	  return N->next->elem;
 	}
 	else {
@@ -360,6 +388,7 @@ void *listRemoveWith(LIST *L, const void *cmpto, void *func) {
 	  tmp->next = NULL;
 	  deleteListNode(tmp);
 	  L->size--;
+	  LIST_CHANGED(L);
 	  return elem;
 	}
       }
@@ -392,6 +421,7 @@ void listPutWith(LIST *L, void *elem, void *func) {
 	  new_node->next = N->next;
 	  N->next = new_node;
 	  L->size++;
+	  LIST_CHANGED(L);
 	  return;
 	}
       }
@@ -401,6 +431,7 @@ void listPutWith(LIST *L, void *elem, void *func) {
     N->next = newListNode(elem);
     L->tail = N->next;
     L->size++;
+    LIST_CHANGED(L);
   }
 }
 
@@ -419,6 +450,7 @@ void listSortWith(LIST *L, void *func) {
   L->head = new_list->head;
   L->tail = new_list->tail;
   L->size = new_list->size;
+  LIST_CHANGED(L);
   // FREE ... not delete. Delete would kill the things
   // we just transferred over to the old list
   free(new_list);
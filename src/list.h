@@ -85,6 +85,12 @@ void listPush(LIST *L, void *elem);
 //
 int listSize(LIST *L);
 
+//
+// returns the list's stamp, which changes every time an element is added to
+// or removed from the list, or the list is sorted
+//
+unsigned long listGetStamp(LIST *L);
+
 //
 // Is the list empty?
 //
@@ -29,6 +29,116 @@ HASHTABLE *logkeys = NULL;
 
 
 
+//*****************************************************************************
+// local datastructures
+//*****************************************************************************
+
+//
+// The keywords we log on for a file, plus a compiled matcher for them. Output
+// is checked for every keyword at once by running it through a state machine
+// (Aho-Corasick) built from the keywords, instead of parsing the keyword list
+// and calling strstr for each keyword, on every single line of output
+typedef struct {
+  char       *keywords; // the keywords, as they were supplied
+  bool            all; // do we log everything?
+  int    (*next)[256]; // state transitions for every byte
+  bool         *match; // does reaching this state mean we found a keyword?
+} LOG_KEYS;
+
+//
+// build the state machine that finds any of the keywords in a string
+void logKeysCompile(LOG_KEYS *data) {
+  LIST           *keys = parse_keywords(data->keywords);
+  LIST_ITERATOR *key_i = newListIterator(keys);
+  char            *key = NULL;
+  int         c, state = 0, states = 1, max_states = 1;
+
+  // we'll never need more states than there are characters in our keywords
+  ITERATE_LIST(key, key_i) {
+    max_states += strlen(key);
+  } listIteratorReset(key_i);
+
+  int *fail     = calloc(max_states, sizeof(int));
+  int *queue    = calloc(max_states, sizeof(int));
+  int qhead = 0, qtail = 0;
+  data->next    = malloc(sizeof(int[256]) * max_states);
+  data->match   = calloc(max_states, sizeof(bool));
+  memset(data->next, -1, sizeof(int[256]) * max_states);
+
+  // build a trie of our keywords
+  ITERATE_LIST(key, key_i) {
+    const unsigned char *ptr = (const unsigned char *)key;
+    if(!*ptr)
+      continue;
+    for(state = 0; *ptr; ptr++) {
+      if(data->next[state][*ptr] == -1)
+	data->next[state][*ptr] = states++;
+      state = data->next[state][*ptr];
+    }
+    data->match[state] = TRUE;
+  } deleteListIterator(key_i);
+  deleteListWith(keys, free);
+
+  // fill in the failure transitions, breadth-first
+  for(c = 0; c < 256; c++) {
+    if(data->next[0][c] == -1)
+      data->next[0][c] = 0;
+    else
+      queue[qtail++] = data->next[0][c];
+  }
+  while(qhead < qtail) {
+    state = queue[qhead++];
+    for(c = 0; c < 256; c++) {
+      int child = data->next[state][c];
+      if(child == -1)
+	data->next[state][c] = data->next[fail[state]][c];
+      else {
+	fail[child] = data->next[fail[state]][c];
+	data->match[child] |= data->match[fail[child]];
+	queue[qtail++] = child;
+      }
+    }
+  }
+
+  free(fail);
+  free(queue);
+}
+
+LOG_KEYS *newLogKeys(const char *keywords) {
+  LOG_KEYS *data = calloc(1, sizeof(LOG_KEYS));
+  data->keywords = strdupsafe(keywords);
+  data->all      = is_keyword(keywords, "all", FALSE);
+  if(!data->all)
+    logKeysCompile(data);
+  return data;
+}
+
+void deleteLogKeys(LOG_KEYS *data) {
+  if(data->keywords) free(data->keywords);
+  if(data->next)     free(data->next);
+  if(data->match)    free(data->match);
+  free(data);
+}
+
+//
+// returns TRUE if the string contains any of our keywords
+bool logKeysMatch(LOG_KEYS *data, const char *string) {
+  if(data->all)
+    return TRUE;
+  else {
+    const unsigned char *ptr = (const unsigned char *)string;
+    int state = 0;
+    for(; *ptr; ptr++) {
+      state = data->next[state][*ptr];
+      if(data->match[state])
+	return TRUE;
+    }
+    return FALSE;
+  }
+}
+
+
+
 //
 // Begin logging the appearance of specific keywords when they come up
 // on a certain character's output. Supplying no keywords turns off logging
@@ -68,13 +178,13 @@ void save_logkeys() {
   STORAGE_SET_LIST *log_list = new_storage_list();
   HASH_ITERATOR      *hash_i = newHashIterator(logkeys);
   const char *log   = NULL;
-  const char *words = NULL;
+  LOG_KEYS *words   = NULL;
 
   store_list(set, "logs", log_list);
   ITERATE_HASH(log, words, hash_i) {
     STORAGE_SET *one_log = new_storage_set();
     store_string(one_log, "log",      log);
-    store_string(one_log, "keywords", words);
+    store_string(one_log, "keywords", words->keywords);
     storage_list_put(log_list, one_log);
   }
   deleteHashIterator(hash_i);
@@ -93,8 +203,8 @@ void init_logs() {
     STORAGE_SET_LIST *list = read_list(set, "logs");
     STORAGE_SET *one_log = NULL;
     while( (one_log = storage_list_next(list)) != NULL)
-      hashPut(logkeys, strdup(read_string(one_log, "log")),
-	               strdup(read_string(one_log, "keywords")));
+      hashPut(logkeys, read_string(one_log, "log"),
+	      newLogKeys(read_string(one_log, "keywords")));
     storage_close(set);
   }
 
@@ -104,15 +214,16 @@ void init_logs() {
 
 void log_keywords(const char *file, const char *keywords) {
   // remove the old keywords
-  char *keys = hashRemove(logkeys, file);
-  if(keys) free(keys);
+  LOG_KEYS *old = hashRemove(logkeys, file);
+  if(old) deleteLogKeys(old);
 
-  keys = strdupsafe(keywords);
+  char *keys = strdupsafe(keywords);
   trim(keys);
 
   // put the new keywords in
   if(*keys)
-    hashPut(logkeys, file, keys);
+    hashPut(logkeys, file, newLogKeys(keys));
+  free(keys);
 
   // save the changes
   save_logkeys();
@@ -120,43 +231,10 @@ void log_keywords(const char *file, const char *keywords) {
 
 
 void try_log(const char *file, const char *string) {
-  char *keywords = hashGet(logkeys, file);
-  // didn't find anything
-  if(!keywords || !*keywords)
-    return;
-  else {
-    bool found = FALSE;
-
-    if(is_keyword(keywords, "all", FALSE))
-      found = TRUE;
-    // for each key, see if it exists in the string
-    else {
-      LIST           *keys = parse_keywords(keywords);
-      LIST_ITERATOR *key_i = newListIterator(keys);
-      char            *key = NULL;
-
-      ITERATE_LIST(key, key_i) {
-	// found one
-	if(strstr(string, key)) {
-	  found = TRUE;
-	  break;
-	}
-      } deleteListIterator(key_i);
-      deleteListWith(keys, free);
-    }
-
-    if(found) {
-      char fname[MAX_BUFFER];
-      FILE *fl = NULL;
-      sprintf(fname, "%s/%s", LOG_DIR, file);
-      
-      // couldn't open the file for appending
-      if((fl = fopen(fname, "a+")) == NULL)
-	return;
-      
-      // write the string and close the file
-      fprintf(fl, "%s: %s", get_time(), string);
-      fclose(fl);
-    }
+  LOG_KEYS *keys = hashGet(logkeys, file);
+  if(keys != NULL && logKeysMatch(keys, string)) {
+    char fname[MAX_BUFFER];
+    sprintf(fname, "%s/%s", LOG_DIR, file);
+    append_to_file(fname, "%s: %s", get_time(), string);
   }
 }
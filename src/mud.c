@@ -37,6 +37,11 @@ int top_uid(void) {
   return next_available_uid - 1;
 }
 
+void reserve_uids(int top) {
+  if(next_available_uid <= top)
+    next_available_uid = top + 1;
+}
+
 
 
 //*****************************************************************************
@@ -50,6 +55,12 @@ void init_mud_settings() {
     mudsettingSetString("start_room", DFLT_START_ROOM);
   if(mudsettingGetInt("pulses_per_second") == 0)
     mudsettingSetInt("pulses_per_second", DFLT_PULSES_PER_SECOND);
+  if(!*mudsettingGetString("script_time_limit"))
+    mudsettingSetInt("script_time_limit", DFLT_SCRIPT_TIME_LIMIT);
+  if(!*mudsettingGetString("reset_budget"))
+    mudsettingSetInt("reset_budget", DFLT_RESET_BUDGET);
+  if(mudsettingGetInt("worker_threads") == 0)
+    mudsettingSetInt("worker_threads", DFLT_WORKER_THREADS);
 }
 
 void mudsettingSetString(const char *key, const char *val) {
@@ -104,6 +104,9 @@ typedef unsigned char                     bool;
 
 /* A few globals */
 #define DFLT_PULSES_PER_SECOND 10
+#define DFLT_SCRIPT_TIME_LIMIT 250  // in milliseconds
+#define DFLT_RESET_BUDGET     2000  // in microseconds, per pulse
+#define DFLT_WORKER_THREADS      2
 #define PULSES_PER_SECOND   mudsettingGetInt("pulses_per_second")
 #define SECOND              * PULSES_PER_SECOND   /* used for figuring out how many pulses in a second*/
 #define SECONDS             SECOND                /* same as above */
@@ -195,6 +198,11 @@ bool        mudsettingGetBool  (const char *key);
 int next_uid(void);
 int  top_uid(void);
 
+//
+// make sure no UID at or below top will be handed out by next_uid(). Used
+// when entities are restored with the UIDs they had before a copyover
+void reserve_uids(int top);
+
 
 
 //*****************************************************************************
@@ -260,6 +268,8 @@ void  do_cmd                  ( CHAR_DATA *ch, char *arg, bool aliases_ok);
 void    log_string            ( const char *txt, ... ) __attribute__ ((format (printf, 1, 2)));
 void    bug                   ( const char *txt, ... ) __attribute__ ((format (printf, 1, 2)));
 BUFFER *read_file             ( const char *file );
+void    append_to_file        ( const char *file, const char *fmt, ... ) __attribute__ ((format (printf, 2, 3)));
+void    flush_appends         ( void );
 
 /* strings.c */
 const char *one_arg_safe      ( const char *fStr, char *bStr );
@@ -18,6 +18,8 @@
 #include "storage.h"
 #include "auxiliary.h"
 #include "object.h"
+#include "keyword_index.h"
+#include "visibility.h"
 
 struct object_data {
   int      uid;                  // our unique identifier
@@ -311,6 +313,7 @@ void *objGetAuxiliaryData(const OBJ_DATA *obj, const char *name) {
 void objSetKeywords(OBJ_DATA *obj, const char *keywords) {
   if(obj->keywords) free(obj->keywords);
   obj->keywords = strdupsafe(keywords);
+  keyword_index_obj(obj);
 }
 
 void objSetRdesc(OBJ_DATA *obj, const char *rdesc) {
@@ -377,6 +380,15 @@ void objSetWeightRaw(OBJ_DATA *obj, double weight) {
   obj->weight = weight;
 }
 
+void objSetUID(OBJ_DATA *obj, int uid) {
+  obj->uid = uid;
+}
+
+void objSetBirth(OBJ_DATA *obj, time_t birth) {
+  obj->birth = birth;
+}
+
 void objSetHidden(OBJ_DATA *obj, int amnt) {
   obj->hidden = amnt;
+  visibility_changed(obj);
 }
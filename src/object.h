@@ -75,5 +75,7 @@ void         objSetContainer (OBJ_DATA *obj, OBJ_DATA  *cont);
 void         objSetRoom      (OBJ_DATA *obj, ROOM_DATA *room);
 void         objSetWeightRaw (OBJ_DATA *obj, double weight);
 void         objSetHidden    (OBJ_DATA *obj, int amnt);
+void         objSetUID       (OBJ_DATA *obj, int uid);
+void         objSetBirth     (OBJ_DATA *obj, time_t birth);
 
 #endif // __OBJECT_H
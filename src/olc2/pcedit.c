@@ -13,6 +13,7 @@
 #include "../races.h"
 #include "../handler.h"
 #include "../save.h"
+#include "../broadcast.h"
 
 #include "olc.h"
 
@@ -125,6 +126,7 @@ bool pcedit_parser(SOCKET_DATA *sock, CHAR_DATA *mob, int choice,
   case PCEDIT_USER_GROUPS:
     bitClear(charGetUserGroups(mob));
     bitToggle(charGetUserGroups(mob), arg);
+    broadcast_update(mob);
     return TRUE;
   case PCEDIT_RACE:
     if(!isRace(arg))
@@ -105,6 +105,28 @@ void deleteParseToken(PARSE_TOKEN *arg) {
 
 
 
+//
+// a syntax string, compiled down into the tokens it is made of. Syntaxes are
+// compiled the first time they are used and kept around after that, so each
+// use of a command only has to match its arguments against the tokens
+typedef struct parse_syntax {
+  char               *syntax; // the string we were compiled from
+  LIST               *tokens; // the tokens it was broken down into
+  int                py_args; // how many values Py_parse_args returns for us
+  bool             temporary; // is this not cached, and deleted after use?
+  struct parse_syntax  *next; // another syntax, differing from us only by case
+} PARSE_SYNTAX;
+
+// all of the syntaxes we have compiled, keyed by their syntax string. Hash
+// keys are case insensitive, so syntaxes that differ only in case are chained
+HASHTABLE *parse_syntax_table = NULL;
+
+// syntaxes are almost always constant strings, so the table should never get
+// this big. If it does, someone is building syntaxes on the fly and we stop
+// caching new ones
+#define MAX_PARSE_SYNTAXES  2000
+
+
 //
 // data for one parsed variable
 typedef struct {
@@ -497,6 +519,85 @@ LIST *decompose_parse_format(const char *format) {
   return token_list;
 }
 
+
+//
+// counts how many values Py_parse_args returns for the list of tokens
+int parse_expected_py_args(LIST *tokens) {
+  LIST_ITERATOR *token_i = newListIterator(tokens);
+  PARSE_TOKEN     *token = NULL;
+  int              count = 0;
+
+  ITERATE_LIST(token, token_i) {
+    if(token->type == PARSE_TOKEN_FLAVOR || token->type == PARSE_TOKEN_OPTIONAL)
+      continue;
+
+    // one for a returnable type
+    count++;
+
+    // one to denote what kind in an ambiguous case
+    if(token->type == PARSE_TOKEN_MULTI)
+      count++;
+
+    // one to denote if we had multiples
+    if(token->all_ok)
+      count++;
+  } deleteListIterator(token_i);
+
+  return count;
+}
+
+
+//
+// compile a syntax string. Returns NULL if the syntax is malformed
+PARSE_SYNTAX *newParseSyntax(const char *syntax) {
+  LIST *tokens = decompose_parse_format(syntax);
+  if(tokens == NULL)
+    return NULL;
+
+  PARSE_SYNTAX *compiled = calloc(1, sizeof(PARSE_SYNTAX));
+  compiled->syntax       = strdup(syntax);
+  compiled->tokens       = tokens;
+  compiled->py_args      = parse_expected_py_args(tokens);
+  return compiled;
+}
+
+void deleteParseSyntax(PARSE_SYNTAX *compiled) {
+  deleteListWith(compiled->tokens, deleteParseToken);
+  free(compiled->syntax);
+  free(compiled);
+}
+
+
+//
+// returns the compiled form of the syntax string, compiling it if it has not
+// been used before. Returns NULL if the syntax is malformed. If the returned
+// syntax is temporary, it must be deleted after use
+PARSE_SYNTAX *get_parse_syntax(const char *syntax) {
+  if(parse_syntax_table == NULL)
+    parse_syntax_table = newHashtable();
+
+  // have we already compiled it?
+  PARSE_SYNTAX *first = hashGet(parse_syntax_table, syntax);
+  PARSE_SYNTAX *found = first;
+  while(found != NULL && strcmp(found->syntax, syntax) != 0)
+    found = found->next;
+  if(found != NULL)
+    return found;
+
+  // compile it, and keep it around if we have room
+  if((found = newParseSyntax(syntax)) == NULL)
+    return NULL;
+  else if(hashSize(parse_syntax_table) >= MAX_PARSE_SYNTAXES)
+    found->temporary = TRUE;
+  else if(first != NULL) {
+    found->next = first->next;
+    first->next = found;
+  }
+  else
+    hashPut(parse_syntax_table, syntax, found);
+  return found;
+}
+
 //
 // turns a string into a boolean
 bool string_to_bool(const char *string) {
@@ -1228,73 +1329,54 @@ PyObject *parse_create_py_vars(LIST *variables) {
 //*****************************************************************************
 // implementation of parse.h
 //*****************************************************************************
-int parse_expected_py_args(const char *syntax) {
-  LIST *tokens = NULL;
-  if((tokens = decompose_parse_format(syntax)) == NULL)
-    return -1;
-  int count = 0;
-  LIST_ITERATOR *token_i = newListIterator(tokens);
-  PARSE_TOKEN     *token = NULL;
-  ITERATE_LIST(token, token_i) {
-    if(token->type == PARSE_TOKEN_FLAVOR || token->type == PARSE_TOKEN_OPTIONAL)
-      continue;
-
-    // one for a returnable type
-    count++;
-
-    // one to denote what kind in an ambiguous case
-    if(token->type == PARSE_TOKEN_MULTI)
-      count++;
-
-    // one to denote if we had multiples
-    if(token->all_ok)
-      count++;
-  } deleteListIterator(token_i);
-  deleteListWith(tokens, deleteParseToken);
-
-  return count;
+bool parse_syntax_register(const char *syntax) {
+  PARSE_SYNTAX *compiled = get_parse_syntax(syntax);
+  if(compiled == NULL)
+    return FALSE;
+  if(compiled->temporary)
+    deleteParseSyntax(compiled);
+  return TRUE;
 }
 
 void *Py_parse_args(CHAR_DATA *looker, bool show_errors, const char *cmd, 
 		    char *args, const char *syntax) {
-  char err_buf[SMALL_BUFFER] = "";
-  bool       parse_ok = TRUE;
-  LIST        *tokens = NULL;
-  LIST     *variables = NULL;
-  PyObject      *list = NULL;
+  char  err_buf[SMALL_BUFFER] = "";
+  bool          parse_ok = TRUE;
+  PARSE_SYNTAX *compiled = NULL;
+  LIST        *variables = NULL;
+  PyObject         *list = NULL;
 
   // get our list of tokens
-  if((tokens = decompose_parse_format(syntax)) == NULL) {
+  if((compiled = get_parse_syntax(syntax)) == NULL) {
     log_string("Command '%s', format error in argument parsing: %s",cmd,syntax);
     parse_ok = FALSE;
   }
   // try to use our tokens to compose a variable list
-  else if((variables = compose_variable_list(looker, tokens, args, err_buf))
-	  == NULL)
+  else if((variables = compose_variable_list(looker, compiled->tokens, args,
+					     err_buf)) == NULL)
     parse_ok = FALSE;
   else {
     // go through all of our vars and make python forms for them
     list = parse_create_py_vars(variables);
 
     // fill up optional spots at the end we didn't parse args for
-    int expected = parse_expected_py_args(syntax);
-    while(PyList_Size(list) < expected)
+    while(PyList_Size(list) < compiled->py_args)
       PyList_Append(list, Py_None);
   }
 
   // did we encounter an error with the arguments and need to mssg someone?
-  if(tokens != NULL && !parse_ok && show_errors) {
+  if(compiled != NULL && !parse_ok && show_errors) {
     // do we have a specific error message?
     if(*err_buf)
       send_to_char(looker, "%s\r\n", err_buf);
     // assume a syntax error
     else
-      show_parse_syntax_error(looker, cmd, tokens);
+      show_parse_syntax_error(looker, cmd, compiled->tokens);
   }
 
   // clean up our mess
-  if(tokens != NULL)
-    deleteListWith(tokens, deleteParseToken);
+  if(compiled != NULL && compiled->temporary)
+    deleteParseSyntax(compiled);
   if(variables != NULL)
     deleteListWith(variables, deleteParseVar);
 
@@ -1304,19 +1386,19 @@ void *Py_parse_args(CHAR_DATA *looker, bool show_errors, const char *cmd,
 
 bool parse_args(CHAR_DATA *looker, bool show_errors, const char *cmd,
 		char *args, const char *syntax, ...) {
-  char err_buf[SMALL_BUFFER] = "";
-  bool       parse_ok = TRUE;
-  LIST       *tokens  = NULL;
-  LIST     *variables = NULL;
+  char  err_buf[SMALL_BUFFER] = "";
+  bool          parse_ok = TRUE;
+  PARSE_SYNTAX *compiled = NULL;
+  LIST        *variables = NULL;
 
   // get our list of tokens
-  if((tokens = decompose_parse_format(syntax)) == NULL) {
+  if((compiled = get_parse_syntax(syntax)) == NULL) {
     log_string("Command '%s', format error in argument parsing: %s",cmd,syntax);
     parse_ok = FALSE;
   }
   // try to use our tokens to compose a variable list
-  else if((variables = compose_variable_list(looker, tokens, args, err_buf))
-	  == NULL)
+  else if((variables = compose_variable_list(looker, compiled->tokens, args,
+					     err_buf)) == NULL)
     parse_ok = FALSE;
   else {
     // go through all of our vars and assign them to the proper args
@@ -1327,18 +1409,18 @@ bool parse_args(CHAR_DATA *looker, bool show_errors, const char *cmd,
   }
 
   // did we encounter an error with the arguments and need to mssg someone?
-  if(tokens != NULL && !parse_ok && show_errors) {
+  if(compiled != NULL && !parse_ok && show_errors) {
     // do we have a specific error message?
     if(*err_buf)
       send_to_char(looker, "%s\r\n", err_buf);
     // assume a syntax error
     else
-      show_parse_syntax_error(looker, cmd, tokens);
+      show_parse_syntax_error(looker, cmd, compiled->tokens);
   }
 
   // clean up our mess
-  if(tokens != NULL)
-    deleteListWith(tokens, deleteParseToken);
+  if(compiled != NULL && compiled->temporary)
+    deleteParseSyntax(compiled);
   if(variables != NULL)
     deleteListWith(variables, deleteParseVar);
 
@@ -118,4 +118,11 @@ bool parse_args(CHAR_DATA *looker, bool show_errors, const char *cmd,
 void *Py_parse_args(CHAR_DATA *looker, bool show_errors, const char *cmd, 
 		    char *args, const char *syntax);
 
+//
+// Syntaxes are compiled the first time they are used, and the compiled form is
+// reused every time after that. A syntax can be compiled ahead of time, e.g.
+// when its command is added, so errors in it show up when the mud boots rather
+// than when someone first uses the command. Returns FALSE if it is malformed.
+bool parse_syntax_register(const char *syntax);
+
 #endif // PARSE_H
@@ -0,0 +1,423 @@
+//*****************************************************************************
+//
+// path.c
+//
+// Finds the shortest path between two rooms. Searches spread out from the
+// starting room, always continuing from the closest room that has not been
+// searched from yet (a breadth-first search when every step costs the same,
+// and Dijkstra's algorithm when steps are weighted). Since steps cost only a
+// few points each, rooms waiting to be searched from are kept in one bucket
+// per cost instead of a heap.
+//
+// Rooms are remembered by key rather than by pointer, so what we map out stays
+// good even if rooms are extracted and loaded back in later.
+//
+//*****************************************************************************
+
+#include "mud.h"
+#include "utils.h"
+#include "world.h"
+#include "room.h"
+#include "exit.h"
+#include "path.h"
+
+
+
+//*****************************************************************************
+// local datastructures, functions, and defines
+//*****************************************************************************
+
+// how much extra it costs to go through a closed door, on weighted paths
+#define PATH_DOOR_COST         3
+
+// the most one step can cost. Must be at least the highest terrain cost plus
+// the cost of a door
+#define PATH_MAX_STEP_COST    12
+
+// how many rooms we map out paths from before forgetting all of them. Every
+// room we map out from remembers something about each room in its zone
+#define MAX_PATH_TREES      1000
+
+// the different sets of flags that change how paths are found, and are
+// mapped out separately for each room
+#define NUM_PATH_MODES         4
+#define PATH_MODE(flags)      ((flags) & (PATH_IGNORE_DOORS | PATH_WEIGHTED))
+
+// how much it costs to step into each kind of terrain, on weighted paths
+const int terrain_cost[NUM_TERRAINS] = {
+  1, // inside
+  1, // city
+  1, // road
+  1, // alley
+  1, // bridge
+  3, // shallow water
+  5, // deep water
+  6, // ocean
+  8, // underwater
+  2, // field
+  2, // plains
+  2, // meadow
+  3, // forest
+  4, // deep forest
+  3, // hills
+  4, // high hills
+  6, // mountains
+  4, // swamp
+  6, // deep swamp
+  2, // sand
+  3, // desert
+  3, // ice
+  5, // glacier
+  2, // cavern
+};
+
+//
+// what we know about getting to one room from the room we searched from
+typedef struct {
+  char    *key; // the room's key
+  char   *prev; // the room we got here from. NULL if we are the start
+  char    *dir; // the direction taken from prev to get here
+  char  *first; // the first direction taken from the start to get here
+  int     cost; // how much it costs to get here
+  bool    done; // have we searched from here yet?
+} PATH_NODE;
+
+//
+// everything reachable from one room, keyed by room key
+typedef HASHTABLE PATH_TREE;
+
+//
+// what we have mapped out in a zone, for each set of pathing flags. Each is a
+// table of path trees, keyed by the room they start from
+typedef struct {
+  HASHTABLE *trees[NUM_PATH_MODES];
+} PATH_ZONE;
+
+// our mapped out zones, keyed by locale
+HASHTABLE *path_zones = NULL;
+
+// how many path trees we are holding on to
+int num_path_trees = 0;
+
+// searching can load rooms in, which sets their exits. That is not a change
+// to the world, so we ignore invalidations while searching, or while rooms are
+// being loaded
+int path_searching = 0;
+
+// a hash of the exits of each room that has been unloaded, by key
+HASHTABLE *path_unloaded_exits = NULL;
+
+PATH_NODE *newPathNode(const char *key, PATH_NODE *prev, const char *dir,
+		       int cost) {
+  PATH_NODE *node = calloc(1, sizeof(PATH_NODE));
+  node->key   = strdup(key);
+  node->cost  = cost;
+  if(prev != NULL) {
+    node->prev  = strdup(prev->key);
+    node->dir   = strdup(dir);
+    node->first = strdup(prev->first ? prev->first : dir);
+  }
+  return node;
+}
+
+void deletePathNode(PATH_NODE *node) {
+  if(node->prev)  free(node->prev);
+  if(node->dir)   free(node->dir);
+  if(node->first) free(node->first);
+  free(node->key);
+  free(node);
+}
+
+void deletePathTree(PATH_TREE *tree) {
+  deleteHashtableWith(tree, deletePathNode);
+}
+
+PATH_ZONE *newPathZone(void) {
+  PATH_ZONE *zone = calloc(1, sizeof(PATH_ZONE));
+  int mode;
+  for(mode = 0; mode < NUM_PATH_MODES; mode++)
+    zone->trees[mode] = newHashtable();
+  return zone;
+}
+
+void deletePathZone(PATH_ZONE *zone) {
+  int mode;
+  for(mode = 0; mode < NUM_PATH_MODES; mode++) {
+    num_path_trees -= hashSize(zone->trees[mode]);
+    deleteHashtableWith(zone->trees[mode], deletePathTree);
+  }
+  free(zone);
+}
+
+//
+// returns how much it costs to take the exit into dest. -1 if it can't be taken
+int path_step_cost(EXIT_DATA *exit, ROOM_DATA *dest, int flags) {
+  int cost = 1;
+  if(!IS_SET(flags, PATH_IGNORE_DOORS) && exitIsLocked(exit))
+    return -1;
+  if(IS_SET(flags, PATH_WEIGHTED)) {
+    if(roomGetTerrain(dest) >= 0 && roomGetTerrain(dest) < NUM_TERRAINS)
+      cost = terrain_cost[roomGetTerrain(dest)];
+    if(!IS_SET(flags, PATH_IGNORE_DOORS) && exitIsClosed(exit))
+      cost += PATH_DOOR_COST;
+  }
+  return cost;
+}
+
+//
+// returns a hash of the room's terrain, where its exits go, and which are
+// closed or locked
+unsigned long path_exits_hash(ROOM_DATA *room) {
+  unsigned long hash = roomGetTerrain(room);
+  const char    *dir = NULL;
+  EXIT_DATA    *exit = NULL;
+  int           ex_i = 0;
+  ITERATE_EXITS(dir, exit, room, ex_i) {
+    hash = hash * 31 + string_hash(dir);
+    hash = hash * 31 + string_hash(exitGetToFull(exit));
+    hash = hash * 4  + exitIsClosed(exit) * 2 + exitIsLocked(exit);
+  }
+  return hash;
+}
+
+//
+// map out paths from one room to every room reachable from it. If to is not
+// NULL, stop once we have found the way there. Rooms that are waiting to be
+// searched from are kept in buckets by their cost. Because no step costs more
+// than PATH_MAX_STEP_COST, we only ever need that many buckets at once
+PATH_TREE *path_search(ROOM_DATA *from, ROOM_DATA *to, int flags) {
+  PATH_TREE      *tree = newHashtable();
+  LIST *buckets[PATH_MAX_STEP_COST + 1];
+  const char   *zone = get_key_locale(roomGetClass(from));
+  const char *to_key = (to ? roomGetClass(to) : NULL);
+  PATH_NODE    *node = newPathNode(roomGetClass(from), NULL, NULL, 0);
+  int cost, waiting, i;
+
+  path_searching++;
+  for(i = 0; i <= PATH_MAX_STEP_COST; i++)
+    buckets[i] = newList();
+  hashPut(tree, node->key, node);
+  listQueue(buckets[0], node);
+  waiting = 1;
+
+  for(cost = 0; waiting > 0; cost++) {
+    LIST *bucket = buckets[cost % (PATH_MAX_STEP_COST + 1)];
+    while((node = listPop(bucket)) != NULL) {
+      waiting--;
+
+      // we might have been queued again after finding a cheaper way here
+      if(node->done || node->cost != cost)
+	continue;
+      node->done = TRUE;
+
+      // did we find where we were going?
+      if(to_key != NULL && !strcmp(node->key, to_key)) {
+	waiting = 0;
+	break;
+      }
+
+      ROOM_DATA *room = worldGetRoom(gameworld, node->key);
+      if(room == NULL)
+	continue;
+
+      // see where we can go from here
+      const char   *dir = NULL;
+      EXIT_DATA   *exit = NULL;
+      int          ex_i = 0;
+      ITERATE_EXITS(dir, exit, room, ex_i) {
+	ROOM_DATA  *droom = NULL;
+	char        dest[SMALL_BUFFER];
+	PATH_NODE  *next = NULL;
+	int         step = 0;
+
+	// loading the room in might reuse the buffer our destination is in
+	snprintf(dest, SMALL_BUFFER, "%s", exitGetToFull(exit));
+	next = hashGet(tree, dest);
+
+	// somewhere we've already searched from, or outside of our zone
+	if((next != NULL && next->done) ||
+	   (IS_SET(flags, PATH_STAY_ZONE) &&
+	    strcasecmp(get_key_locale(dest), zone)) ||
+	   (droom = worldGetRoom(gameworld, dest)) == NULL ||
+	   (step = path_step_cost(exit, droom, flags)) < 0)
+	  continue;
+	step = MIN(step, PATH_MAX_STEP_COST);
+
+	// a new room, or a cheaper way to get to one we already know of
+	if(next == NULL) {
+	  next = newPathNode(dest, node, dir, cost + step);
+	  hashPut(tree, next->key, next);
+	}
+	else if(cost + step < next->cost) {
+	  free(next->prev);  next->prev  = strdup(node->key);
+	  free(next->dir);   next->dir   = strdup(dir);
+	  free(next->first); next->first = strdup(node->first?node->first:dir);
+	  next->cost = cost + step;
+	}
+	else
+	  continue;
+	listQueue(buckets[next->cost % (PATH_MAX_STEP_COST + 1)], next);
+	waiting++;
+      }
+    }
+  }
+
+  for(i = 0; i <= PATH_MAX_STEP_COST; i++)
+    deleteList(buckets[i]);
+  path_searching--;
+  return tree;
+}
+
+//
+// returns a path tree that includes how to get from from to to. Paths that
+// stay in a zone are looked up in what we've mapped out for it, or mapped out
+// and kept. Other trees are temporary and must be deleted after use
+PATH_TREE *path_tree_get(ROOM_DATA *from, ROOM_DATA *to, int flags,
+			 bool *temporary) {
+  PATH_ZONE *zone = NULL;
+  PATH_TREE *tree = NULL;
+  const char *locale = get_key_locale(roomGetClass(from));
+
+  // we only keep paths that stay in one zone
+  *temporary = !IS_SET(flags, PATH_STAY_ZONE);
+  if(*temporary)
+    return path_search(from, to, flags);
+
+  if((zone = hashGet(path_zones, locale)) == NULL) {
+    zone = newPathZone();
+    hashPut(path_zones, locale, zone);
+  }
+  if((tree = hashGet(zone->trees[PATH_MODE(flags)], roomGetClass(from)))==NULL){
+    // we've been holding on to too much. Forget it all and start over
+    if(num_path_trees >= MAX_PATH_TREES) {
+      hashClearWith(path_zones, deletePathZone);
+      num_path_trees = 0;
+      zone = newPathZone();
+      hashPut(path_zones, locale, zone);
+    }
+    tree = path_search(from, NULL, flags);
+    hashPut(zone->trees[PATH_MODE(flags)], roomGetClass(from), tree);
+    num_path_trees++;
+  }
+  return tree;
+}
+
+//
+// returns the path from the tree's start to the room, backwards, as a list of
+// the path nodes. NULL if the room cannot be reached
+LIST *path_tree_walk(PATH_TREE *tree, ROOM_DATA *to) {
+  PATH_NODE *node = hashGet(tree, roomGetClass(to));
+  LIST      *path = NULL;
+  if(node == NULL || !node->done)
+    return NULL;
+  path = newList();
+  for(; node != NULL; node = (node->prev ? hashGet(tree, node->prev) : NULL))
+    listQueue(path, node);
+  return path;
+}
+
+
+
+//*****************************************************************************
+// implementation of path.h
+//*****************************************************************************
+void init_path(void) {
+  path_zones          = newHashtable();
+  path_unloaded_exits = newHashtable();
+}
+
+LIST *pathFindDirs(ROOM_DATA *from, ROOM_DATA *to, int flags) {
+  bool   temporary = FALSE;
+  PATH_TREE  *tree = path_tree_get(from, to, flags, &temporary);
+  LIST   *backward = path_tree_walk(tree, to);
+  LIST       *dirs = NULL;
+  PATH_NODE  *node = NULL;
+
+  if(backward != NULL) {
+    dirs = newList();
+    while((node = listPop(backward)) != NULL)
+      if(node->dir != NULL)
+	listPut(dirs, strdup(node->dir));
+    deleteList(backward);
+  }
+  if(temporary)
+    deletePathTree(tree);
+  return dirs;
+}
+
+LIST *pathFindRooms(ROOM_DATA *from, ROOM_DATA *to, int flags) {
+  bool   temporary = FALSE;
+  PATH_TREE  *tree = path_tree_get(from, to, flags, &temporary);
+  LIST   *backward = path_tree_walk(tree, to);
+  LIST      *rooms = NULL;
+  PATH_NODE  *node = NULL;
+
+  if(backward != NULL) {
+    rooms = newList();
+    while((node = listPop(backward)) != NULL) {
+      ROOM_DATA *room = worldGetRoom(gameworld, node->key);
+      if(room != NULL)
+	listPut(rooms, room);
+    }
+    deleteList(backward);
+  }
+  if(temporary)
+    deletePathTree(tree);
+  return rooms;
+}
+
+const char *pathStep(ROOM_DATA *from, ROOM_DATA *to, int flags) {
+  static char dir[SMALL_BUFFER];
+  bool   temporary = FALSE;
+  PATH_TREE  *tree = path_tree_get(from, to, flags, &temporary);
+  PATH_NODE  *node = hashGet(tree, roomGetClass(to));
+  bool       found = (node != NULL && node->done && node->first != NULL);
+
+  if(found)
+    strcpy(dir, node->first);
+  if(temporary)
+    deletePathTree(tree);
+  return (found ? dir : NULL);
+}
+
+void path_invalidate(ROOM_DATA *room) {
+  if(path_searching > 0 || path_zones == NULL || hashSize(path_zones) == 0)
+    return;
+  PATH_ZONE *zone = hashRemove(path_zones,get_key_locale(roomGetClass(room)));
+  if(zone != NULL)
+    deletePathZone(zone);
+}
+
+void path_door_changed(ROOM_DATA *room) {
+  if(path_searching > 0 || path_zones == NULL || hashSize(path_zones) == 0)
+    return;
+  PATH_ZONE *zone = hashGet(path_zones, get_key_locale(roomGetClass(room)));
+  int        mode;
+  if(zone != NULL) {
+    for(mode = 0; mode < NUM_PATH_MODES; mode++) {
+      if(IS_SET(mode, PATH_IGNORE_DOORS))
+	continue;
+      num_path_trees -= hashSize(zone->trees[mode]);
+      hashClearWith(zone->trees[mode], deletePathTree);
+    }
+  }
+}
+
+void path_room_unloading(ROOM_DATA *room) {
+  hashPut(path_unloaded_exits, roomGetClass(room),
+	  (void *)path_exits_hash(room));
+}
+
+void path_room_loading(void) {
+  path_searching++;
+}
+
+void path_room_loaded(const char *key, ROOM_DATA *room) {
+  path_searching--;
+  if(room == NULL)
+    return;
+  bool      known = hashIn(path_unloaded_exits, key);
+  unsigned long old = (unsigned long)hashRemove(path_unloaded_exits, key);
+  if(!known || old != path_exits_hash(room))
+    path_invalidate(room);
+}
@@ -0,0 +1,72 @@
+#ifndef PATH_H
+#define PATH_H
+//*****************************************************************************
+//
+// path.h
+//
+// Finds the shortest path between two rooms. By default, every step costs the
+// same, and the path with the fewest steps is found. Paths can also be
+// weighted, in which case rough terrain and closed doors cost more to go
+// through, and the cheapest path is found. Locked doors cannot be passed
+// through unless doors are ignored.
+//
+// Paths that stay within a zone are the ones most often asked for (mobs
+// patrolling or tracking). Each time one is looked for, everything reachable
+// from its starting room in the zone is mapped out and kept, so later paths
+// from the same room cost nothing to find. What is kept for a zone is thrown
+// out whenever any of its exits are added, removed, or sent somewhere else,
+// or one of its rooms changes terrain. When a door is opened, closed, locked
+// or unlocked, only paths that care about doors are thrown out. Loading a room
+// back in that was unloaded for being idle only counts, if its exits or
+// terrain are not what they were.
+//
+//*****************************************************************************
+
+#define PATH_IGNORE_DOORS     (1 << 0) // doors do not stop or slow us down
+#define PATH_WEIGHTED         (1 << 1) // terrain and doors cost extra
+#define PATH_STAY_ZONE        (1 << 2) // do not leave the zone we start in
+
+//
+// prepare pathfinding for use
+void init_path(void);
+
+//
+// returns a list of the directions to take to get from one room to the other,
+// or NULL if there is no path. The list must be deleted (with free on its
+// elements) after use. If the rooms are the same, the list is empty
+LIST *pathFindDirs(ROOM_DATA *from, ROOM_DATA *to, int flags);
+
+//
+// returns a list of the rooms passed through to get from one room to the
+// other, including the start and end rooms, or NULL if there is no path. The
+// list must be deleted (but not its contents) after use
+LIST *pathFindRooms(ROOM_DATA *from, ROOM_DATA *to, int flags);
+
+//
+// returns the first direction to take to get from one room to the other, or
+// NULL if there is no path or the rooms are the same
+const char *pathStep(ROOM_DATA *from, ROOM_DATA *to, int flags);
+
+//
+// the exits in a room have changed, so forget any paths through its zone
+void path_invalidate(ROOM_DATA *room);
+
+//
+// a door in the room has been opened, closed, locked or unlocked, so forget
+// any paths through its zone that did not ignore doors
+void path_door_changed(ROOM_DATA *room);
+
+//
+// a room is being unloaded. Remember what its exits were, so we can tell if
+// they are the same when it is loaded back in
+void path_room_unloading(ROOM_DATA *room);
+
+//
+// the room with the key is being loaded into the game. Setting its exits is
+// ignored between these calls. When it is loaded, paths through its zone are
+// only forgotten if its exits are not the same as when it was unloaded. If
+// the room could not be loaded, room is NULL
+void path_room_loading(void);
+void path_room_loaded (const char *key, ROOM_DATA *room);
+
+#endif // PATH_H
@@ -0,0 +1,150 @@
+//*****************************************************************************
+//
+// population.c
+//
+// Keeps count of how many instances of each prototype are in the game, and in
+// each room. The world's counts are kept from boot onwards. A room's counts are
+// only made the first time someone asks about the room, by looking at what is
+// in it, and are kept current after that until the room leaves the game.
+//
+//*****************************************************************************
+
+#include "mud.h"
+#include "utils.h"
+#include "room.h"
+#include "character.h"
+#include "object.h"
+#include "population.h"
+
+
+
+//*****************************************************************************
+// local datastructures, functions, and defines
+//*****************************************************************************
+
+//
+// the counts for one room
+typedef struct {
+  HASHTABLE *mobs; // prototype:count for mobiles standing in the room
+  HASHTABLE *objs; // prototype:count for objects lying in the room
+} ROOM_POPULATION;
+
+// counts for the whole game. Counts are stored directly as the table's values
+HASHTABLE *mob_population = NULL;
+HASHTABLE *obj_population = NULL;
+
+// rooms we have been asked to count in, and their counts
+MAP      *room_populations = NULL;
+
+//
+// add an amount to the count of every prototype in a prototypes list
+void population_change(HASHTABLE *table, const char *prototypes, int amount) {
+  if(!*prototypes)
+    return;
+
+  LIST           *protos = parse_keywords(prototypes);
+  LIST_ITERATOR *proto_i = newListIterator(protos);
+  char            *proto = NULL;
+  ITERATE_LIST(proto, proto_i) {
+    long count = (long)hashGet(table, proto) + amount;
+    if(count > 0)
+      hashPut(table, proto, (void *)count);
+    else
+      hashRemove(table, proto);
+  } deleteListIterator(proto_i);
+  deleteListWith(protos, free);
+}
+
+ROOM_POPULATION *newRoomPopulation(ROOM_DATA *room) {
+  ROOM_POPULATION *pop = malloc(sizeof(ROOM_POPULATION));
+  pop->mobs = newHashtable();
+  pop->objs = newHashtable();
+
+  LIST_ITERATOR *ch_i = newListIterator(roomGetCharacters(room));
+  CHAR_DATA       *ch = NULL;
+  ITERATE_LIST(ch, ch_i)
+    population_change(pop->mobs, charGetPrototypes(ch), 1);
+  deleteListIterator(ch_i);
+
+  LIST_ITERATOR *obj_i = newListIterator(roomGetContents(room));
+  OBJ_DATA        *obj = NULL;
+  ITERATE_LIST(obj, obj_i)
+    population_change(pop->objs, objGetPrototypes(obj), 1);
+  deleteListIterator(obj_i);
+
+  return pop;
+}
+
+void deleteRoomPopulation(ROOM_POPULATION *pop) {
+  deleteHashtable(pop->mobs);
+  deleteHashtable(pop->objs);
+  free(pop);
+}
+
+//
+// returns the counts for a room, making them if we have not yet
+ROOM_POPULATION *get_room_population(ROOM_DATA *room) {
+  ROOM_POPULATION *pop = mapGet(room_populations, room);
+  if(pop == NULL) {
+    pop = newRoomPopulation(room);
+    mapPut(room_populations, room, pop);
+  }
+  return pop;
+}
+
+
+
+//*****************************************************************************
+// implementation of population.h
+//*****************************************************************************
+void init_population(void) {
+  mob_population   = newHashtable();
+  obj_population   = newHashtable();
+  room_populations = newMap(NULL, NULL);
+}
+
+int count_live_chars(const char *prototype, ROOM_DATA *room) {
+  // rooms not in the game would never tell us when to forget them
+  if(room != NULL && !setIn(room_set, room))
+    return count_chars(NULL, roomGetCharacters(room), NULL, prototype, FALSE);
+  HASHTABLE *table = (room ? get_room_population(room)->mobs : mob_population);
+  return (int)(long)hashGet(table, prototype);
+}
+
+int count_live_objs(const char *prototype, ROOM_DATA *room) {
+  if(room != NULL && !setIn(room_set, room))
+    return count_objs(NULL, roomGetContents(room), NULL, prototype, FALSE);
+  HASHTABLE *table = (room ? get_room_population(room)->objs : obj_population);
+  return (int)(long)hashGet(table, prototype);
+}
+
+void population_char(CHAR_DATA *ch, ROOM_DATA *room, int amount) {
+  if(room == NULL)
+    population_change(mob_population, charGetPrototypes(ch), amount);
+  else {
+    ROOM_POPULATION *pop = mapGet(room_populations, room);
+    if(pop != NULL)
+      population_change(pop->mobs, charGetPrototypes(ch), amount);
+  }
+}
+
+void population_obj(OBJ_DATA *obj, ROOM_DATA *room, int amount) {
+  if(room == NULL)
+    population_change(obj_population, objGetPrototypes(obj), amount);
+  else {
+    ROOM_POPULATION *pop = mapGet(room_populations, room);
+    if(pop != NULL)
+      population_change(pop->objs, objGetPrototypes(obj), amount);
+  }
+}
+
+void population_dormant(const char *prototypes, bool mobile, int amount) {
+  population_change((mobile ? mob_population : obj_population), prototypes,
+		    amount);
+}
+
+void population_forget_room(ROOM_DATA *room) {
+  ROOM_POPULATION *pop = mapRemove(room_populations, room);
+  if(pop != NULL)
+    deleteRoomPopulation(pop);
+}
@@ -0,0 +1,46 @@
+#ifndef POPULATION_H
+#define POPULATION_H
+//*****************************************************************************
+//
+// population.h
+//
+// Keeps count of how many instances of each prototype are in the game, and in
+// each room, so things like resets can check their maxes without looking at
+// every mobile and object in the world. An instance counts towards every
+// prototype it inherits from, not just the one it was loaded from. Counts are
+// kept current by the handler functions that move things in and out of the
+// game and rooms.
+//
+//*****************************************************************************
+
+//
+// prepare population counts for use
+void init_population(void);
+
+//
+// returns how many mobiles that are instances of the prototype are in the
+// game. If a room is supplied, only mobiles in that room are counted
+int count_live_chars(const char *prototype, ROOM_DATA *room);
+
+//
+// returns how many objects that are instances of the prototype are in the
+// game. If a room is supplied, only objects lying in that room are counted
+int count_live_objs(const char *prototype, ROOM_DATA *room);
+
+//
+// add to (or, with a negative amount, take from) the counts for every
+// prototype the mobile or object is an instance of. If a room is supplied, its
+// counts are changed instead of the world's. Only the handler should use these
+void population_char(CHAR_DATA *ch,  ROOM_DATA *room, int amount);
+void population_obj (OBJ_DATA  *obj, ROOM_DATA *room, int amount);
+
+//
+// add to (or take from) the world's counts for a mobile or object that is out
+// of the game for now but will be back, e.g. one in a room that was unloaded
+void population_dormant(const char *prototypes, bool mobile, int amount);
+
+//
+// the room is leaving the game; forget what we counted in it
+void population_forget_room(ROOM_DATA *room);
+
+#endif // POPULATION_H
@@ -24,6 +24,7 @@ struct property_table {
   int num_buckets;
   int (* key_function)(void *elem);
   LIST **buckets;
+  unsigned int generation; // incremented every time something is removed
 };
 
 struct property_table_iterator {
@@ -62,6 +63,7 @@ PROPERTY_TABLE *newPropertyTable(void *key_function, int num_buckets) {
 
   table->num_buckets = num_buckets;
   table->key_function = key_function;
+  table->generation = 0;
 
   return table;
 };
@@ -112,6 +114,7 @@ void *propertyTableRemove(PROPERTY_TABLE *table, int key) {
       // we found it!
       if(key == table->key_function(elem)) {
 	listRemove(table->buckets[hash_bucket], elem);
+	table->generation++;
 	break;
       }
     }
@@ -151,6 +154,11 @@ bool propertyTableIn(PROPERTY_TABLE *table, int key) {
 };
 
 
+unsigned int propertyTableGetGeneration(PROPERTY_TABLE *table) {
+  return table->generation;
+}
+
+
 //*****************************************************************************
 // property table iterator
 //
@@ -63,6 +63,15 @@ void *propertyTableGet(PROPERTY_TABLE *table, int key);
 bool propertyTableIn(PROPERTY_TABLE *table, int key);
 
 
+//
+// Return the table's generation. It changes every time something is removed
+// from the table. As long as the generation has not changed, anything that
+// was found in the table is still in it. Lets users hold on to elements they
+// looked up without having to look them up again each time they are used.
+//
+unsigned int propertyTableGetGeneration(PROPERTY_TABLE *table);
+
+
 
 //*****************************************************************************
 //
@@ -40,8 +40,20 @@ struct prototype_data {
   bool   abstract;
   BUFFER  *script;
   PyObject  *code;
+
+  // if we and all of our parents are deterministic, this is a copy of what
+  // running our scripts produces. New instances are copied from it instead
+  // of re-running all of the scripts
+  void   *template;
+  void  (* template_deleter)(void *template);
+  int     template_gen;
 };
 
+// bumped whenever any prototype's script or parents change, since that can
+// change what any of its children produce. Templates from an older generation
+// are thrown out
+int proto_generation = 0;
+
 
 
 //*****************************************************************************
@@ -54,14 +66,27 @@ PROTO_DATA *newProto(void) {
   data->abstract = TRUE;
   data->script   = newBuffer(1);
   data->code     = NULL;
+  data->template = NULL;
+  data->template_deleter = NULL;
+  data->template_gen     = -1;
   return data;
 }
 
+//
+// throw out our template, if we have one
+void protoClearTemplate(PROTO_DATA *data) {
+  if(data->template != NULL)
+    data->template_deleter(data->template);
+  data->template     = NULL;
+  data->template_gen = -1;
+}
+
 void deleteProto(PROTO_DATA *data) {
   if(data->key)     free(data->key);
   if(data->parents) free(data->parents);
   if(data->script)  deleteBuffer(data->script);
   Py_XDECREF(data->code);
+  protoClearTemplate(data);
   free(data);
 }
 
@@ -103,11 +128,19 @@ void protoSetKey(PROTO_DATA *data, const char *key) {
 }
 
 void  protoSetParents(PROTO_DATA *data, const char *parents) {
+  if(strcmp(data->parents, (parents ? parents : "")))
+    proto_generation++;
   if(data->parents) free(data->parents);
   data->parents = strdupsafe(parents);
 }
 
 void   protoSetScript(PROTO_DATA *data, const char *script) {
+  // our old compiled code is no longer any good, and neither are any
+  // templates that were built with it
+  if(strcmp(bufferString(data->script), script)) {
+    script_cache_forget(bufferString(data->script));
+    proto_generation++;
+  }
   bufferClear(data->script);
   bufferCat(data->script, script);
   Py_XDECREF(data->code);
@@ -138,6 +171,67 @@ BUFFER *protoGetScriptBuffer(PROTO_DATA *data) {
   return data->script;
 }
 
+//
+// find one of a prototype's parents. If the parent's key has no locale, it is
+// assumed to be in the same locale as the prototype
+PROTO_DATA *protoGetParent(PROTO_DATA *proto, const char *type, 
+			   const char *parent) {
+  if(next_letter_in(parent, '@') == -1)
+    return worldGetType(gameworld, type, 
+			get_fullkey(parent, get_key_locale(proto->key)));
+  else
+    return worldGetType(gameworld, type, parent);
+}
+
+//
+// returns TRUE if the prototype and all of its parents are deterministic,
+// and the results of running them can be copied instead of re-run
+bool protoIsDeterministic(PROTO_DATA *proto, const char *type) {
+  if(proto->code == NULL && 
+     (proto->code = compile_script_cached(bufferString(proto->script)))==NULL){
+    PyErr_Clear();
+    return FALSE;
+  }
+  if(!script_is_deterministic(proto->code))
+    return FALSE;
+
+  LIST           *parents = parse_keywords(proto->parents);
+  LIST_ITERATOR *parent_i = newListIterator(parents);
+  char        *one_parent = NULL;
+  bool          determ_ok = TRUE;
+  ITERATE_LIST(one_parent, parent_i) {
+    PROTO_DATA *parent = protoGetParent(proto, type, one_parent);
+    if(parent == NULL || !protoIsDeterministic(parent, type)) {
+      determ_ok = FALSE;
+      break;
+    }
+  } deleteListIterator(parent_i);
+  deleteListWith(parents, free);
+  return determ_ok;
+}
+
+//
+// returns our template, if it is up to date
+void *protoGetTemplate(PROTO_DATA *proto) {
+  return (proto->template_gen == proto_generation ? proto->template : NULL);
+}
+
+//
+// after a successful run, decide whether we can reuse its results for later
+// instances. Only done once per generation; non-deterministic prototypes are
+// simply remembered as having no template
+void protoTryTemplate(PROTO_DATA *proto, const char *type, void *me,
+		      void *copier, void *deleter) {
+  if(proto->template_gen == proto_generation)
+    return;
+  protoClearTemplate(proto);
+  if(protoIsDeterministic(proto, type)) {
+    proto->template         = ((void *(*)(void *))copier)(me);
+    proto->template_deleter = deleter;
+  }
+  proto->template_gen = proto_generation;
+}
+
 bool protoRunAs(PROTO_DATA *proto, const char *type, const char *as, 
 		void *pynewfunc, void *protoaddfunc, void *protoclassfunc, 
 		void *me) {
@@ -149,15 +243,8 @@ bool protoRunAs(PROTO_DATA *proto, const char *type, const char *as,
 
   // try to run each parent
   ITERATE_LIST(one_parent, parent_i) {
-    PROTO_DATA *parent = NULL;
     // does our parent have a locale? If so, find it. If not, use ours
-    int separator_pos = next_letter_in(one_parent, '@');
-    if(separator_pos == -1)
-      parent = worldGetType(gameworld, type, 
-			    get_fullkey(one_parent,get_key_locale(proto->key)));
-    else
-      parent = worldGetType(gameworld, type, one_parent);
-    
+    PROTO_DATA *parent = protoGetParent(proto, type, one_parent);
     if(parent == NULL) {
       log_string("ERROR: could not find parent %s for %s %s.", one_parent,
 		 type, protoGetKey(proto));
@@ -189,28 +276,28 @@ bool protoRunAs(PROTO_DATA *proto, const char *type, const char *as,
   PyDict_SetItemString(dict, "me", pyme);
 
   // do we have our own code already, or do we need to compile from source?
-  if(proto->code == NULL) {
-    proto->code = run_script_forcode(dict, bufferString(proto->script), 
-				     get_key_locale(as));
-  }
-  // we already have a code object. Evaluate it.
+  // Compiled code is cached on disk, so this is usually just a read
+  if(proto->code == NULL)
+    proto->code = compile_script_cached(bufferString(proto->script));
+
+  // evaluate our code object, if we could get one
+  if(proto->code == NULL)
+    log_pyerr("Prototype %s failed to compile:\r\n%s",
+	      proto->key, bufferString(proto->script));
   else {
-    run_code(proto->code, dict, get_key_locale(as));
+    char owner[SMALL_BUFFER];
+    sprintf(owner, "proto %s", proto->key);
+    run_code(proto->code, dict, get_key_locale(as), owner);
     
     if(!last_script_ok())
       log_pyerr("Prototype %s terminated with an error:\r\n%s",
 		proto->key, bufferString(proto->script));
   }
 
-  // remove us from the dictionary just incase it doesn't GC immediately. It
-  // happens sometimes if we define a new method in the prototype
-  PyDict_DelItemString(dict, "me");
-  // PyDict_SetItemString(dict, "me", Py_None);
-
   // garbage collection
-  Py_DECREF(dict);
+  release_script_dict(dict);
   // Py_DECREF(pyme);
-  return last_script_ok();
+  return proto->code != NULL && last_script_ok();
 }
 
 bool protoRun(PROTO_DATA *proto, const char *type, void *pynewfunc, 
@@ -223,9 +310,22 @@ CHAR_DATA *protoMobRun(PROTO_DATA *proto) {
   if(protoIsAbstract(proto))
     return NULL;
   CHAR_DATA *ch = newMobile();
+
+  // if running our scripts always gives the same mob, just copy it
+  CHAR_DATA *template = protoGetTemplate(proto);
+  if(template != NULL) {
+    charCopyTo(template, ch);
+    charSetBirth(ch, current_time);
+    char_exist(ch);
+    char_to_game(ch);
+    return ch;
+  }
+
   char_exist(ch);
-  if(protoRun(proto, "mproto", charGetPyFormBorrowed, charAddPrototype, charSetClass, ch))
+  if(protoRun(proto, "mproto", charGetPyFormBorrowed, charAddPrototype, charSetClass, ch)) {
+    protoTryTemplate(proto, "mproto", ch, charCopy, deleteChar);
     char_to_game(ch);
+  }
   else {
     // should this be char_unexist? Check to see what difference it makes
     extract_mobile(ch);
@@ -239,9 +339,22 @@ OBJ_DATA *protoObjRun(PROTO_DATA *proto) {
   if(protoIsAbstract(proto))
     return NULL;
   OBJ_DATA *obj = newObj();
+
+  // if running our scripts always gives the same object, just copy it
+  OBJ_DATA *template = protoGetTemplate(proto);
+  if(template != NULL) {
+    objCopyTo(template, obj);
+    objSetBirth(obj, current_time);
+    obj_exist(obj);
+    obj_to_game(obj);
+    return obj;
+  }
+
   obj_exist(obj);
-  if(protoRun(proto, "oproto", objGetPyFormBorrowed, objAddPrototype, objSetClass, obj))
+  if(protoRun(proto, "oproto", objGetPyFormBorrowed, objAddPrototype, objSetClass, obj)) {
+    protoTryTemplate(proto, "oproto", obj, objCopy, deleteObj);
     obj_to_game(obj);
+  }
   else {
     // should this be obj_unexist? Check to see what difference it makes
     extract_obj(obj);
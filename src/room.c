@@ -21,6 +21,15 @@
 #include "room.h"
 #include "character.h"
 #include "object.h"
+#include "path.h"
+#include "broadcast.h"
+
+//
+// one of a room's exits, and the interned id of the direction it is in
+typedef struct {
+  int         dir;
+  EXIT_DATA  *exit;
+} ROOM_EXIT;
 
 struct room_data {
   int         uid;               // what is our unique room ID number?
@@ -29,7 +38,9 @@ struct room_data {
   char       *name;              // what is the name of our room?
   BUFFER     *desc;              // our description
 
-  HASHTABLE  *exits;             // a dir:exit mapping
+  ROOM_EXIT  *exits;             // our exits, in the order they were made
+  short       num_exits;         // how many exits do we have?
+  short       max_exits;         // how many exits do we have space for?
   NEAR_MAP   *cmd_table;         // a listing for all our room-only commands
   EDESC_SET  *edescs;            // the extra descriptions in the room
   BITVECTOR  *bits;              // the bits we have turned on
@@ -65,7 +76,9 @@ ROOM_DATA *newRoom() {
   room->bits           = bitvectorInstanceOf("room_bits");
   room->auxiliary_data = newAuxiliaryData(AUXILIARY_TYPE_ROOM);
 
-  room->exits      = newHashtable();
+  room->exits      = NULL;
+  room->num_exits  = 0;
+  room->max_exits  = 0;
   room->edescs     = newEdescSet();
   room->contents   = newList();
   room->characters = newList();
@@ -102,13 +115,10 @@ void deleteRoom(ROOM_DATA *room) {
   deleteList(room->characters);
 
   // delete all of our exits
-  HASH_ITERATOR *ex_i = newHashIterator(room->exits);
-  const char     *dir = NULL;
-  EXIT_DATA       *ex = NULL;
-  ITERATE_HASH(dir, ex, ex_i)
-    deleteExit(ex);
-  deleteHashIterator(ex_i);
-  deleteHashtable(room->exits);
+  int i;
+  for(i = 0; i < room->num_exits; i++)
+    deleteExit(room->exits[i].exit);
+  if(room->exits) free(room->exits);
 
   // delete all of our commands
   if(room->cmd_table != NULL) {
@@ -149,20 +159,21 @@ STORAGE_SET *roomStore(ROOM_DATA *room) {
   store_set   (set, "edescs",     edescSetStore(room->edescs));
   store_list  (set, "exits",      ex_list);
   store_long  (set, "birth",      room->birth);
+  store_string(set, "room_bits",  bitvectorGetBits(room->bits));
 
   // store all of our exits. We're doing this in an odd way by putting the
   // direction name on the storage set for the exit. They should probably be
   // in different storage sets, and nested in another key:val pair storage set.
   // But this is the way we started doing it, and for the sake of compatibility,
   // we're going to keep at it...
-  HASH_ITERATOR *ex_i = newHashIterator(room->exits);
   const char     *dir = NULL;
   EXIT_DATA       *ex = NULL;
-  ITERATE_HASH(dir, ex, ex_i) {
+  int               i = 0;
+  ITERATE_EXITS(dir, ex, room, i) {
     STORAGE_SET *ex_set = exitStore(ex);
     store_string(ex_set, "direction", dir);
     storage_list_put(ex_list, ex_set);
-  } deleteHashIterator(ex_i);
+  }
   
   // store our auxiliary data
   store_set(set, "auxiliary", auxiliaryDataStore(room->auxiliary_data));
@@ -268,22 +279,21 @@ void roomCopyTo(ROOM_DATA *from, ROOM_DATA *to) {
   bool room_in_game    = listIn(room_list, to);
 
   // first, delete all of our old exits
-  HASH_ITERATOR *ex_i = newHashIterator(to->exits);
   const char     *dir = NULL;
   EXIT_DATA       *ex = NULL;
-  ITERATE_HASH(dir, ex, ex_i) {
-    hashRemove(to->exits, dir);
+  int               i = 0;
+  while(to->num_exits > 0) {
+    ex = roomRemoveExit(to, dirGetInternedName(to->exits[0].dir));
     if(does_room_exist) exit_from_game(ex);
     deleteExit(ex);
-  } deleteHashIterator(ex_i);
+  }
 
   // now, copy all of our new exits
-  ex_i = newHashIterator(from->exits);
-  ITERATE_HASH(dir, ex, ex_i) {
+  ITERATE_EXITS(dir, ex, from, i) {
     roomSetExit(to, dir, exitCopy(ex));
     if(does_room_exist) exit_exist(ex);
     if(room_in_game)    exit_to_game(roomGetExit(to, dir));
-  } deleteHashIterator(ex_i);
+  }
 
   // delete all of our old commands
   if(to->cmd_table != NULL) {
@@ -312,6 +322,10 @@ void roomCopyTo(ROOM_DATA *from, ROOM_DATA *to) {
   auxiliaryDataCopyTo(from->auxiliary_data, to->auxiliary_data);
 }
 
+void roomSetUID(ROOM_DATA *room, int uid) {
+  room->uid = uid;
+}
+
 void roomSetExtracted(ROOM_DATA *room) {
   room->extracted = TRUE;
 }
@@ -363,37 +377,86 @@ void roomAddObj(ROOM_DATA *room, OBJ_DATA *obj) {
 //*****************************************************************************
 // exit functions
 //*****************************************************************************
+
+//
+// returns where in the room's exit array the exit with the interned direction
+// id is, or -1 if we have no exit in that direction
+int roomFindExit(ROOM_DATA *room, int dir) {
+  int i;
+  for(i = 0; i < room->num_exits; i++)
+    if(room->exits[i].dir == dir)
+      return i;
+  return -1;
+}
+
 void roomSetExit(ROOM_DATA *room, const char *dir, EXIT_DATA *exit) {
-  hashPut(room->exits, dir, exit);
+  int id  = dirIntern(dir);
+  int pos = roomFindExit(room, id);
+  if(pos < 0) {
+    if(room->num_exits == room->max_exits) {
+      room->max_exits += 2;
+      room->exits = realloc(room->exits, room->max_exits * sizeof(ROOM_EXIT));
+    }
+    pos = room->num_exits++;
+    room->exits[pos].dir = id;
+  }
+  room->exits[pos].exit = exit;
   exitSetRoom(exit, room);
+  path_invalidate(room);
 }
 
 EXIT_DATA *roomGetExit(ROOM_DATA *room, const char *dir) {
-  return hashGet(room->exits, dir);
+  int pos = roomFindExit(room, dirGetInterned(dir));
+  return (pos < 0 ? NULL : room->exits[pos].exit);
+}
+
+EXIT_DATA *roomGetDirExit(ROOM_DATA *room, int dir) {
+  int pos = roomFindExit(room, dir);
+  return (pos < 0 ? NULL : room->exits[pos].exit);
 }
 
 EXIT_DATA *roomRemoveExit(ROOM_DATA *room, const char *dir) {
-  EXIT_DATA *exit = hashRemove(room->exits, dir);
-  if(exit != NULL) exitSetRoom(exit, NULL);
+  int pos = roomFindExit(room, dirGetInterned(dir));
+  if(pos < 0)
+    return NULL;
+
+  // keep the rest of our exits in the order they were made
+  EXIT_DATA *exit = room->exits[pos].exit;
+  room->num_exits--;
+  memmove(room->exits + pos, room->exits + pos + 1,
+	  (room->num_exits - pos) * sizeof(ROOM_EXIT));
+  exitSetRoom(exit, NULL);
+  path_invalidate(room);
   return exit;
 }
 
 const char *roomGetExitDir(ROOM_DATA *room, EXIT_DATA *exit) {
-  // go through all of our key:val pairs, and see which key matches this exit
-  HASH_ITERATOR *ex_i = newHashIterator(room->exits);
-  const char     *dir = NULL;
-  EXIT_DATA       *ex = NULL;
-  ITERATE_HASH(dir, ex, ex_i) {
-    if(ex == exit) {
-      deleteHashIterator(ex_i);
-      return dir;
-    }
-  } deleteHashIterator(ex_i);
+  int i;
+  for(i = 0; i < room->num_exits; i++)
+    if(room->exits[i].exit == exit)
+      return dirGetInternedName(room->exits[i].dir);
   return NULL;
 }
 
 LIST *roomGetExitNames(ROOM_DATA *room) {
-  return hashCollect(room->exits);
+  LIST *names = newList();
+  int i;
+  for(i = 0; i < room->num_exits; i++)
+    listQueue(names, strdup(dirGetInternedName(room->exits[i].dir)));
+  return names;
+}
+
+int roomGetNumExits(ROOM_DATA *room) {
+  return room->num_exits;
+}
+
+bool roomGetExitAt(ROOM_DATA *room, int num, const char **dir, 
+		   EXIT_DATA **exit) {
+  if(num < 0 || num >= room->num_exits)
+    return FALSE;
+  *dir  = dirGetInternedName(room->exits[num].dir);
+  *exit = room->exits[num].exit;
+  return TRUE;
 }
 
 
@@ -472,7 +535,17 @@ void        roomSetDesc (ROOM_DATA *room, const char *desc) {
 }
 
 void        roomSetTerrain     (ROOM_DATA *room, int terrain_type) {
+  // weighted paths through here cost something different now
+  if(room->terrain != terrain_type)
+    path_invalidate(room);
   room->terrain = terrain_type;
+
+  // anyone here might have just gone indoors or outdoors
+  LIST_ITERATOR *ch_i = newListIterator(room->characters);
+  CHAR_DATA       *ch = NULL;
+  ITERATE_LIST(ch, ch_i) {
+    broadcast_update(ch);
+  } deleteListIterator(ch_i);
 }
 
 BITVECTOR *roomGetBits(const ROOM_DATA *room) {
@@ -578,6 +651,47 @@ int dirGetAbbrevNum(const char *dir) {
   return DIR_NONE;
 }
 
+//
+// every direction name we have seen, by id, and the ids by name. Ids are
+// stored in the table one higher than they are, so id 0 is not a NULL value
+HASHTABLE *dir_ids       = NULL;
+char     **dir_interned  = NULL;
+int        num_interned  = 0;
+int        max_interned  = 0;
+
+//
+// make our interning tables, with the standard directions already in them
+void init_dir_interning(void) {
+  int i;
+  dir_ids = newHashtable();
+  for(i = 0; i < NUM_DIRS; i++)
+    dirIntern(dir_names[i]);
+}
+
+int dirIntern(const char *dir) {
+  int id = dirGetInterned(dir);
+  if(id != DIR_NONE)
+    return id;
+  if(num_interned == max_interned) {
+    max_interned += NUM_DIRS;
+    dir_interned  = realloc(dir_interned, max_interned * sizeof(char *));
+  }
+  id = num_interned++;
+  dir_interned[id] = strdup(dir);
+  hashPut(dir_ids, dir, (void *)(long)(id + 1));
+  return id;
+}
+
+int dirGetInterned(const char *dir) {
+  if(dir_ids == NULL)
+    init_dir_interning();
+  return (int)(long)hashGet(dir_ids, dir) - 1;
+}
+
+const char *dirGetInternedName(int id) {
+  return dir_interned[id];
+}
+
 
 
 //*****************************************************************************
@@ -113,6 +113,23 @@ EXIT_DATA  *roomRemoveExit(ROOM_DATA *room, const char *dir);
 const char *roomGetExitDir(ROOM_DATA *room, EXIT_DATA *exit);
 LIST     *roomGetExitNames(ROOM_DATA *room);
 
+//
+// get the exit in one of the standard directions (or any other interned
+// direction id; see dirIntern)
+EXIT_DATA  *roomGetDirExit(ROOM_DATA *room, int dir);
+
+//
+// look at a room's exits one by one without allocating anything. Exits are
+// numbered from 0 in the order they were made. roomGetExitAt returns FALSE
+// when there is no exit with the number. Rooms must not gain or lose exits
+// while they are being iterated over
+#define ITERATE_EXITS(dir, exit, room, i) \
+  for(i = 0; roomGetExitAt(room, i, &dir, &exit); i++)
+
+int         roomGetNumExits(ROOM_DATA *room);
+bool          roomGetExitAt(ROOM_DATA *room, int num, const char **dir,
+			    EXIT_DATA **exit);
+
 EDESC_SET  *roomGetEdescs       (const ROOM_DATA *room);
 const char *roomGetEdesc        (const ROOM_DATA *room, const char *keyword);
 void       *roomGetAuxiliaryData(const ROOM_DATA *room, const char *name);
@@ -138,6 +155,7 @@ void        roomSetEdescs      (ROOM_DATA *room, EDESC_SET *edescs);
 void        roomSetName        (ROOM_DATA *room, const char *name);
 void        roomSetDesc        (ROOM_DATA *room, const char *desc);
 void        roomSetTerrain     (ROOM_DATA *room, int terrain_type);
+void        roomSetUID         (ROOM_DATA *room, int uid);
 void        roomSetExtracted   (ROOM_DATA *room);
 bool        roomIsExtracted    (ROOM_DATA *room);
 
@@ -153,6 +171,16 @@ int dirGetOpposite(int dir);
 int dirGetNum(const char *dir);
 int dirGetAbbrevNum(const char *dir);
 
+//
+// every direction an exit can be in, including special ones like "stage", gets
+// a small id number the first time it is seen. The standard directions' ids are
+// the same as their DIR_ numbers. Names are not case sensitive; an id's name is
+// spelled the way it was when it was first seen. dirGetInterned returns
+// DIR_NONE if the direction has never been seen
+int         dirIntern         (const char *dir);
+int         dirGetInterned    (const char *dir);
+const char *dirGetInternedName(int id);
+
 
 
 //*****************************************************************************
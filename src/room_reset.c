@@ -9,6 +9,8 @@
 //
 //*****************************************************************************
 
+#include <sys/time.h>
+
 #include "mud.h"
 #include "utils.h"
 #include "storage.h"
@@ -23,6 +25,8 @@
 #include "prototype.h"
 #include "hooks.h"
 #include "room_reset.h"
+#include "population.h"
+#include "idle_rooms.h"
 
 
 
@@ -340,12 +344,10 @@ bool try_reset_load_object(RESET_DATA *reset, void *initiator,
 
   // see if we're already at our max
   if(resetGetMax(reset) != 0 && 
-     count_objs(NULL, object_list, NULL, fullkey, FALSE) >= 
-     resetGetMax(reset))
+     count_live_objs(fullkey, NULL) >= resetGetMax(reset))
     return FALSE;
   if(initiator_type == INITIATOR_ROOM && resetGetRoomMax(reset) != 0 &&
-     (count_objs(NULL, roomGetContents(initiator), NULL, fullkey,
-		 FALSE) >= resetGetRoomMax(reset)))
+     count_live_objs(fullkey, initiator) >= resetGetRoomMax(reset))
     return FALSE;
 
   OBJ_DATA *obj = protoObjRun(proto);
@@ -422,11 +424,10 @@ bool try_reset_load_mobile(RESET_DATA *reset, void *initiator,
 
   // see if we're already at our max
   if(resetGetMax(reset) != 0 && 
-     count_chars(NULL, mobile_list, NULL, fullkey, FALSE) >= resetGetMax(reset))
+     count_live_chars(fullkey, NULL) >= resetGetMax(reset))
     return FALSE;
   if(initiator_type == INITIATOR_ROOM && resetGetRoomMax(reset) != 0 &&
-     (count_chars(NULL, roomGetCharacters(initiator), NULL, fullkey,
-		  FALSE) >= resetGetRoomMax(reset)))
+     count_live_chars(fullkey, initiator) >= resetGetRoomMax(reset))
     return FALSE;
 
   CHAR_DATA *mob = protoMobRun(proto);
@@ -614,7 +615,7 @@ bool try_reset_opening(RESET_DATA *reset, void *initiator, int initiator_type,
 
     // are we using an abbreviation?
     if(exit == NULL && (dirnum = dirGetAbbrevNum(resetGetArg(reset)))!=DIR_NONE)
-      exit = roomGetExit(initiator, dirGetName(dirnum));
+      exit = roomGetDirExit(initiator, dirnum);
 
     // did we find a valid exit?
     if(exit == NULL)
@@ -750,7 +751,11 @@ bool resetRun(RESET_DATA *reset, void *initiator, int initiator_type,
 
 
 //*****************************************************************************
-// initialization function
+// the reset queue
+//
+// Resetting a whole zone at once can take long enough to lag the game, so
+// zone resets only queue up their rooms. Rooms are taken off the queue and
+// reset a few at a time each pulse, until the pulse's time budget is spent.
 //*****************************************************************************
 
 //
@@ -770,32 +775,122 @@ void do_resets(ROOM_DATA *room) {
   deleteListWith(protos, free);
 }
 
+// keys of the rooms waiting to be reset, in the order they will be reset,
+// and a table of the same keys so we do not queue a room twice
+LIST      *reset_queue = NULL;
+HASHTABLE *reset_queued = NULL;
+
+// how much resetting we have done since our stats were last cleared
+int    reset_rooms_done   = 0; // how many rooms have we reset?
+int    reset_pulses_used  = 0; // how many pulses have had resets in them?
+int    reset_over_budget  = 0; // how many pulses went over their budget?
+int    reset_backlog_max  = 0; // the most rooms ever waiting at once
+double reset_time_spent   = 0; // how long have resets taken, in seconds?
+
+//
+// returns how many seconds have passed between two times
+double reset_elapsed(struct timeval *start, struct timeval *end) {
+  return ((end->tv_sec  - start->tv_sec) +
+	  (end->tv_usec - start->tv_usec) / 1000000.0);
+}
+
+//
+// queue up a room to be reset, if it is not waiting to be already
+void reset_queue_room(const char *key) {
+  if(hashIn(reset_queued, key))
+    return;
+  hashPut(reset_queued, key, NULL);
+  listQueue(reset_queue, strdup(key));
+  if(listSize(reset_queue) > reset_backlog_max)
+    reset_backlog_max = listSize(reset_queue);
+}
+
+void reset_queue_pulse(void) {
+  if(listSize(reset_queue) == 0)
+    return;
+
+  struct timeval start, now;
+  double budget = mudsettingGetInt("reset_budget") / 1000000.0;
+  double  spent = 0;
+  char     *key = NULL;
+  ROOM_DATA *room = NULL;
+  gettimeofday(&start, NULL);
+
+  // always reset at least one room, so the queue keeps moving. A budget of
+  // zero or less means we reset everything that is waiting
+  do {
+    key = listPop(reset_queue);
+    hashRemove(reset_queued, key);
+    if(!idle_room_defer_reset(key) &&
+       (room = worldGetRoom(gameworld, key)) != NULL)
+      do_resets(room);
+    free(key);
+    reset_rooms_done++;
+
+    gettimeofday(&now, NULL);
+    spent = reset_elapsed(&start, &now);
+  } while(listSize(reset_queue) > 0 && (budget <= 0 || spent < budget));
+
+  reset_pulses_used++;
+  reset_time_spent += spent;
+  if(budget > 0 && spent > budget)
+    reset_over_budget++;
+}
+
+int reset_queue_size(void) {
+  return listSize(reset_queue);
+}
+
+void reset_queue_stats(BUFFER *buf) {
+  bprintf(buf, "Rooms waiting to reset: %d (most ever: %d)\r\n",
+	  listSize(reset_queue), reset_backlog_max);
+  bprintf(buf, "Rooms reset:            %d, over %d pulses\r\n",
+	  reset_rooms_done, reset_pulses_used);
+  bprintf(buf, "Time spent resetting:   %.1f ms (%.2f ms per pulse)\r\n",
+	  reset_time_spent * 1000,
+	  (reset_pulses_used ? reset_time_spent*1000 / reset_pulses_used : 0));
+  if(mudsettingGetInt("reset_budget") <= 0)
+    bprintf(buf, "Pulses over budget:     none (budget: unlimited)\r\n");
+  else
+    bprintf(buf, "Pulses over budget:     %d (budget: %d usec)\r\n",
+	    reset_over_budget, mudsettingGetInt("reset_budget"));
+}
+
+void reset_queue_stats_clear(void) {
+  reset_rooms_done  = reset_pulses_used = reset_over_budget = 0;
+  reset_backlog_max = listSize(reset_queue);
+  reset_time_spent  = 0;
+}
+
+
+
+//*****************************************************************************
+// initialization function
+//*****************************************************************************
+
 //
 // room reset hook. Whenever a room is reset, apply all of the reset rules for
 // it and its parent.
-void room_reset_hook(const char *info) {
+void room_reset_hook(HOOK_ARGS *args) {
   ROOM_DATA *room = NULL;
-  hookParseInfo(info, &room);
+  hookParseArgs(args, &room);
   if(room != NULL)
     do_resets(room);
 }
 
 //
-// zone reset hook. Whenever a zone is reset, apply all of its reset rules for
-// each room in the zone.
-void zone_reset_hook(const char *info) {
+// zone reset hook. Whenever a zone is reset, queue up each room in the zone to
+// have all of its reset rules applied.
+void zone_reset_hook(HOOK_ARGS *args) {
   char  *zone_key = NULL;
-  hookParseInfo(info, &zone_key);
+  hookParseArgs(args, &zone_key);
   ZONE_DATA *zone = worldGetZone(gameworld, zone_key);
 
   LIST_ITERATOR *res_i = newListIterator(zoneGetResettable(zone));
   char           *name = NULL;
   const char   *locale = zone_key;
-  ROOM_DATA      *room = NULL;
   ITERATE_LIST(name, res_i) {
-    if((room = worldGetRoom(gameworld, get_fullkey(name, locale))) != NULL) {
-      do_resets(room);
-    }
+    reset_queue_room(get_fullkey(name, locale));
   } deleteListIterator(res_i);
 
   // garbage collection
@@ -803,6 +898,8 @@ void zone_reset_hook(const char *info) {
 }
 
 void init_room_reset(void) {
+  reset_queue  = newList();
+  reset_queued = newHashtable();
   hookAdd("reset_zone", zone_reset_hook);
   hookAdd("reset_room", room_reset_hook);
 }
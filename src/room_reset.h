@@ -36,6 +36,26 @@
 // must be called before room resets are usable. Attaches a reset hook
 void init_room_reset(void);
 
+//
+// run all of the resets for a specified room
+void do_resets(ROOM_DATA *room);
+
+//
+// zone resets do not happen all at once. Their rooms are queued up, and some
+// are reset each pulse, until the "reset_budget" mud setting (in microseconds)
+// has been spent. A budget of 0 resets every waiting room at once. This should
+// be called once every pulse
+void reset_queue_pulse(void);
+
+//
+// returns how many rooms are waiting to be reset
+int reset_queue_size(void);
+
+//
+// print how the reset queue has been doing to the buffer, or clear the stats
+void reset_queue_stats(BUFFER *buf);
+void reset_queue_stats_clear(void);
+
 const char    *resetTypeGetName (int type);
 
 RESET_DATA    *newReset         (void);
@@ -22,6 +22,7 @@
 #include "../action.h"
 #include "../socket.h"
 #include "../prototype.h"
+#include "../population.h"
 #include "../save.h"
 #include "../inform.h"
 
@@ -58,6 +59,10 @@ LIST *pychar_methods = NULL;
 typedef struct {
   PyObject_HEAD
   int uid;
+  // the character we wrap. Valid as long as mob_table has the same generation
+  // as when we looked it up
+  CHAR_DATA *ch;
+  unsigned int gen;
 } PyChar;
 
 
@@ -95,6 +100,8 @@ int PyChar_init(PyChar *self, PyObject *args, PyObject *kwds) {
   }
 
   self->uid = uid;
+
+  self->ch = NULL;
   return 0;
 }
 
@@ -358,11 +365,12 @@ PyObject *PyChar_getsocket(PyChar *self, void *closure) {
 // Standard check to make sure the character exists when
 // trying to set a value for it. If successful, assign the
 // character to ch. Otherwise, return -1 (error)
-#define PYCHAR_CHECK_CHAR_EXISTS(uid, ch)                                      \
-  ch = propertyTableGet(mob_table, uid);                                       \
+#define PYCHAR_CHECK_CHAR_EXISTS(self, ch)                                     \
+  ch = PyChar_AsChar((PyObject *)self);                                        \
   if(ch == NULL) {                                                             \
     PyErr_Format(PyExc_TypeError,                                              \
-		    "Tried to modify nonexistant character, %d", uid);         \
+		    "Tried to modify nonexistant character, %d",               \
+		    PyChar_AsUid((PyObject *)self));                           \
     return -1;                                                                 \
   }                                                                            
 
@@ -379,7 +387,7 @@ int PyChar_setname(PyChar *self, PyObject *value, void *closure) {
   }
 
   CHAR_DATA *ch;
-  PYCHAR_CHECK_CHAR_EXISTS(self->uid, ch);
+  PYCHAR_CHECK_CHAR_EXISTS(self, ch);
   charSetName(ch, PyString_AsString(value));
   return 0;
 }
@@ -396,7 +404,7 @@ int PyChar_setkeywords(PyChar *self, PyObject *value, void *closure) {
   }
 
   CHAR_DATA *ch;
-  PYCHAR_CHECK_CHAR_EXISTS(self->uid, ch);
+  PYCHAR_CHECK_CHAR_EXISTS(self, ch);
 
   // clean up empty keywords, and rebuild it
   LIST           *kwds = parse_keywords(PyString_AsString(value));
@@ -432,7 +440,7 @@ int PyChar_setmname(PyChar *self, PyObject *value, void *closure) {
   }
 
   CHAR_DATA *ch;
-  PYCHAR_CHECK_CHAR_EXISTS(self->uid, ch);
+  PYCHAR_CHECK_CHAR_EXISTS(self, ch);
   charSetMultiName(ch, PyString_AsString(value));
   return 0;
 }
@@ -449,14 +457,14 @@ int PyChar_setdesc(PyChar *self, PyObject *value, void *closure) {
   }
 
   CHAR_DATA *ch;
-  PYCHAR_CHECK_CHAR_EXISTS(self->uid, ch);
+  PYCHAR_CHECK_CHAR_EXISTS(self, ch);
   charSetDesc(ch, PyString_AsString(value));
   return 0;
 }
 
 int PyChar_sethidden(PyObject *self, PyObject *value, void *closure) {
   CHAR_DATA *ch = NULL;
-  PYCHAR_CHECK_CHAR_EXISTS(PyChar_AsUid(self), ch);
+  PYCHAR_CHECK_CHAR_EXISTS(self, ch);
 
   if(value == NULL || value == Py_None)
     charSetHidden(ch, 0);
@@ -474,7 +482,7 @@ int PyChar_sethidden(PyObject *self, PyObject *value, void *closure) {
 
 int PyChar_setweight(PyObject *self, PyObject *value, void *closure) {
   CHAR_DATA *ch = NULL;
-  PYCHAR_CHECK_CHAR_EXISTS(PyChar_AsUid(self), ch);
+  PYCHAR_CHECK_CHAR_EXISTS(self, ch);
 
   if(value == NULL || value == Py_None)
     charSetWeight(ch, 0.0);
@@ -504,7 +512,7 @@ int PyChar_setlookbuf(PyChar *self, PyObject *value, void *closure) {
   }
 
   CHAR_DATA *ch;
-  PYCHAR_CHECK_CHAR_EXISTS(self->uid, ch);
+  PYCHAR_CHECK_CHAR_EXISTS(self, ch);
   bufferClear(charGetLookBuffer(ch));
   bufferCat(charGetLookBuffer(ch), PyString_AsString(value));
   return 0;
@@ -522,7 +530,7 @@ int PyChar_setrdesc(PyChar *self, PyObject *value, void *closure) {
   }
 
   CHAR_DATA *ch;
-  PYCHAR_CHECK_CHAR_EXISTS(self->uid, ch);
+  PYCHAR_CHECK_CHAR_EXISTS(self, ch);
   charSetRdesc(ch, PyString_AsString(value));
   return 0;
 }
@@ -539,7 +547,7 @@ int PyChar_setmdesc(PyChar *self, PyObject *value, void *closure) {
   }
 
   CHAR_DATA *ch;
-  PYCHAR_CHECK_CHAR_EXISTS(self->uid, ch);
+  PYCHAR_CHECK_CHAR_EXISTS(self, ch);
   charSetMultiRdesc(ch, PyString_AsString(value));
   return 0;
 }
@@ -560,7 +568,7 @@ int PyChar_setrace(PyChar *self, PyObject *value, void *closure) {
     return -1;
 
   CHAR_DATA *ch;
-  PYCHAR_CHECK_CHAR_EXISTS(self->uid, ch);
+  PYCHAR_CHECK_CHAR_EXISTS(self, ch);
   charSetRace(ch, race);
   charResetBody(ch);
   return 0;
@@ -573,14 +581,14 @@ int PyChar_seton(PyChar *self, PyObject *value, void *closure) {
   }
 
   CHAR_DATA *ch;
-  PYCHAR_CHECK_CHAR_EXISTS(self->uid, ch);
+  PYCHAR_CHECK_CHAR_EXISTS(self, ch);
 
   if (value == Py_None) {
     char_from_furniture(ch);
     return 0;
   }
   else if(PyObj_Check(value)) {
-    OBJ_DATA *obj = propertyTableGet(obj_table, PyObj_AsUid(value));
+    OBJ_DATA *obj = PyObj_AsObj(value);
     if(obj == NULL) {
       PyErr_Format(PyExc_TypeError, 
 		   "Tried to %s's furniture to a nonexistant object.",
@@ -621,7 +629,7 @@ int PyChar_setsex(PyChar *self, PyObject *value, void *closure) {
   }
 
   CHAR_DATA *ch;
-  PYCHAR_CHECK_CHAR_EXISTS(self->uid, ch);
+  PYCHAR_CHECK_CHAR_EXISTS(self, ch);
   charSetSex(ch, sex);
   return 0;
 }
@@ -646,7 +654,7 @@ int PyChar_setposition(PyChar *self, PyObject *value, void *closure) {
   }
 
   CHAR_DATA *ch;
-  PYCHAR_CHECK_CHAR_EXISTS(self->uid, ch);
+  PYCHAR_CHECK_CHAR_EXISTS(self, ch);
   charSetPos(ch, pos);
   // players can't be on furniture if they are standing or flying
   if(poscmp(charGetPos(ch), POS_STANDING) >= 0 && charGetFurniture(ch))
@@ -661,7 +669,7 @@ int PyChar_setroom(PyChar *self, PyObject *value, void *closure) {
   }
 
   CHAR_DATA *ch;
-  PYCHAR_CHECK_CHAR_EXISTS(self->uid, ch);
+  PYCHAR_CHECK_CHAR_EXISTS(self, ch);
 
   ROOM_DATA *room = NULL;
 
@@ -1679,7 +1687,7 @@ PyObject *PyChar_load_mob(PyObject *self, PyObject *args) {
   else if(PyRoom_Check(to))
     room = PyRoom_AsRoom(to);
   else if(PyObj_Check(to))
-    on = propertyTableGet(obj_table, PyObj_AsUid(to));
+    on = PyObj_AsObj(to);
   else {
     PyErr_Format(PyExc_TypeError, 
                     "Load char failed: invalid load-to type.");
@@ -1838,8 +1846,7 @@ PyObject *PyChar_count_mobs(PyObject *self, PyObject *args) {
 
   // if we didn't supply something to look in, assume it means the world
   if(in == NULL)
-    return Py_BuildValue("i", count_chars(NULL, mobile_list, NULL, prototype, 
-					  FALSE));
+    return Py_BuildValue("i", count_live_chars(prototype, NULL));
 
   // see what we're looking in
   if(PyString_Check(in))
@@ -1847,10 +1854,13 @@ PyObject *PyChar_count_mobs(PyObject *self, PyObject *args) {
   else if(PyRoom_Check(in))
     room = PyRoom_AsRoom(in);
   else if(PyObj_Check(in))
-    furniture = propertyTableGet(obj_table, PyObj_AsUid(in));
+    furniture = PyObj_AsObj(in);
+
+  // rooms keep count of who is in them
+  if(room)
+    return Py_BuildValue("i", count_live_chars(prototype, room));
 
   // now find the list we're dealing with
-  if(room)      list = roomGetCharacters(room);
   if(furniture) list = objGetUsers(furniture);
 
   if(list == NULL) {
@@ -2244,7 +2254,16 @@ int PyChar_AsUid(PyObject *ch) {
 }
 
 CHAR_DATA *PyChar_AsChar(PyObject *ch) {
-  return propertyTableGet(mob_table, PyChar_AsUid(ch));
+  PyChar *self = (PyChar *)ch;
+
+  // we only have to look the character up again if something has left the
+  // table since we last did. Otherwise, it must still be in there
+  if(self->ch == NULL ||
+     self->gen != propertyTableGetGeneration(mob_table)) {
+    self->ch = propertyTableGet(mob_table, self->uid);
+    self->gen = propertyTableGetGeneration(mob_table);
+  }
+  return self->ch;
 }
 
 PyObject *
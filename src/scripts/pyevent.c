@@ -12,7 +12,12 @@
 #include <Python.h>
 
 #include "../mud.h"
+#include "../character.h"
+#include "../object.h"
+#include "../room.h"
+#include "../storage.h"
 #include "../event.h"
+#include "../jobs.h"
 
 #include "scripts.h"
 #include "pychar.h"
@@ -52,6 +57,237 @@ void PyEvent_on_complete(void *owner, PyObject *tuple, const char *arg) {
   Py_XDECREF(tuple);
 }
 
+//
+// a job started from Python. Python cannot be run off of the game thread, so
+// only the work functions in jobs.h can be used; Python gets the result
+typedef struct {
+  void *(* work)(void *input);
+  JOB_BYTES *input;
+  PyObject   *func;
+  PyObject   *data;
+} PY_JOB;
+
+void *PyEvent_job_work(void *data) {
+  PY_JOB *job = data;
+  return job->work(job->input);
+}
+
+void PyEvent_job_done(void *data, void *result) {
+  PY_JOB   *job = data;
+  JOB_BYTES *rv = result;
+  PyObject *pyrv = (rv == NULL ? Py_None :
+		    PyString_FromStringAndSize(rv->bytes, rv->len));
+  PyObject  *ret = PyObject_CallFunction(job->func, "OO", job->data, pyrv);
+  if(ret == NULL)
+    log_pyerr("Error finishing Python job");
+  Py_XDECREF(ret);
+  if(rv != NULL) {
+    Py_XDECREF(pyrv);
+    deleteJobBytes(rv);
+  }
+  Py_DECREF(job->func);
+  Py_DECREF(job->data);
+  deleteJobBytes(job->input);
+  free(job);
+}
+
+//
+// Store a piece of python event data. Only simple values, and characters,
+// objects, and rooms (which can be found again by their uid) can be stored.
+// Returns NULL if the value cannot be stored.
+STORAGE_SET *PyEvent_store_value(PyObject *val) {
+  STORAGE_SET *set = new_storage_set();
+  if(val == Py_None)
+    store_string(set, "type", "none");
+  else if(PyBool_Check(val)) {
+    store_string(set, "type", "bool");
+    store_bool  (set, "val",  val == Py_True);
+  }
+  else if(PyInt_Check(val)) {
+    store_string(set, "type", "int");
+    store_long  (set, "val",  PyInt_AsLong(val));
+  }
+  else if(PyFloat_Check(val)) {
+    store_string(set, "type", "float");
+    store_double(set, "val",  PyFloat_AsDouble(val));
+  }
+  else if(PyString_Check(val)) {
+    store_string(set, "type", "str");
+    store_string(set, "val",  PyString_AsString(val));
+  }
+  else if(PyChar_Check(val) && PyChar_AsChar(val) != NULL) {
+    store_string(set, "type", "char");
+    store_int   (set, "val",  PyChar_AsUid(val));
+  }
+  else if(PyObj_Check(val) && PyObj_AsObj(val) != NULL) {
+    store_string(set, "type", "obj");
+    store_int   (set, "val",  PyObj_AsUid(val));
+  }
+  else if(PyRoom_Check(val) && PyRoom_AsRoom(val) != NULL) {
+    store_string(set, "type", "room");
+    store_int   (set, "val",  PyRoom_AsUid(val));
+  }
+  else if(PyTuple_Check(val) || PyList_Check(val)) {
+    STORAGE_SET_LIST *items = new_storage_list();
+    int i, size = PySequence_Size(val);
+    store_string(set, "type", (PyTuple_Check(val) ? "tuple" : "list"));
+    store_list  (set, "items", items);
+    for(i = 0; i < size; i++) {
+      PyObject      *item = PySequence_GetItem(val, i);
+      STORAGE_SET *is_set = PyEvent_store_value(item);
+      Py_DECREF(item);
+      if(is_set == NULL) {
+	storage_close(set);
+	return NULL;
+      }
+      storage_list_put(items, is_set);
+    }
+  }
+  else {
+    storage_close(set);
+    return NULL;
+  }
+  return set;
+}
+
+//
+// The opposite of PyEvent_store_value. Returns a new reference, or NULL if
+// the value refers to something that no longer exists
+PyObject *PyEvent_read_value(STORAGE_SET *set) {
+  const char *type = read_string(set, "type");
+  void      *thing = NULL;
+  if(!strcmp(type, "none"))
+    return Py_BuildValue("");
+  else if(!strcmp(type, "bool"))
+    return PyBool_FromLong(read_bool(set, "val"));
+  else if(!strcmp(type, "int"))
+    return PyInt_FromLong(read_long(set, "val"));
+  else if(!strcmp(type, "float"))
+    return PyFloat_FromDouble(read_double(set, "val"));
+  else if(!strcmp(type, "str"))
+    return PyString_FromString(read_string(set, "val"));
+  else if(!strcmp(type, "char"))
+    return ((thing = propertyTableGet(mob_table, read_int(set, "val"))) ?
+	    charGetPyForm(thing) : NULL);
+  else if(!strcmp(type, "obj"))
+    return ((thing = propertyTableGet(obj_table, read_int(set, "val"))) ?
+	    objGetPyForm(thing) : NULL);
+  else if(!strcmp(type, "room"))
+    return ((thing = propertyTableGet(room_table, read_int(set, "val"))) ?
+	    roomGetPyForm(thing) : NULL);
+  else if(!strcmp(type, "tuple") || !strcmp(type, "list")) {
+    LIST            *vals = newList();
+    STORAGE_SET_LIST *list = read_list(set, "items");
+    STORAGE_SET   *is_set = NULL;
+    PyObject        *item = NULL;
+    PyObject         *seq = NULL;
+    bool               ok = TRUE;
+    while( (is_set = storage_list_next(list)) != NULL) {
+      if((item = PyEvent_read_value(is_set)) == NULL) {
+	ok = FALSE;
+	break;
+      }
+      listQueue(vals, item);
+    }
+
+    if(ok) {
+      int i = 0;
+      seq = (!strcmp(type, "tuple") ? PyTuple_New(listSize(vals)) :
+	     PyList_New(listSize(vals)));
+      while( (item = listPop(vals)) != NULL) {
+	if(PyTuple_Check(seq)) PyTuple_SET_ITEM(seq, i++, item);
+	else                   PyList_SET_ITEM (seq, i++, item);
+      }
+    }
+    deleteListWith(vals, Py_DecRef);
+    return seq;
+  }
+  return NULL;
+}
+
+//
+// Python events can be carried across copyovers if their function can be
+// found again by name in its module, and their data is storable
+STORAGE_SET *PyEvent_store(void *owner, PyObject *tuple) {
+  PyObject *efunc = NULL;
+  PyObject *edata = NULL;
+  char     *otype = NULL;
+  if(!PyArg_ParseTuple(tuple, "sOO", &otype, &efunc, &edata)) {
+    PyErr_Clear();
+    return NULL;
+  }
+
+  // only plain functions can be found again by name. Bound methods, builtins,
+  // and other callables are left behind
+  if(!PyFunction_Check(efunc)) {
+    log_string("Python event calling a %s cannot be carried across copyover.",
+	       efunc->ob_type->tp_name);
+    return NULL;
+  }
+
+  // make sure we can find our function again when we read the event back in
+  PyObject *modname = PyObject_GetAttrString(efunc, "__module__");
+  PyObject     *mod = NULL;
+  char       *fname = PyString_AsString(((PyFunctionObject *)efunc)->func_name);
+  if(modname == NULL || !PyString_Check(modname) ||
+     (mod = PyDict_GetItem(PyImport_GetModuleDict(), modname)) == NULL ||
+     PyDict_GetItemString(PyModule_GetDict(mod), fname) != efunc) {
+    PyErr_Clear();
+    Py_XDECREF(modname);
+    return NULL;
+  }
+
+  STORAGE_SET *data_set = PyEvent_store_value(edata);
+  if(data_set == NULL) {
+    Py_DECREF(modname);
+    return NULL;
+  }
+
+  STORAGE_SET *set = new_storage_set();
+  store_string(set, "otype",  otype);
+  store_string(set, "module", PyString_AsString(modname));
+  store_string(set, "func",   fname);
+  store_set   (set, "data",   data_set);
+  if(!strcasecmp(otype, "char"))
+    store_int(set, "owner", charGetUID(owner));
+  else if(!strcasecmp(otype, "room"))
+    store_int(set, "owner", roomGetUID(owner));
+  else if(!strcasecmp(otype, "obj"))
+    store_int(set, "owner", objGetUID(owner));
+  Py_DECREF(modname);
+  return set;
+}
+
+bool PyEvent_read(STORAGE_SET *set, void **owner, PyObject **tuple) {
+  const char *otype = read_string(set, "otype");
+  PyObject     *mod = PyDict_GetItemString(PyImport_GetModuleDict(),
+					   read_string(set, "module"));
+  PyObject   *efunc = (mod == NULL ? NULL :
+		       PyDict_GetItemString(PyModule_GetDict(mod),
+					    read_string(set, "func")));
+  if(efunc == NULL || !PyFunction_Check(efunc))
+    return FALSE;
+
+  // find our owner again
+  if(!strcasecmp(otype, "char"))
+    *owner = propertyTableGet(mob_table,  read_int(set, "owner"));
+  else if(!strcasecmp(otype, "room"))
+    *owner = propertyTableGet(room_table, read_int(set, "owner"));
+  else if(!strcasecmp(otype, "obj"))
+    *owner = propertyTableGet(obj_table,  read_int(set, "owner"));
+  else
+    *owner = NULL;
+  if(*owner == NULL && strcasecmp(otype, "none"))
+    return FALSE;
+
+  PyObject *edata = PyEvent_read_value(read_set(set, "data"));
+  if(edata == NULL)
+    return FALSE;
+  *tuple = Py_BuildValue("sOO", otype, efunc, edata);
+  Py_DECREF(edata);
+  return TRUE;
+}
+
 
 
 //*****************************************************************************
@@ -139,6 +375,65 @@ PyObject *PyEvent_start_update(PyObject *self, PyObject *args) {
   /* return PyEvent_start(self, args, start_update); */
 }
 
+//
+// start a job on one of the worker threads
+PyObject *PyEvent_start_job(PyObject *self, PyObject *args) {
+  char       *kind = NULL;    // what sort of work we are doing
+  char        *arg = NULL;    // what we are doing the work on
+  int      arg_len = 0;
+  PyObject  *jfunc = NULL;    // the function to call with the result
+  PyObject  *jdata = Py_None; // the data to call it with
+  void *(* work)(void *) = NULL;
+
+  if(!PyArg_ParseTuple(args, "ss#O|O", &kind, &arg, &arg_len, &jfunc, &jdata))
+    return NULL;
+
+  if(!strcasecmp(kind, "read_file"))
+    work = job_read_file;
+  else if(!strcasecmp(kind, "compress"))
+    work = job_compress;
+  else if(!strcasecmp(kind, "decompress"))
+    work = job_decompress;
+  else {
+    PyErr_Format(PyExc_TypeError,
+		 "Job kind must be read_file, compress, or decompress");
+    return NULL;
+  }
+
+  if(!PyFunction_Check(jfunc)) {
+    PyErr_Format(PyExc_TypeError,
+		 "The job handler supplied must be a python function");
+    return NULL;
+  }
+
+  PY_JOB *job = malloc(sizeof(PY_JOB));
+  job->work   = work;
+  job->input  = newJobBytes(arg, arg_len);
+  job->func   = jfunc;
+  job->data   = jdata;
+  Py_INCREF(jfunc);
+  Py_INCREF(jdata);
+  return Py_BuildValue("i", job_start(PyEvent_job_work, PyEvent_job_done,job));
+}
+
+//
+// returns whether a job has yet to have its function called
+PyObject *PyEvent_job_pending(PyObject *self, PyObject *args) {
+  int job = 0;
+  if(!PyArg_ParseTuple(args, "i", &job))
+    return NULL;
+  return Py_BuildValue("i", job_pending(job));
+}
+
+//
+// wait for a job to finish, and call its function now
+PyObject *PyEvent_wait_job(PyObject *self, PyObject *args) {
+  int job = 0;
+  if(!PyArg_ParseTuple(args, "i", &job))
+    return NULL;
+  return Py_BuildValue("i", job_wait(job));
+}
+
 //
 // interrupt an event involving the given room, object, or mobile
 PyObject *PyEvent_interrupt_event(PyObject *self, PyObject *args) {
@@ -183,6 +478,20 @@ PyMethodDef event_module_methods[] = {
   {"interrupt_events_involving",  PyEvent_interrupt_event, METH_VARARGS,
    "interrupt_events_involving(thing)\n\n"
    "Interrupt all events involving a given object, room, or character."},
+  {"start_job",  PyEvent_start_job, METH_VARARGS,
+   "start_job(kind, arg, job_func, data=None)\n\n"
+   "Do some work on a worker thread, and return a number for the job. Kind\n"
+   "can be read_file, to read the file named by arg, or compress or\n"
+   "decompress, to compress or decompress arg with zlib. During the pulse\n"
+   "after the work is done, the job function is called with the data and\n"
+   "the result as a string, or None if the work could not be done." },
+  {"job_pending",  PyEvent_job_pending, METH_VARARGS,
+   "job_pending(job)\n\n"
+   "Return whether the job's function has yet to be called." },
+  {"wait_job",  PyEvent_wait_job, METH_VARARGS,
+   "wait_job(job)\n\n"
+   "Wait for the job to be done, and call its function straight away.\n"
+   "Returns whether the job was still pending." },
   {NULL, NULL, 0, NULL}  /* Sentinel */
 };
 
@@ -194,4 +503,8 @@ PyMethodDef event_module_methods[] = {
 PyMODINIT_FUNC init_PyEvent(void) {
   Py_InitModule3("event", event_module_methods, 
     "The event module handles delayed function calls.");
+
+  // let python events survive copyovers
+  register_event_type("python", PyEvent_on_complete, NULL,
+		      PyEvent_store, PyEvent_read);
 }
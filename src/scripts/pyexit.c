@@ -36,6 +36,10 @@ LIST *pyexit_methods = NULL;
 typedef struct {
   PyObject_HEAD
   int uid;
+  // the exit we wrap. Valid as long as exit_table has the same generation
+  // as when we looked it up
+  EXIT_DATA *exit;
+  unsigned int gen;
 } PyExit;
 
 
@@ -72,6 +76,8 @@ int PyExit_init(PyExit *self, PyObject *args, PyObject *kwds) {
   }
 
   self->uid = uid;
+
+  self->exit = NULL;
   return 0;
 }
 
@@ -198,17 +204,18 @@ PyObject *PyExit_getroom(PyObject *self, void *closure) {
 //
 // Standard check to make sure the exit exists when trying to set a value for 
 // it. If successful, assign the exit to ex. Otherwise, return -1 (error)
-#define PYEXIT_CHECK_EXIT_EXISTS(uid, ex)                                      \
-  ex = propertyTableGet(exit_table, uid);                                      \
+#define PYEXIT_CHECK_EXIT_EXISTS(self, ex)                                     \
+  ex = PyExit_AsExit((PyObject *)self);                                        \
   if(ex == NULL) {                                                             \
     PyErr_Format(PyExc_TypeError,                                              \
-		    "Tried to modify nonexistent exit, %d", uid);              \
+		    "Tried to modify nonexistent exit, %d",                    \
+		    PyExit_AsUid((PyObject *)self));                           \
     return -1;                                                                 \
   }                                                                            
 
 int PyExit_setkey(PyObject *self, PyObject *value, void *closure) {
   EXIT_DATA *ex = NULL;
-  PYEXIT_CHECK_EXIT_EXISTS(PyExit_AsUid(self), ex);
+  PYEXIT_CHECK_EXIT_EXISTS(self, ex);
 
   if(value == NULL || value == Py_None)
     exitSetKey(ex, "");
@@ -238,7 +245,7 @@ int PyExit_setkey(PyObject *self, PyObject *value, void *closure) {
 
 int PyExit_setdest(PyObject *self, PyObject *value, void *closure) {
   EXIT_DATA *ex = NULL;
-  PYEXIT_CHECK_EXIT_EXISTS(PyExit_AsUid(self), ex);
+  PYEXIT_CHECK_EXIT_EXISTS(self, ex);
 
   if(value == NULL || value == Py_None) {
     PyErr_Format(PyExc_StandardError, "Cannot delete an exit %d's destination. "
@@ -269,7 +276,7 @@ int PyExit_setdest(PyObject *self, PyObject *value, void *closure) {
 
 int PyExit_setspotdiff(PyObject *self, PyObject *value, void *closure) {
   EXIT_DATA *ex = NULL;
-  PYEXIT_CHECK_EXIT_EXISTS(PyExit_AsUid(self), ex);
+  PYEXIT_CHECK_EXIT_EXISTS(self, ex);
 
   if(value == NULL || value == Py_None)
     exitSetHidden(ex, 0);
@@ -287,7 +294,7 @@ int PyExit_setspotdiff(PyObject *self, PyObject *value, void *closure) {
 
 int PyExit_setpickdiff(PyObject *self, PyObject *value, void *closure) {
   EXIT_DATA *ex = NULL;
-  PYEXIT_CHECK_EXIT_EXISTS(PyExit_AsUid(self), ex);
+  PYEXIT_CHECK_EXIT_EXISTS(self, ex);
 
   if(value == NULL || value == Py_None)
     exitSetPickLev(ex, 0);
@@ -304,7 +311,7 @@ int PyExit_setpickdiff(PyObject *self, PyObject *value, void *closure) {
 
 int PyExit_setkeywords(PyObject *self, PyObject *value, void *closure) {
   EXIT_DATA *ex = NULL;
-  PYEXIT_CHECK_EXIT_EXISTS(PyExit_AsUid(self), ex);
+  PYEXIT_CHECK_EXIT_EXISTS(self, ex);
 
   if(value == NULL || value == Py_None)
     exitSetKeywords(ex, "");
@@ -322,7 +329,7 @@ int PyExit_setkeywords(PyObject *self, PyObject *value, void *closure) {
 
 int PyExit_setopposite(PyObject *self, PyObject *value, void *closure) {
   EXIT_DATA *ex = NULL;
-  PYEXIT_CHECK_EXIT_EXISTS(PyExit_AsUid(self), ex);
+  PYEXIT_CHECK_EXIT_EXISTS(self, ex);
 
   if(value == NULL || value == Py_None)
     exitSetOpposite(ex, "");
@@ -340,7 +347,7 @@ int PyExit_setopposite(PyObject *self, PyObject *value, void *closure) {
 
 int PyExit_setleavemssg(PyObject *self, PyObject *value, void *closure) {
   EXIT_DATA *ex = NULL;
-  PYEXIT_CHECK_EXIT_EXISTS(PyExit_AsUid(self), ex);
+  PYEXIT_CHECK_EXIT_EXISTS(self, ex);
 
   if(value == NULL || value == Py_None)
     exitSetSpecLeave(ex, "");
@@ -358,7 +365,7 @@ int PyExit_setleavemssg(PyObject *self, PyObject *value, void *closure) {
 
 int PyExit_setentermssg(PyObject *self, PyObject *value, void *closure) {
   EXIT_DATA *ex = NULL;
-  PYEXIT_CHECK_EXIT_EXISTS(PyExit_AsUid(self), ex);
+  PYEXIT_CHECK_EXIT_EXISTS(self, ex);
 
   if(value == NULL || value == Py_None)
     exitSetSpecEnter(ex, "");
@@ -376,7 +383,7 @@ int PyExit_setentermssg(PyObject *self, PyObject *value, void *closure) {
 
 int PyExit_setdesc(PyObject *self, PyObject *value, void *closure) {
   EXIT_DATA *ex = NULL;
-  PYEXIT_CHECK_EXIT_EXISTS(PyExit_AsUid(self), ex);
+  PYEXIT_CHECK_EXIT_EXISTS(self, ex);
 
   if(value == NULL || value == Py_None)
     exitSetDesc(ex, "");
@@ -394,7 +401,7 @@ int PyExit_setdesc(PyObject *self, PyObject *value, void *closure) {
 
 int PyExit_setname(PyObject *self, PyObject *value, void *closure) {
   EXIT_DATA *ex = NULL;
-  PYEXIT_CHECK_EXIT_EXISTS(PyExit_AsUid(self), ex);
+  PYEXIT_CHECK_EXIT_EXISTS(self, ex);
 
   if(value == NULL || value == Py_None)
     exitSetName(ex, "");
@@ -506,7 +513,7 @@ PyObject *PyExit_open(PyExit *self, PyObject *value) {
   exitSetLocked(ex, FALSE);
 
   if(was_closed && exitGetRoom(ex))
-    hookRun("room_change", hookBuildInfo("rm", exitGetRoom(ex)));
+    hookRun("room_change", "rm", exitGetRoom(ex));
 
   return Py_BuildValue("i", 1);
 }
@@ -525,7 +532,7 @@ PyObject *PyExit_close(PyExit *self, PyObject *value) {
   exitSetClosed(ex, TRUE);
 
   if(was_open && exitGetRoom(ex))
-    hookRun("room_change", hookBuildInfo("rm", exitGetRoom(ex)));
+    hookRun("room_change", "rm", exitGetRoom(ex));
 
   return Py_BuildValue("i", 1);
 }
@@ -545,7 +552,7 @@ PyObject *PyExit_lock(PyExit *self, PyObject *value) {
   exitSetLocked(ex, TRUE);
 
   if((was_open || was_unlocked) && exitGetRoom(ex))
-    hookRun("room_change", hookBuildInfo("rm", exitGetRoom(ex)));
+    hookRun("room_change", "rm", exitGetRoom(ex));
 
   return Py_BuildValue("i", 1);
 }
@@ -563,7 +570,7 @@ PyObject *PyExit_unlock(PyExit *self, PyObject *value) {
   exitSetLocked(ex, FALSE);
 
   if(was_locked && exitGetRoom(ex))
-    hookRun("room_change", hookBuildInfo("rm", exitGetRoom(ex)));
+    hookRun("room_change", "rm", exitGetRoom(ex));
 
   return Py_BuildValue("i", 1);
 }
@@ -743,7 +750,16 @@ int PyExit_AsUid(PyObject *exit) {
 }
 
 EXIT_DATA *PyExit_AsExit(PyObject *exit) {
-  return propertyTableGet(exit_table, PyExit_AsUid(exit));
+  PyExit *self = (PyExit *)exit;
+
+  // we only have to look the exit up again if something has left the
+  // table since we last did. Otherwise, it must still be in there
+  if(self->exit == NULL ||
+     self->gen != propertyTableGetGeneration(exit_table)) {
+    self->exit = propertyTableGet(exit_table, self->uid);
+    self->gen = propertyTableGetGeneration(exit_table);
+  }
+  return self->exit;
 }
 
 int PyExit_Check(PyObject *value) {
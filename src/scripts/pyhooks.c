@@ -243,7 +243,7 @@ PyObject *PyHooks_Run(PyObject *self, PyObject *args) {
   }
 
   // run the hook
-  hookRun(type, info);
+  hookRunInfo(type, info);
   return Py_BuildValue("i", 1);
 }
 
@@ -288,12 +288,20 @@ PyObject *PyHooks_Remove(PyObject *self, PyObject *args) {
 }
 
 
+//
+// returns whether there are any Python hooks of the given type
+bool PyHooks_Wants(const char *type) {
+  LIST *list = hashGet(pyhook_table, type);
+  return (list != NULL && listSize(list) > 0);
+}
+
 //
 // monitors hook activity, and handles the ones on the Python end
-void PyHooks_Monitor(const char *type, const char *info) {
+void PyHooks_Monitor(const char *type, HOOK_ARGS *args) {
   LIST *list = hashGet(pyhook_table, type);
-  if(list != NULL) {
-    char *info_dup = strdup(info);
+  if(list != NULL && listSize(list) > 0) {
+    // only turn our args into a string if somebody wants them
+    char *info_dup = strdup(hookArgsInfo(args));
     LIST_ITERATOR *list_i = newListIterator(list);
     PyObject *func = NULL;
     ITERATE_LIST(func, list_i) {
@@ -342,7 +350,7 @@ init_PyHooks(void) {
 
   // set up our hook monitor
   pyhook_table = newHashtable();
-  hookAddMonitor(PyHooks_Monitor);
+  hookAddMonitor(PyHooks_Monitor, PyHooks_Wants);
 }
 
 void PyHooks_addMethod(const char *name, void *f, int flags, const char *doc) {
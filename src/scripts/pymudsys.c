@@ -19,6 +19,8 @@
 #include "../storage.h"
 #include "../world.h"
 #include "../zone.h"
+#include "../parse.h"
+#include "../visibility.h"
 
 #include "pymudsys.h"
 #include "scripts.h"
@@ -568,19 +570,37 @@ PyObject *mudsys_set_password(PyObject *self, PyObject *args) {
 // command name, a sort_by command, the function, a minimum and maximum 
 // position in the form of strings, a level, and boolean values for whether the
 // command can be performed by mobiles, and whether it interrupts actions.
+// Optionally, the syntax (or a list of syntaxes) the command parses its
+// arguments with can be supplied, so it can be compiled ahead of time.
 PyObject *mudsys_add_cmd(PyObject *self, PyObject *args) {
-  PyObject *func = NULL;
+  PyObject *func = NULL, *syntax = Py_None;
   char *name  = NULL, *sort_by = NULL, *group = NULL;
   bool interrupts = FALSE;
+  int i;
 
   // parse all of the values
-  if (!PyArg_ParseTuple(args, "szOsb", &name, &sort_by, &func,
-  			&group, &interrupts)) {
+  if (!PyArg_ParseTuple(args, "szOsb|O", &name, &sort_by, &func,
+  			&group, &interrupts, &syntax)) {
     PyErr_Format(PyExc_TypeError, 
 		 "Could not add new command. Improper arguments supplied");
     return NULL;
   }
 
+  // compile the syntaxes the command uses
+  if(PyString_Check(syntax)) {
+    if(!parse_syntax_register(PyString_AsString(syntax)))
+      log_string("Command '%s', format error in argument parsing: %s", name,
+		 PyString_AsString(syntax));
+  }
+  else if(PyList_Check(syntax)) {
+    for(i = 0; i < PyList_Size(syntax); i++) {
+      PyObject *one = PyList_GetItem(syntax, i);
+      if(PyString_Check(one) && !parse_syntax_register(PyString_AsString(one)))
+	log_string("Command '%s', format error in argument parsing: %s", name,
+		   PyString_AsString(one));
+    }
+  }
+
   // make sure it's a function object, and check its documentation to see if
   // we can add it as a helpfile
   if(PyFunction_Check(func)) {
@@ -922,6 +942,30 @@ PyObject *mudsys_register_exit_cansee(PyObject *self, PyObject *args) {
   return Py_BuildValue("O", Py_None);
 }
 
+PyObject *mudsys_visibility_changed(PyObject *self, PyObject *args) {
+  PyObject *pything = NULL;
+  void       *thing = NULL;
+  if(!PyArg_ParseTuple(args, "O", &pything)) {
+    PyErr_Format(PyExc_TypeError, "A char, obj, or exit must be supplied.");
+    return NULL;
+  }
+
+  if(PyChar_Check(pything))
+    thing = PyChar_AsChar(pything);
+  else if(PyObj_Check(pything))
+    thing = PyObj_AsObj(pything);
+  else if(PyExit_Check(pything))
+    thing = PyExit_AsExit(pything);
+  else {
+    PyErr_Format(PyExc_TypeError, "A char, obj, or exit must be supplied.");
+    return NULL;
+  }
+
+  if(thing != NULL)
+    visibility_changed(thing);
+  return Py_BuildValue("O", Py_None);
+}
+
 
 
 //*****************************************************************************
@@ -1247,14 +1291,17 @@ init_PyMudSys(void) {
 		     "\n"
 		     "Set an account's password.");
   PyMudSys_addMethod("add_cmd", mudsys_add_cmd, METH_VARARGS,
-    "add_cmd(name, shorthand, cmd_func, user_group, interrupts_action)\n"
+    "add_cmd(name, shorthand, cmd_func, user_group, interrupts_action,\n"
+    "        syntax = None)\n"
     "\n"
     "Add a new command to the master command table. If a preferred shorthand\n"
     "exists, e.g., 'n' for 'north', it can be specified. Otherwise, shorthand\n"
     "should be None. Command functions take three arguments: a character\n"
     "issuing the command, the command name, and a string argument supplied\n"
     "to the command. Commands must be tied to a specific user group, and they\n"
-    "can optionally interupt character actions.");
+    "can optionally interupt character actions. If the command parses its\n"
+    "arguments with mud.parse_args, the syntax it uses (or a list of them)\n"
+    "can be supplied so it is compiled, and checked for errors, ahead of time.");
   PyMudSys_addMethod("add_cmd_check", mudsys_add_cmd_check, METH_VARARGS,
     "add_cmd_check(name, check_func)\n"
     "\n"
@@ -1331,6 +1378,12 @@ init_PyMudSys(void) {
     METH_VARARGS, "Same as register_char_cansee for objects.");
   PyMudSys_addMethod("register_exit_cansee", mudsys_register_exit_cansee,
     METH_VARARGS, "Same as register_char_cansee for exits.");
+  PyMudSys_addMethod("visibility_changed", mudsys_visibility_changed,
+    METH_VARARGS,
+   "visibility_changed(thing)\n"
+   "\n"
+   "Tell the mud that something a cansee check looks at has changed for a\n"
+   "char, obj, or exit, so it forgets who could see what this pulse.");
   PyMudSys_addMethod("set_cmd_move", mudsys_set_cmd_move, METH_VARARGS,
     "set_cmd_move(cmd_func)\n"
     "\n"
@@ -20,6 +20,7 @@
 #include "../handler.h"
 #include "../extra_descs.h"
 #include "../prototype.h"
+#include "../population.h"
 
 #include "pyplugs.h"
 #include "scripts.h"
@@ -52,6 +53,10 @@ LIST *pyobj_methods = NULL;
 typedef struct {
   PyObject_HEAD
   int uid;
+  // the object we wrap. Valid as long as obj_table has the same generation
+  // as when we looked it up
+  OBJ_DATA *obj;
+  unsigned int gen;
 } PyObj;
 
 
@@ -90,6 +95,8 @@ int PyObj_init(PyObj *self, PyObject *args, PyObject *kwds) {
   }
 
   self->uid = uid;
+
+  self->obj = NULL;
   return 0;
 }
 
@@ -266,11 +273,12 @@ PyObject *PyObj_getcontainer(PyObj *self, void *closure) {
 // Standard check to make sure the object exists when
 // trying to set a value for it. If successful, assign the
 // object to ch. Otherwise, return -1 (error)
-#define PYOBJ_CHECK_OBJ_EXISTS(uid, obj)                                       \
-  obj = propertyTableGet(obj_table, uid);                                      \
+#define PYOBJ_CHECK_OBJ_EXISTS(self, obj)                                      \
+  obj = PyObj_AsObj((PyObject *)self);                                         \
   if(obj == NULL) {                                                            \
     PyErr_Format(PyExc_TypeError,                                              \
-		    "Tried to modify nonexistant object, %d", uid);            \
+		    "Tried to modify nonexistant object, %d",                  \
+		    PyObj_AsUid((PyObject *)self));                            \
     return -1;                                                                 \
   }                                                                            
 
@@ -287,7 +295,7 @@ int PyObj_setname(PyObj *self, PyObject *value, void *closure) {
   }
 
   OBJ_DATA *obj;
-  PYOBJ_CHECK_OBJ_EXISTS(self->uid, obj);
+  PYOBJ_CHECK_OBJ_EXISTS(self, obj);
   objSetName(obj, PyString_AsString(value));
   return 0;
 }
@@ -305,7 +313,7 @@ int PyObj_setmname(PyObj *self, PyObject *value, void *closure) {
   }
 
   OBJ_DATA *obj;
-  PYOBJ_CHECK_OBJ_EXISTS(self->uid, obj);
+  PYOBJ_CHECK_OBJ_EXISTS(self, obj);
   objSetMultiName(obj, PyString_AsString(value));
   return 0;
 }
@@ -323,7 +331,7 @@ int PyObj_setbits(PyObj *self, PyObject *value, void *closure) {
   }
 
   OBJ_DATA *obj;
-  PYOBJ_CHECK_OBJ_EXISTS(self->uid, obj);
+  PYOBJ_CHECK_OBJ_EXISTS(self, obj);
   bitClear(objGetBits(obj));
   bitSet(objGetBits(obj), PyString_AsString(value));
   return 0;
@@ -342,7 +350,7 @@ int PyObj_setkeywords(PyObj *self, PyObject *value, void *closure) {
   }
 
   OBJ_DATA *obj;
-  PYOBJ_CHECK_OBJ_EXISTS(self->uid, obj);
+  PYOBJ_CHECK_OBJ_EXISTS(self, obj);
 
   // clean up empty keywords, and rebuild it
   LIST           *kwds = parse_keywords(PyString_AsString(value));
@@ -379,7 +387,7 @@ int PyObj_setdesc(PyObj *self, PyObject *value, void *closure) {
   }
 
   OBJ_DATA *obj;
-  PYOBJ_CHECK_OBJ_EXISTS(self->uid, obj);
+  PYOBJ_CHECK_OBJ_EXISTS(self, obj);
   objSetDesc(obj, PyString_AsString(value));
   return 0;
 }
@@ -397,7 +405,7 @@ int PyObj_setrdesc(PyObj *self, PyObject *value, void *closure) {
   }
 
   OBJ_DATA *obj;
-  PYOBJ_CHECK_OBJ_EXISTS(self->uid, obj);
+  PYOBJ_CHECK_OBJ_EXISTS(self, obj);
   objSetRdesc(obj, PyString_AsString(value));
   return 0;
 }
@@ -415,7 +423,7 @@ int PyObj_setmdesc(PyObj *self, PyObject *value, void *closure) {
   }
 
   OBJ_DATA *obj;
-  PYOBJ_CHECK_OBJ_EXISTS(self->uid, obj);
+  PYOBJ_CHECK_OBJ_EXISTS(self, obj);
   objSetMultiRdesc(obj, PyString_AsString(value));
   return 0;
 }
@@ -437,14 +445,14 @@ int PyObj_setweight(PyObj *self, PyObject *value, void *closure) {
   }
 
   OBJ_DATA *obj;
-  PYOBJ_CHECK_OBJ_EXISTS(self->uid, obj);
+  PYOBJ_CHECK_OBJ_EXISTS(self, obj);
   objSetWeightRaw(obj, weight);
   return 0;
 }
 
 int PyObj_sethidden(PyObject *self, PyObject *value, void *closure) {
   OBJ_DATA *obj = NULL;
-  PYOBJ_CHECK_OBJ_EXISTS(PyObj_AsUid(self), obj);
+  PYOBJ_CHECK_OBJ_EXISTS(self, obj);
 
   if(value == NULL || value == Py_None)
     objSetHidden(obj, 0);
@@ -472,7 +480,7 @@ int PyObj_setcarrier(PyObj *self, PyObject *value, void *closure) {
   }
 
   OBJ_DATA *obj;
-  PYOBJ_CHECK_OBJ_EXISTS(self->uid, obj);
+  PYOBJ_CHECK_OBJ_EXISTS(self, obj);
   CHAR_DATA *carrier = PyChar_AsChar(value);
   // remove us from whatever we're currently in
   if(objGetRoom(obj))
@@ -516,7 +524,7 @@ int PyObj_setroom(PyObj *self, PyObject *value, void *closure) {
   }
 
   OBJ_DATA *obj;
-  PYOBJ_CHECK_OBJ_EXISTS(self->uid, obj);
+  PYOBJ_CHECK_OBJ_EXISTS(self, obj);
   // remove us from whatever we're currently in
   if(objGetRoom(obj))
     obj_from_room(obj);
@@ -550,8 +558,8 @@ int PyObj_setcontainer(PyObj *self, PyObject *value, void *closure) {
   }
 
   OBJ_DATA *obj, *cont;
-  PYOBJ_CHECK_OBJ_EXISTS(self->uid, obj);
-  PYOBJ_CHECK_OBJ_EXISTS(((PyObj *)value)->uid, cont);
+  PYOBJ_CHECK_OBJ_EXISTS(self, obj);
+  PYOBJ_CHECK_OBJ_EXISTS(value, cont);
   // remove us from whatever we're currently in
   if(objGetRoom(obj))
     obj_from_room(obj);
@@ -961,9 +969,9 @@ PyObject *PyObj_load_obj(PyObject *self, PyObject *args) {
   else if(PyRoom_Check(in))
     room = PyRoom_AsRoom(in);
   else if(PyObj_Check(in))
-    cont = propertyTableGet(obj_table, PyObj_AsUid(in));
+    cont = PyObj_AsObj(in);
   else if(PyChar_Check(in))
-    ch = propertyTableGet(mob_table, PyChar_AsUid(in));
+    ch = PyChar_AsChar(in);
 
   // make sure a destination exists
   if(room == NULL && cont == NULL && ch == NULL && in != Py_None) {
@@ -1039,8 +1047,7 @@ PyObject *PyObj_count_objs(PyObject *self, PyObject *args) {
 
   // if we didn't supply something to look in, assume it means the world
   if(in == NULL)
-    return Py_BuildValue("i", count_objs(NULL, object_list, NULL, prototype, 
-					 FALSE));
+    return Py_BuildValue("i", count_live_objs(prototype, NULL));
 
   // see what we're looking in
   if(PyString_Check(in))
@@ -1048,12 +1055,15 @@ PyObject *PyObj_count_objs(PyObject *self, PyObject *args) {
   else if(PyRoom_Check(in))
     room = PyRoom_AsRoom(in);
   else if(PyObj_Check(in))
-    cont = propertyTableGet(obj_table, PyObj_AsUid(in));
+    cont = PyObj_AsObj(in);
   else if(PyChar_Check(in))
-    ch   = propertyTableGet(mob_table, PyChar_AsUid(in));
+    ch   = PyChar_AsChar(in);
+
+  // rooms keep count of what is in them
+  if(room)
+    return Py_BuildValue("i", count_live_objs(prototype, room));
 
   // now find the list we're dealing with
-  if(room) list = roomGetContents(room);
   if(cont) list = objGetContents(cont);
   if(ch)   list = charGetInventory(ch);
 
@@ -1090,14 +1100,14 @@ PyObject *PyObj_find_obj(PyObject *self, PyObject *args) {
     else if(PyRoom_Check(in))
       room = PyRoom_AsRoom(in);
     else if(PyObj_Check(in))
-      cont = propertyTableGet(obj_table, PyObj_AsUid(in));
+      cont = PyObj_AsObj(in);
     else if(PyChar_Check(in))
-      ch   = propertyTableGet(mob_table, PyChar_AsUid(in));
+      ch   = PyChar_AsChar(in);
   }
 
   // check to see who's looking
   if(looker && PyChar_Check(looker))
-    looker_ch = propertyTableGet(mob_table, PyChar_AsUid(looker));
+    looker_ch = PyChar_AsChar(looker);
 
   // now find the list we're dealing with
   if(room) list = roomGetContents(room);
@@ -1153,14 +1163,14 @@ PyObject *PyObj_find_obj_key(PyObject *self, PyObject *args) {
     else if(PyRoom_Check(in))
       room = PyRoom_AsRoom(in);
     else if(PyObj_Check(in))
-      cont = propertyTableGet(obj_table, PyObj_AsUid(in));
+      cont = PyObj_AsObj(in);
     else if(PyChar_Check(in))
-      ch   = propertyTableGet(mob_table, PyChar_AsUid(in));
+      ch   = PyChar_AsChar(in);
   }
 
   // check to see who's looking
   if(looker && PyChar_Check(looker))
-    looker_ch = propertyTableGet(mob_table, PyChar_AsUid(looker));
+    looker_ch = PyChar_AsChar(looker);
 
   // now, do the search
   int count = 1;
@@ -1426,7 +1436,16 @@ int PyObj_AsUid(PyObject *obj) {
 }
 
 OBJ_DATA *PyObj_AsObj(PyObject *obj) {
-  return propertyTableGet(obj_table, PyObj_AsUid(obj));
+  PyObj *self = (PyObj *)obj;
+
+  // we only have to look the object up again if something has left the
+  // table since we last did. Otherwise, it must still be in there
+  if(self->obj == NULL ||
+     self->gen != propertyTableGetGeneration(obj_table)) {
+    self->obj = propertyTableGet(obj_table, self->uid);
+    self->gen = propertyTableGetGeneration(obj_table);
+  }
+  return self->obj;
 }
 
 PyObject *
@@ -22,6 +22,7 @@
 #include "../prototype.h"
 #include "../commands.h"
 #include "../hooks.h"
+#include "../path.h"
 
 #include "pyplugs.h"
 #include "scripts.h"
@@ -61,6 +62,10 @@ LIST *pyroom_methods = NULL;
 typedef struct {
   PyObject_HEAD
   int uid;
+  // the room we wrap. Valid as long as room_table has the same generation
+  // as when we looked it up
+  ROOM_DATA *room;
+  unsigned int gen;
 } PyRoom;
 
 
@@ -101,6 +106,8 @@ int PyRoom_init(PyRoom *self, PyObject *args, PyObject *kwds) {
     }
 
     self->uid = uid;
+
+    self->room = NULL;
     return 0;
   }
   else if(PyString_Check(who)) {
@@ -280,15 +287,14 @@ PyObject *PyRoom_getexnames(PyRoom *self, void *closure) {
   if(room == NULL)  return NULL;
 
   PyObject      *list = PyList_New(0);
-  LIST       *ex_list = roomGetExitNames(room);
-  LIST_ITERATOR *ex_i = newListIterator(ex_list);
-  char           *dir = NULL;
-  ITERATE_LIST(dir, ex_i) {
+  const char     *dir = NULL;
+  EXIT_DATA     *exit = NULL;
+  int            ex_i = 0;
+  ITERATE_EXITS(dir, exit, room, ex_i) {
     PyObject    *cont = Py_BuildValue("s", dir);
     PyList_Append(list, cont);
     Py_DECREF(cont);
-  } deleteListIterator(ex_i);
-  deleteListWith(ex_list, free);
+  }
   return list;
 }
 
@@ -340,12 +346,13 @@ PyObject *PyRoom_getbits(PyRoom *self, void *closure) {
 //
 // Standard check to make sure the room exists when trying to set a value for 
 // it. If successful, assign the room to rm. Otherwise, return -1 (error)
-#define PYROOM_CHECK_ROOM_EXISTS(uid, room)			  	\
-  room = propertyTableGet(room_table, uid);				\
-  if(room == NULL) {							\
-    PyErr_Format(PyExc_TypeError,					\
-		 "Tried to modify nonexistent room, %d", uid);		\
-    return -1;                                                          \
+#define PYROOM_CHECK_ROOM_EXISTS(self, room)                                   \
+  room = PyRoom_AsRoom((PyObject *)self);                                      \
+  if(room == NULL) {                                                           \
+    PyErr_Format(PyExc_TypeError,                                              \
+		 "Tried to modify nonexistent room, %d",                       \
+		 PyRoom_AsUid((PyObject *)self));                              \
+    return -1;                                                                 \
   }                                                                            
 
 int PyRoom_setname(PyRoom *self, PyObject *value, void *closure) {
@@ -361,7 +368,7 @@ int PyRoom_setname(PyRoom *self, PyObject *value, void *closure) {
   }
 
   ROOM_DATA *room;
-  PYROOM_CHECK_ROOM_EXISTS(self->uid, room);
+  PYROOM_CHECK_ROOM_EXISTS(self, room);
   roomSetName(room, PyString_AsString(value));
   return 0;
 }
@@ -379,7 +386,7 @@ int PyRoom_setdesc(PyRoom *self, PyObject *value, void *closure) {
   }
 
   ROOM_DATA *room;
-  PYROOM_CHECK_ROOM_EXISTS(self->uid, room);
+  PYROOM_CHECK_ROOM_EXISTS(self, room);
   roomSetDesc(room, PyString_AsString(value));
   return 0;
 }
@@ -403,7 +410,7 @@ int PyRoom_setterrain(PyRoom *self, PyObject *value, void *closure) {
 
 
   ROOM_DATA *room;
-  PYROOM_CHECK_ROOM_EXISTS(self->uid, room);
+  PYROOM_CHECK_ROOM_EXISTS(self, room);
   roomSetTerrain(room, terrainGetNum(PyString_AsString(value)));
   return 0;
 }
@@ -420,7 +427,7 @@ int PyRoom_setbits(PyRoom *self, PyObject *value, void *closure) {
   }
 
   ROOM_DATA *room;
-  PYROOM_CHECK_ROOM_EXISTS(self->uid, room);
+  PYROOM_CHECK_ROOM_EXISTS(self, room);
   bitClear(roomGetBits(room));
   bitSet(roomGetBits(room), PyString_AsString(value));
   return 0;
@@ -481,6 +488,104 @@ PyObject *PyRoom_edesc(PyRoom *self, PyObject *value) {
 }
 
 
+//
+// parses the arguments for finding a path to another room. The destination
+// can be a room or a room key. Returns FALSE and sets an error if they are bad
+bool PyRoom_parse_path_args(PyObject *self, PyObject *args, PyObject *kwds,
+			    ROOM_DATA **from, ROOM_DATA **to, int *flags) {
+  static char *kwlist[] = { "dest", "ignore_doors", "stay_zone", "weighted",
+			    NULL };
+  PyObject *pydest = NULL;
+  bool ignore_doors = TRUE, stay_zone = TRUE, weighted = FALSE;
+
+  if(!PyArg_ParseTupleAndKeywords(args, kwds, "O|bbb", kwlist, &pydest,
+				  &ignore_doors, &stay_zone, &weighted)) {
+    PyErr_Format(PyExc_TypeError, "A destination room must be supplied.");
+    return FALSE;
+  }
+
+  if((*from = PyRoom_AsRoom(self)) == NULL) {
+    PyErr_Format(PyExc_StandardError, "Tried to find path from nonexistent "
+		 "room, %d.", PyRoom_AsUid(self));
+    return FALSE;
+  }
+
+  if(PyRoom_Check(pydest))
+    *to = PyRoom_AsRoom(pydest);
+  else if(PyString_Check(pydest))
+    *to = worldGetRoom(gameworld, 
+		       get_fullkey_relative(PyString_AsString(pydest),
+					    get_key_locale(roomGetClass(*from))));
+  else {
+    PyErr_Format(PyExc_TypeError, "Destination must be a room or room key.");
+    return FALSE;
+  }
+
+  if(*to == NULL) {
+    PyErr_Format(PyExc_StandardError, "Tried to find path to nonexistent "
+		 "room.");
+    return FALSE;
+  }
+
+  *flags = ((ignore_doors ? PATH_IGNORE_DOORS : 0) |
+	    (stay_zone    ? PATH_STAY_ZONE    : 0) |
+	    (weighted     ? PATH_WEIGHTED     : 0));
+  return TRUE;
+}
+
+//
+// returns a list of the rooms passed through to get to another room
+PyObject *PyRoom_path_to(PyObject *self, PyObject *args, PyObject *kwds) {
+  ROOM_DATA *from = NULL, *to = NULL;
+  int flags = 0;
+  if(!PyRoom_parse_path_args(self, args, kwds, &from, &to, &flags))
+    return NULL;
+
+  LIST *path = pathFindRooms(from, to, flags);
+  if(path == NULL)
+    return Py_BuildValue("O", Py_None);
+  PyObject *pypath = PyList_fromList(path, roomGetPyForm);
+  deleteList(path);
+  return pypath;
+}
+
+//
+// returns a list of the directions to take to get to another room
+PyObject *PyRoom_dirs_to(PyObject *self, PyObject *args, PyObject *kwds) {
+  ROOM_DATA *from = NULL, *to = NULL;
+  int flags = 0;
+  if(!PyRoom_parse_path_args(self, args, kwds, &from, &to, &flags))
+    return NULL;
+
+  LIST *dirs = pathFindDirs(from, to, flags);
+  if(dirs == NULL)
+    return Py_BuildValue("O", Py_None);
+  PyObject *pydirs = PyList_New(0);
+  char        *dir = NULL;
+  while((dir = listPop(dirs)) != NULL) {
+    PyObject *pydir = PyString_FromString(dir);
+    PyList_Append(pydirs, pydir);
+    Py_DECREF(pydir);
+    free(dir);
+  }
+  deleteList(dirs);
+  return pydirs;
+}
+
+//
+// returns the first direction to take to get to another room
+PyObject *PyRoom_step_to(PyObject *self, PyObject *args, PyObject *kwds) {
+  ROOM_DATA *from = NULL, *to = NULL;
+  int flags = 0;
+  if(!PyRoom_parse_path_args(self, args, kwds, &from, &to, &flags))
+    return NULL;
+
+  const char *dir = pathStep(from, to, flags);
+  if(dir == NULL)
+    return Py_BuildValue("O", Py_None);
+  return Py_BuildValue("s", dir);
+}
+
 //
 // Get an exit in the room by its direction name
 PyObject *PyRoom_get_exit(PyRoom *self, PyObject *value) {
@@ -974,7 +1079,7 @@ PyObject *PyRoom_reset(PyRoom *self, void *closure) {
 		 self->uid);
     return NULL;
   }
-  hookRun("reset_room", hookBuildInfo("rm", room));
+  hookRun("reset_room", "rm", room);
   return Py_BuildValue("");
 }
 
@@ -1167,6 +1272,26 @@ init_PyRoom(void) {
       "exit(dir)\n"
       "\n"
       "Returns an exit for the specified direction, or None.");
+    PyRoom_addMethod("path_to", PyRoom_path_to, METH_VARARGS | METH_KEYWORDS,
+      "path_to(dest, ignore_doors = True, stay_zone = True, weighted = False)\n"
+      "\n"
+      "Returns a list of the rooms passed through on the shortest path to\n"
+      "dest, including this room and dest, or None if there is no path. Dest\n"
+      "may be a room or a room key. Doors are ignored by default. Otherwise,\n"
+      "locked doors cannot be passed through. If stay_zone is True, the path\n"
+      "never leaves this room's zone. If weighted is True, rough terrain and\n"
+      "closed doors cost more to pass through, and the cheapest path is found\n"
+      "instead of the one with the fewest steps.");
+    PyRoom_addMethod("dirs_to", PyRoom_dirs_to, METH_VARARGS | METH_KEYWORDS,
+      "dirs_to(dest, ignore_doors = True, stay_zone = True, weighted = False)\n"
+      "\n"
+      "Returns a list of the directions to take to get to dest, or None if\n"
+      "there is no path. See path_to.");
+    PyRoom_addMethod("step_to", PyRoom_step_to, METH_VARARGS | METH_KEYWORDS,
+      "step_to(dest, ignore_doors = True, stay_zone = True, weighted = False)\n"
+      "\n"
+      "Returns the first direction to take to get to dest, or None if there\n"
+      "is no path or this room is dest. See path_to.");
     PyRoom_addMethod("exdir", PyRoom_get_exit_dir, METH_VARARGS,
       "exdir(exit)\n"
       "\n"
@@ -1266,7 +1391,16 @@ int PyRoom_AsUid(PyObject *room) {
 }
 
 ROOM_DATA *PyRoom_AsRoom(PyObject *room) {
-  return propertyTableGet(room_table, PyRoom_AsUid(room));
+  PyRoom *self = (PyRoom *)room;
+
+  // we only have to look the room up again if something has left the
+  // table since we last did. Otherwise, it must still be in there
+  if(self->room == NULL ||
+     self->gen != propertyTableGetGeneration(room_table)) {
+    self->room = propertyTableGet(room_table, self->uid);
+    self->gen = propertyTableGetGeneration(room_table);
+  }
+  return self->room;
 }
 
 int PyRoom_Check(PyObject *value) {
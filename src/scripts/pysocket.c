@@ -10,6 +10,7 @@
 #include "../mud.h"
 #include "../utils.h"
 #include "../socket.h"
+#include "../colour.h"
 #include "../character.h"
 
 #include "scripts.h"
@@ -40,6 +41,10 @@ LIST *pysocket_methods = NULL;
 typedef struct {
   PyObject_HEAD
   int uid;
+  // the socket we wrap. Valid as long as sock_table has the same generation
+  // as when we looked it up
+  SOCKET_DATA *sock;
+  unsigned int gen;
 } PySocket;
 
 
@@ -75,6 +80,8 @@ int PySocket_init(PySocket *self, PyObject *args, PyObject *kwds) {
   }
 
   self->uid = uid;
+
+  self->sock = NULL;
   return 0;
 }
 
@@ -159,6 +166,31 @@ int PySocket_set_outbound_text(PySocket *self, PyObject *value, void *closure) {
   }
 }
 
+PyObject *PySocket_get_colour(PySocket *self, void *closure) {
+  SOCKET_DATA *sock = PySocket_AsSocket((PyObject *)self);
+  if(sock == NULL)
+    return NULL;
+  else
+    return Py_BuildValue("i", socketGetColour(sock));
+}
+
+int PySocket_set_colour(PySocket *self, PyObject *value, void *closure) {
+  if(!PyInt_Check(value) || PyInt_AsLong(value) < 0 ||
+     PyInt_AsLong(value) >= NUM_COLOUR_MODES) {
+    PyErr_Format(PyExc_TypeError, "Colour must be mudsock.COLOUR_NONE, "
+		 "mudsock.COLOUR_16, or mudsock.COLOUR_256.");
+    return -1;
+  }
+
+  SOCKET_DATA *sock = PySocket_AsSocket((PyObject *)self);
+  if(sock == NULL)
+    return -1;
+  else {
+    socketSetColour(sock, PyInt_AsLong(value));
+    return 0;
+  }
+}
+
 PyObject *PySocket_get_can_use(PySocket *self, void *closure) {
   SOCKET_DATA *sock = PySocket_AsSocket((PyObject *)self);
   if(sock == NULL)
@@ -464,10 +496,44 @@ PyObject *PySocket_all_sockets(PyObject *self) {
   return retval;
 }
 
+PyObject *PySocket_add_colour(PyObject *self, PyObject *args) {
+  char *code  = NULL;
+  char *ansi  = NULL;
+  char *xterm = NULL;
+  if(!PyArg_ParseTuple(args, "ss|s", &code, &ansi, &xterm))
+    return NULL;
+  if(strlen(code) != 1 || *code == COLOUR_MARKER) {
+    PyErr_Format(PyExc_ValueError, "Colour codes must be one character, and "
+		 "cannot be %c.", COLOUR_MARKER);
+    return NULL;
+  }
+  colourAdd(*code, ansi, xterm);
+  return Py_BuildValue("i", 1);
+}
+
+PyObject *PySocket_remove_colour(PyObject *self, PyObject *args) {
+  char *code = NULL;
+  if(!PyArg_ParseTuple(args, "s", &code))
+    return NULL;
+  if(strlen(code) == 1)
+    colourRemove(*code);
+  return Py_BuildValue("i", 1);
+}
+
 PyMethodDef socket_module_methods[] = {
   { "socket_list", (PyCFunction)PySocket_all_sockets, METH_NOARGS,
     "socket_list()\n\n"
     "Returns a list of all sockets currently connected." },
+  { "add_colour", (PyCFunction)PySocket_add_colour, METH_VARARGS,
+    "add_colour(code, ansi, xterm = None)\n\n"
+    "Adds a new colour code, or changes an existing one. Wherever { followed\n"
+    "by the code appears in outbound text, it is replaced by ansi for sockets\n"
+    "that can display 16 colours, or by xterm for sockets that can display\n"
+    "256 colours or truecolour. If xterm is not supplied, ansi is used for\n"
+    "both. Codes are stripped for sockets that cannot display colour." },
+  { "remove_colour", (PyCFunction)PySocket_remove_colour, METH_VARARGS,
+    "remove_colour(code)\n\n"
+    "Stops expanding the colour code. It will be sent as-is." },
   {NULL, NULL, 0, NULL}  /* Sentinel */
 };
 
@@ -526,6 +592,10 @@ init_PySocket(void) {
     PySocket_addGetSetter("outbound_text",
        PySocket_get_outbound_text, PySocket_set_outbound_text,
        "The socket's outbound text.");
+    PySocket_addGetSetter("colour",
+       PySocket_get_colour, PySocket_set_colour,
+       "What sort of colour the socket can display: mudsock.COLOUR_NONE,\n"
+       "mudsock.COLOUR_16, or mudsock.COLOUR_256.");
     PySocket_addGetSetter("can_use", PySocket_get_can_use, NULL,
       "True or False if the socket is ready for use. Socket becomes available\n"
       "after its dns addresss resolves. Immutable.");
@@ -600,6 +670,11 @@ init_PySocket(void) {
     PyTypeObject *type = &PySocket_Type;
     PyModule_AddObject(module, "Mudsock", (PyObject *)type);
     Py_INCREF(&PySocket_Type);
+
+    // add our colour modes
+    PyModule_AddIntConstant(module, "COLOUR_NONE", COLOUR_NONE);
+    PyModule_AddIntConstant(module, "COLOUR_16",   COLOUR_16);
+    PyModule_AddIntConstant(module, "COLOUR_256",  COLOUR_256);
 }
 
 int PySocket_Check(PyObject *value) {
@@ -611,7 +686,16 @@ int PySocket_AsUid(PyObject *sock) {
 }
 
 SOCKET_DATA *PySocket_AsSocket(PyObject *ch) {
-  return propertyTableGet(sock_table, PySocket_AsUid(ch));
+  PySocket *self = (PySocket *)ch;
+
+  // we only have to look the socket up again if something has left the
+  // table since we last did. Otherwise, it must still be in there
+  if(self->sock == NULL ||
+     self->gen != propertyTableGetGeneration(sock_table)) {
+    self->sock = propertyTableGet(sock_table, self->uid);
+    self->gen = propertyTableGetGeneration(sock_table);
+  }
+  return self->sock;
 }
 
 PyObject *
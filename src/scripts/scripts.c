@@ -49,6 +49,13 @@
 // Python stuff
 #include <compile.h>
 #include <eval.h>
+#include <marshal.h>
+#undef NOP // telnet's NOP collides with python's opcode of the same name
+#include <opcode.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <time.h>
+#include <signal.h>
 
 
 
@@ -62,20 +69,40 @@
 //*****************************************************************************
 // auxiliary data
 //*****************************************************************************
+
+//
+// Hooks check for triggers on everything involved in them, all of the time.
+// Rather than look up each of our trigger keys in the world and compare its
+// type every time, we keep the triggers our keys point to, and a bitmask of
+// their types. The cache is rebuilt whenever triggers are attached, detached,
+// retyped, renamed, or deleted anywhere.
 typedef struct {
-  LIST   *triggers;
-  PyObject *pyform;
+  LIST         *triggers;
+  PyObject       *pyform;
+  LIST      *trig_cache; // the TRIGGER_DATA our keys point to
+  unsigned long   types; // a bit for each type of trigger in our cache
+  unsigned int cache_gen; // what generation of triggers our cache is from
 } TRIGGER_AUX_DATA;
 
+// bumped whenever a cached trigger might no longer be valid
+unsigned int trigger_generation = 1;
+
+// the bit for each type of trigger we've seen
+HASHTABLE *trigger_type_bits = NULL;
+
 TRIGGER_AUX_DATA *newTriggerAuxData(void) {
   TRIGGER_AUX_DATA *data = malloc(sizeof(TRIGGER_AUX_DATA));
   data->triggers         = newList();
   data->pyform           = NULL;
+  data->trig_cache       = NULL;
+  data->types            = 0;
+  data->cache_gen        = 0;
   return data;
 }
 
 void deleteTriggerAuxData(TRIGGER_AUX_DATA *data) {
   deleteListWith(data->triggers, free);
+  if(data->trig_cache) deleteList(data->trig_cache);
   if(data->pyform && data->pyform->ob_refcnt > 1)
     log_string("LEAK: Memory leak (%d refcnt) on someone or something's pyform",
 	       (int)data->pyform->ob_refcnt);
@@ -86,6 +113,7 @@ void deleteTriggerAuxData(TRIGGER_AUX_DATA *data) {
 void triggerAuxDataCopyTo(TRIGGER_AUX_DATA *from, TRIGGER_AUX_DATA *to) {
   deleteListWith(to->triggers, free);
   to->triggers = listCopyWith(from->triggers, strdup);
+  to->cache_gen = 0;
 }
 
 TRIGGER_AUX_DATA *triggerAuxDataCopy(TRIGGER_AUX_DATA *data) {
@@ -102,6 +130,9 @@ TRIGGER_AUX_DATA *triggerAuxDataRead(STORAGE_SET *set) {
   TRIGGER_AUX_DATA *data = malloc(sizeof(TRIGGER_AUX_DATA));
   data->triggers = gen_read_list(read_list(set, "triggers"), read_one_trigger);
   data->pyform   = NULL;
+  data->trig_cache = NULL;
+  data->types      = 0;
+  data->cache_gen  = 0;
   return data;
 }
 
@@ -117,6 +148,47 @@ STORAGE_SET *triggerAuxDataStore(TRIGGER_AUX_DATA *data) {
   return set;
 }
 
+//
+// returns the bit used for the trigger type in our type masks. If there are
+// more types than bits, the extras share the last bit
+unsigned long trigger_type_bit(const char *type) {
+  if(trigger_type_bits == NULL)
+    trigger_type_bits = newHashtable();
+  long num = (long)hashGet(trigger_type_bits, type);
+  if(num == 0) {
+    num = hashSize(trigger_type_bits) + 1;
+    hashPut(trigger_type_bits, type, (void *)num);
+  }
+  if(num > sizeof(unsigned long) * 8)
+    num = sizeof(unsigned long) * 8;
+  return 1UL << (num - 1);
+}
+
+//
+// returns our cached triggers if any of them are of the specified type, and
+// NULL otherwise. Rebuilds the cache if it is out of date
+LIST *triggerAuxGetCache(TRIGGER_AUX_DATA *data, const char *type) {
+  if(listSize(data->triggers) == 0)
+    return NULL;
+  if(data->cache_gen != trigger_generation) {
+    LIST_ITERATOR *key_i = newListIterator(data->triggers);
+    TRIGGER_DATA   *trig = NULL;
+    char            *key = NULL;
+    if(data->trig_cache) deleteList(data->trig_cache);
+    data->trig_cache = newList();
+    data->types      = 0;
+    ITERATE_LIST(key, key_i) {
+      if((trig = worldGetType(gameworld, "trigger", key)) != NULL) {
+	listQueue(data->trig_cache, trig);
+	data->types |= trigger_type_bit(triggerGetType(trig));
+      }
+    } deleteListIterator(key_i);
+    // loading triggers may have changed the generation; we are up to date
+    data->cache_gen = trigger_generation;
+  }
+  return ((data->types & trigger_type_bit(type)) ? data->trig_cache : NULL);
+}
+
 
 
 //*****************************************************************************
@@ -138,10 +210,10 @@ int script_loop_depth   = 0;
 // a local variable used for storing whether or not the last script ran fine
 bool script_ok = TRUE;
 
-void expand_char_dynamic_descs(const char *info) {
+void expand_char_dynamic_descs(HOOK_ARGS *args) {
   CHAR_DATA *me = NULL;
   CHAR_DATA *ch = NULL;
-  hookParseInfo(info, &me, &ch);
+  hookParseArgs(args, &me, &ch);
 
   // if we're an NPC, do some special work for displaying us. We don't do 
   // dynamic descs for PCs because they will probably be describing themselves,
@@ -155,10 +227,10 @@ void expand_char_dynamic_descs(const char *info) {
   }
 }
 
-void  expand_obj_dynamic_descs(const char *info) {
+void  expand_obj_dynamic_descs(HOOK_ARGS *args) {
   OBJ_DATA  *me = NULL;
   CHAR_DATA *ch = NULL;
-  hookParseInfo(info, &me, &ch);
+  hookParseArgs(args, &me, &ch);
 
   PyObject *pyme = objGetPyForm(me);
   char   *locale = strdup(get_key_locale(objGetClass(me))); 
@@ -167,10 +239,10 @@ void  expand_obj_dynamic_descs(const char *info) {
   free(locale);
 }
 
-void expand_room_dynamic_descs(const char *info) {
+void expand_room_dynamic_descs(HOOK_ARGS *args) {
   ROOM_DATA *me = NULL;
   CHAR_DATA *ch = NULL;
-  hookParseInfo(info, &me, &ch);
+  hookParseArgs(args, &me, &ch);
 
   PyObject *pyme = roomGetPyForm(me);
   char   *locale = strdup(get_key_locale(roomGetClass(me))); 
@@ -179,10 +251,10 @@ void expand_room_dynamic_descs(const char *info) {
   free(locale);
 }
 
-void expand_exit_dynamic_descs(const char *info) {
+void expand_exit_dynamic_descs(HOOK_ARGS *args) {
   EXIT_DATA *me = NULL;
   CHAR_DATA *ch = NULL;
-  hookParseInfo(info, &me, &ch);
+  hookParseArgs(args, &me, &ch);
 
   PyObject *pyme = newPyExit(me);
   char   *locale = strdup(get_key_locale(roomGetClass(exitGetRoom(me)))); 
@@ -191,16 +263,542 @@ void expand_exit_dynamic_descs(const char *info) {
   free(locale);
 }
 
+
+
+//*****************************************************************************
+// the script bytecode cache. Compiled prototype and trigger scripts are
+// marshalled to disk, keyed by a hash of their source text and the Python
+// version, so the first run of each script after a reboot or copyover does not
+// have to pay for Py_CompileString.
+//*****************************************************************************
+
+// where we keep our marshalled code objects
+#define SCRIPT_CACHE_DIR   "../lib/misc/scriptcache"
+
+// how many times we have found, or had to compile, a script since boot
+int script_cache_hits   = 0;
+int script_cache_misses = 0;
+
+//
+// returns the name of the cache file for a script. 64-bit FNV-1a hash of the
+// interpreter version, and then the script text itself
+const char *script_cache_fname(const char *script) {
+  static char buf[SMALL_BUFFER];
+  unsigned long long hash = 14695981039346656037ULL;
+  const char         *ptr = NULL;
+  for(ptr = Py_GetVersion(); *ptr; ptr++)
+    hash = (hash ^ (unsigned char)*ptr) * 1099511628211ULL;
+  for(ptr = script; *ptr; ptr++)
+    hash = (hash ^ (unsigned char)*ptr) * 1099511628211ULL;
+  sprintf(buf, "%s/%016llx", SCRIPT_CACHE_DIR, hash);
+  return buf;
+}
+
+//
+// tries to read a code object for the script from our cache. Each entry starts
+// with the import magic number, the length of the source it was compiled
+// from, and then the source itself, so we can reject stale or colliding
+// entries. Returns NULL on a miss.
+PyObject *script_cache_read(const char *script) {
+  FILE *fl = fopen(script_cache_fname(script), "rb");
+  if(fl == NULL)
+    return NULL;
+
+  PyObject *code = NULL;
+  long     magic = 0;
+  long       len = 0;
+  long      size = 0;
+  char      *src = NULL;
+  if(fread(&magic, sizeof(long), 1, fl) == 1 && 
+     fread(&len,   sizeof(long), 1, fl) == 1 &&
+     magic == PyImport_GetMagicNumber() && len == (long)strlen(script) &&
+     (src = malloc(len + 1)) != NULL &&
+     fread(src, 1, len, fl) == len && !memcmp(src, script, len) &&
+     fseek(fl, 0, SEEK_END) == 0 && 
+     (size = ftell(fl) - 2 * sizeof(long) - len) > 0 &&
+     fseek(fl, 2 * sizeof(long) + len, SEEK_SET) == 0) {
+    char *data = malloc(size);
+    if(fread(data, 1, size, fl) == size)
+      code = PyMarshal_ReadObjectFromString(data, size);
+    free(data);
+
+    // a corrupt entry. Forget about it and just compile from scratch
+    if(code != NULL && !PyCode_Check(code)) {
+      Py_DECREF(code);
+      code = NULL;
+    }
+    if(code == NULL)
+      PyErr_Clear();
+  }
+  if(src != NULL)
+    free(src);
+  fclose(fl);
+  return code;
+}
+
+//
+// marshals the script's code object to our cache. The entry is written to a
+// temporary file and then renamed into place, so a crash or another process
+// reading the cache never sees half of an entry
+void script_cache_write(const char *script, PyObject *code) {
+  PyObject *data = PyMarshal_WriteObjectToString(code, Py_MARSHAL_VERSION);
+  if(data == NULL) {
+    PyErr_Clear();
+    return;
+  }
+
+  const char *fname = script_cache_fname(script);
+  char     tmp[SMALL_BUFFER];
+  sprintf(tmp, "%s.%d.tmp", fname, (int)getpid());
+
+  FILE *fl = fopen(tmp, "wb");
+  if(fl != NULL) {
+    long magic = PyImport_GetMagicNumber();
+    long   len = strlen(script);
+    bool    ok = (fwrite(&magic, sizeof(long), 1, fl) == 1 &&
+		  fwrite(&len,   sizeof(long), 1, fl) == 1 &&
+		  fwrite(script, 1, len, fl) == len &&
+		  fwrite(PyString_AsString(data), 1, PyString_Size(data), fl) ==
+		  PyString_Size(data));
+    if(fclose(fl) != 0 || !ok || rename(tmp, fname) != 0)
+      unlink(tmp);
+  }
+  Py_DECREF(data);
+}
+
+PyObject *compile_script_cached(const char *script) {
+  PyObject *code = script_cache_read(script);
+  if(code != NULL)
+    script_cache_hits++;
+  else {
+    script_cache_misses++;
+    code = Py_CompileString(script, "<string>", Py_file_input);
+    if(code != NULL)
+      script_cache_write(script, code);
+  }
+  return code;
+}
+
+void script_cache_forget(const char *script) {
+  if(*script)
+    unlink(script_cache_fname(script));
+}
+
+void script_cache_stats(int *hits, int *misses) {
+  *hits   = script_cache_hits;
+  *misses = script_cache_misses;
+}
+
+//
+// names a script can read without its results depending on anything but "me"
+const char *deterministic_names[] = {
+  "me", "None", "True", "False", "len", "str", "int", "float", "long", "bool",
+  "abs", "min", "max", "round", "range", "xrange", "list", "tuple", "dict",
+  NULL
+};
+
+//
+// go through a code object and every code object nested in it. Record all of
+// the names it reads and sets outside of function locals. Returns FALSE if
+// the code does something we never consider deterministic, like importing
+bool script_scan_names(PyCodeObject *code, PyObject *loaded, PyObject *stored){
+  unsigned char *bytes = (unsigned char *)PyString_AsString(code->co_code);
+  int              len = PyString_Size(code->co_code);
+  int            i, op, arg;
+
+  for(i = 0; i < len; ) {
+    op  = bytes[i];
+    arg = (HAS_ARG(op) && i + 2 < len ? bytes[i+1] + (bytes[i+2] << 8) : 0);
+    i  += (HAS_ARG(op) ? 3 : 1);
+    switch(op) {
+    case IMPORT_NAME:
+    case IMPORT_STAR:
+    case EXEC_STMT:
+      return FALSE;
+    case LOAD_NAME:
+    case LOAD_GLOBAL:
+      PyDict_SetItem(loaded, PyTuple_GET_ITEM(code->co_names, arg), Py_None);
+      break;
+    case STORE_NAME:
+    case STORE_GLOBAL:
+      PyDict_SetItem(stored, PyTuple_GET_ITEM(code->co_names, arg), Py_None);
+      break;
+    default:
+      break;
+    }
+  }
+
+  // functions and classes defined in the script have their own code
+  for(i = 0; i < PyTuple_GET_SIZE(code->co_consts); i++) {
+    PyObject *cnst = PyTuple_GET_ITEM(code->co_consts, i);
+    if(PyCode_Check(cnst) && 
+       !script_scan_names((PyCodeObject *)cnst, loaded, stored))
+      return FALSE;
+  }
+  return TRUE;
+}
+
+bool script_is_deterministic(PyObject *code) {
+  if(code == NULL || !PyCode_Check(code))
+    return FALSE;
+
+  PyObject *loaded = PyDict_New();
+  PyObject *stored = PyDict_New();
+  bool   determ_ok = script_scan_names((PyCodeObject *)code, loaded, stored);
+
+  // everything we read must be something we set ourself, or harmless
+  PyObject *names = PyDict_Keys(loaded);
+  int i, j;
+  for(i = 0; determ_ok && i < PyList_GET_SIZE(names); i++) {
+    PyObject *name = PyList_GET_ITEM(names, i);
+    if(PyDict_GetItem(stored, name) != NULL)
+      continue;
+    for(j = 0; deterministic_names[j] != NULL; j++)
+      if(!strcmp(deterministic_names[j], PyString_AsString(name)))
+	break;
+    if(deterministic_names[j] == NULL)
+      determ_ok = FALSE;
+  }
+
+  Py_DECREF(names);
+  Py_DECREF(loaded);
+  Py_DECREF(stored);
+  return determ_ok;
+}
+
 void finalize_scripts(void) {
   Py_Finalize();
 }
 
-void finalize_scripts_hook(const char *info) {
+void finalize_scripts_hook(HOOK_ARGS *args) {
   finalize_scripts();
 }
 
 
 
+//*****************************************************************************
+// script time limits and accounting
+//
+// Scripts are timed by how much processor time the game's thread has used, so
+// a busy machine, or a script waiting on the disk, does not count against
+// them. While a script runs, a profiling timer is set to go off at its
+// deadline. When it does, we ask the interpreter to call script_timeout the
+// next time it does its periodic checks (the same way it handles signals),
+// which raises a ScriptTimeout in the script if it really is past its
+// deadline. The timer counts the processor time of every thread, so it can go
+// off early; if so, or if the script catches the exception and keeps going,
+// it keeps going off until the script ends. Only the outermost script starts
+// and stops the timer; scripts it sets off share its deadline. How long each
+// script takes is recorded by who ran it, so expensive scripts can be found.
+//*****************************************************************************
+
+// how often we interrupt a script after it has run past its deadline
+#define SCRIPT_RETRY_USEC      50000
+
+// how many of the most expensive scripts scriptusage lists by default
+#define SCRIPT_USAGE_LIST         20
+
+typedef struct {
+  char     *owner;
+  int        runs;
+  int    timeouts;
+  double    total; // in seconds
+  double      max;
+} SCRIPT_USAGE;
+
+// our usage for every script that has run, keyed by owner
+HASHTABLE *script_usage = NULL;
+
+// the exception we raise in scripts that run too long
+PyObject *ScriptTimeout = NULL;
+
+// how many timed scripts are running inside of each other, and the limit the
+// outermost one started with (in milliseconds; 0 or less for none)
+int  script_time_depth = 0;
+int  script_time_limit = 0;
+
+// when the script being run has to stop by
+double script_deadline = 0;
+
+// has the script being run, run out of time?
+bool script_timed_out = FALSE;
+
+double script_clock(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+  return now.tv_sec + now.tv_nsec / 1000000000.0;
+}
+
+void script_usage_add(const char *owner, double secs, bool timed_out) {
+  if(script_usage == NULL)
+    script_usage = newHashtable();
+
+  SCRIPT_USAGE *usage = hashGet(script_usage, owner);
+  if(usage == NULL) {
+    usage        = calloc(1, sizeof(SCRIPT_USAGE));
+    usage->owner = strdup(owner);
+    hashPut(script_usage, owner, usage);
+  }
+  usage->runs++;
+  usage->total += secs;
+  if(secs > usage->max)
+    usage->max = secs;
+  if(timed_out)
+    usage->timeouts++;
+}
+
+void deleteScriptUsage(SCRIPT_USAGE *usage) {
+  free(usage->owner);
+  free(usage);
+}
+
+//
+// sort script usage by the most total time first
+int scriptusagecmp(SCRIPT_USAGE *u1, SCRIPT_USAGE *u2) {
+  return (u1->total > u2->total ? -1 : u1->total < u2->total ? 1 : 0);
+}
+
+//
+// called by the interpreter when it does its periodic checks, after our timer
+// has gone off. Raises a ScriptTimeout if the script has run for too long
+int script_timeout(void *data) {
+  if(script_time_depth > 0 && script_time_limit > 0 &&
+     script_clock() >= script_deadline) {
+    script_timed_out = TRUE;
+    PyErr_SetString(ScriptTimeout, "script ran past its time limit");
+    return -1;
+  }
+  return 0;
+}
+
+//
+// our timer went off. We can't touch the interpreter from a signal handler,
+// so ask it to check the time limit as soon as it safely can
+void script_alarm(int sig) {
+  Py_AddPendingCall(script_timeout, NULL);
+}
+
+//
+// start or stop the timer for the script being run. A limit of 0 stops it
+void script_timer_set(int limit) {
+  struct itimerval timer;
+  memset(&timer, 0, sizeof(timer));
+  if(limit > 0) {
+    timer.it_value.tv_sec     = limit / 1000;
+    timer.it_value.tv_usec    = (limit % 1000) * 1000;
+    timer.it_interval.tv_usec = SCRIPT_RETRY_USEC;
+  }
+  setitimer(ITIMER_PROF, &timer, NULL);
+}
+
+double script_time_start(void) {
+  double start = script_clock();
+  if(script_time_depth++ == 0) {
+    script_timed_out  = FALSE;
+    script_time_limit = mudsettingGetInt("script_time_limit");
+    if(script_time_limit > 0) {
+      script_deadline = start + script_time_limit / 1000.0;
+      script_timer_set(script_time_limit);
+    }
+  }
+  return start;
+}
+
+bool script_time_stop(double start, const char *owner) {
+  bool timed_out = script_timed_out;
+  if(--script_time_depth == 0) {
+    if(script_time_limit > 0)
+      script_timer_set(0);
+    script_timed_out = FALSE;
+  }
+  script_usage_add(owner, script_clock() - start, timed_out);
+  return timed_out;
+}
+
+
+
+//*****************************************************************************
+// garbage collection
+//
+// Left to itself, Python collects garbage whenever enough objects have been
+// allocated, which can be in the middle of anything. Once the game loop is
+// running, we turn that off and collect garbage ourself at the end of pulses
+// that have time left over. A generation is collected when Python would have
+// collected it, as long as it is likely to finish in the time we have. If it
+// has waited too long, it is collected regardless. Like Python, the oldest
+// generation is only collected once the objects that have reached it since
+// its last collection are a quarter of those that survived that collection.
+// Python does not tell us those numbers, so we keep our own estimates from
+// what each collection finds.
+//*****************************************************************************
+
+// a generation that has waited until this many times its threshold is collected
+// whether we have the time for it or not
+#define GC_OVERDUE_FACTOR          4
+
+#define NUM_GC_GENERATIONS         3
+
+typedef struct {
+  int  threshold; // what Python would have collected us at
+  int       runs;
+  int     forced; // collections we had to run without having time for them
+  double   total; // in seconds
+  double     max;
+  double  expect; // how long we expect the next collection to take
+} GC_GENERATION;
+
+GC_GENERATION gc_gens[NUM_GC_GENERATIONS];
+
+// our estimates of how many objects are in the middle generation, how many
+// have moved to the oldest since it was last collected, and how many were in
+// it after that collection
+long gc_middle_size        = 0;
+long gc_long_lived_pending = 0;
+long gc_long_lived_total   = 0;
+
+// Python's gc module. NULL until we take over garbage collection
+PyObject *gc_module = NULL;
+
+//
+// stop Python from collecting garbage on its own, and note when it would have
+void script_gc_take_control(void) {
+  PyObject *thresholds = NULL;
+  int i;
+
+  if((gc_module = PyImport_ImportModule("gc")) == NULL) {
+    log_pyerr("Could not take over Python garbage collection");
+    return;
+  }
+
+  memset(gc_gens, 0, sizeof(gc_gens));
+  thresholds = PyObject_CallMethod(gc_module, "get_threshold", NULL);
+  for(i = 0; i < NUM_GC_GENERATIONS; i++)
+    gc_gens[i].threshold = 
+      MAX(1, PyInt_AsLong(PyTuple_GetItem(thresholds, i)));
+  Py_XDECREF(thresholds);
+  Py_XDECREF(PyObject_CallMethod(gc_module, "disable", NULL));
+  gc_middle_size        = 0;
+  gc_long_lived_pending = 0;
+  gc_long_lived_total   = 0;
+}
+
+//
+// returns whether the generation has reached the point where Python would
+// collect it
+bool script_gc_due(int gen, int *count) {
+  if(count[gen] < gc_gens[gen].threshold)
+    return FALSE;
+  if(gen == NUM_GC_GENERATIONS - 1 &&
+     gc_long_lived_pending < gc_long_lived_total / 4)
+    return FALSE;
+  return TRUE;
+}
+
+double script_gc_pulse(double slack) {
+  PyObject *counts = NULL;
+  int gen, count[NUM_GC_GENERATIONS];
+  bool forced = FALSE;
+
+  if(gc_module == NULL)
+    script_gc_take_control();
+  if(gc_module == NULL || 
+     (counts = PyObject_CallMethod(gc_module, "get_count", NULL)) == NULL)
+    return 0;
+  for(gen = 0; gen < NUM_GC_GENERATIONS; gen++)
+    count[gen] = PyInt_AsLong(PyTuple_GetItem(counts, gen));
+  Py_DECREF(counts);
+
+  // find the oldest generation that is due to be collected
+  for(gen = NUM_GC_GENERATIONS-1; gen >= 0; gen--)
+    if(script_gc_due(gen, count))
+      break;
+  if(gen < 0)
+    return 0;
+
+  // if it's overdue, collect it now. Otherwise, collect the oldest generation
+  // that we have time for. Older ones will wait for a quieter pulse
+  if(count[gen] >= gc_gens[gen].threshold * GC_OVERDUE_FACTOR)
+    forced = (gc_gens[gen].expect > slack);
+  else {
+    while(gen >= 0 && (!script_gc_due(gen, count) ||
+		       gc_gens[gen].expect > slack))
+      gen--;
+    if(gen < 0 && count[0] >= gc_gens[0].threshold * GC_OVERDUE_FACTOR) {
+      gen    = 0;
+      forced = TRUE;
+    }
+    if(gen < 0)
+      return 0;
+  }
+
+  struct timeval start, end;
+  gettimeofday(&start, NULL);
+  PyObject *found = PyObject_CallMethod(gc_module, "collect", "i", gen);
+  gettimeofday(&end, NULL);
+  double pause = ((end.tv_sec - start.tv_sec) +
+		  (end.tv_usec - start.tv_usec) / 1000000.0);
+  long collected = (found && PyInt_Check(found) ? PyInt_AsLong(found) : 0);
+  Py_XDECREF(found);
+  PyErr_Clear();
+
+  // survivors move up a generation. The youngest generation's count is
+  // roughly how many objects are in it
+  long survivors = count[0] - collected;
+  if(gen > 0)
+    survivors   += gc_middle_size;
+  if(gen > 1)
+    survivors   += gc_long_lived_total + gc_long_lived_pending;
+  survivors      = MAX(0, survivors);
+  if(gen == 0)
+    gc_middle_size += survivors;
+  else if(gen == 1) {
+    gc_middle_size         = 0;
+    gc_long_lived_pending += survivors;
+  }
+  else {
+    gc_middle_size        = 0;
+    gc_long_lived_pending = 0;
+    gc_long_lived_total   = survivors;
+  }
+
+  gc_gens[gen].runs++;
+  gc_gens[gen].total += pause;
+  gc_gens[gen].max    = MAX(gc_gens[gen].max, pause);
+  gc_gens[gen].expect = (gc_gens[gen].runs == 1 ? pause :
+			 (gc_gens[gen].expect * 3 + pause) / 4);
+  if(forced)
+    gc_gens[gen].forced++;
+  return pause;
+}
+
+void script_gc_stats(BUFFER *buf) {
+  int gen;
+  if(gc_module == NULL) {
+    bprintf(buf, "Python is collecting its own garbage.\r\n");
+    return;
+  }
+
+  bprintf(buf, "%-18s %8s %8s %10s %8s %8s\r\n", "Python GC", "Runs", 
+	  "Forced", "Total ms", "Avg ms", "Max ms");
+  for(gen = 0; gen < NUM_GC_GENERATIONS; gen++)
+    bprintf(buf, "  generation %-6d %8d %8d %10.1f %8.2f %8.2f\r\n", gen,
+	    gc_gens[gen].runs, gc_gens[gen].forced, gc_gens[gen].total * 1000,
+	    (gc_gens[gen].runs ? gc_gens[gen].total*1000/gc_gens[gen].runs : 0),
+	    gc_gens[gen].max * 1000);
+  bprintf(buf, "Long-lived objects: about %ld, and %ld more since the last "
+	  "full collection\r\n", gc_long_lived_total, gc_long_lived_pending);
+}
+
+void script_gc_stats_clear(void) {
+  int gen;
+  for(gen = 0; gen < NUM_GC_GENERATIONS; gen++) {
+    gc_gens[gen].runs   = gc_gens[gen].forced = 0;
+    gc_gens[gen].total  = gc_gens[gen].max    = 0;
+  }
+}
+
+
+
 //*****************************************************************************
 // player commands
 //*****************************************************************************
@@ -229,6 +827,60 @@ COMMAND(cmd_tstat) {
 }
 
 
+//
+// lists the scripts that have taken up the most time. Usage:
+//   scriptusage [clear | <number to list>]
+COMMAND(cmd_scriptusage) {
+  if(!strcasecmp(arg, "clear")) {
+    if(script_usage != NULL)
+      hashClearWith(script_usage, deleteScriptUsage);
+    send_to_char(ch, "Script usage cleared.\r\n");
+    return;
+  }
+  else if(script_usage == NULL || hashSize(script_usage) == 0) {
+    send_to_char(ch, "No scripts have been run yet.\r\n");
+    return;
+  }
+  else {
+    LIST          *usages = newList();
+    HASH_ITERATOR   *hash_i = newHashIterator(script_usage);
+    LIST_ITERATOR *usage_i = NULL;
+    SCRIPT_USAGE    *usage = NULL;
+    const char        *key = NULL;
+    BUFFER            *buf = newBuffer(MAX_BUFFER);
+    int         to_list = (*arg ? atoi(arg) : SCRIPT_USAGE_LIST);
+    int          listed = 0;
+
+    // sort everything by how much time it has taken up
+    ITERATE_HASH(key, usage, hash_i)
+      listPutWith(usages, usage, scriptusagecmp);
+    deleteHashIterator(hash_i);
+
+    bprintf(buf, "%-40s %6s %10s %8s %8s %5s\r\n", "Script", "Runs",
+	    "Total ms", "Avg ms", "Max ms", "Late");
+    bprintf(buf, "--------------------------------------------------------------------------------\r\n");
+    usage_i = newListIterator(usages);
+    ITERATE_LIST(usage, usage_i) {
+      if(listed++ >= to_list)
+	break;
+      bprintf(buf, "%-40.40s %6d %10.1f %8.2f %8.2f %5d\r\n",
+	      usage->owner, usage->runs, usage->total * 1000,
+	      usage->total * 1000 / usage->runs, usage->max * 1000,
+	      usage->timeouts);
+    } deleteListIterator(usage_i);
+    if(mudsettingGetInt("script_time_limit") > 0)
+      bprintf(buf, "\r\nScripts may run for %d ms before they are stopped.\r\n",
+	      mudsettingGetInt("script_time_limit"));
+    else
+      bprintf(buf, "\r\nScripts may run for as long as they like.\r\n");
+
+    page_string(charGetSocket(ch), bufferString(buf));
+    deleteList(usages);
+    deleteBuffer(buf);
+  }
+}
+
+
 //
 // attach a new trigger to the given instanced object/mobile/room
 COMMAND(cmd_attach) {
@@ -341,9 +993,20 @@ void init_scripts(void) {
   // create our locale stack
   locale_stack = newList();
 
+  // make sure we have somewhere to cache compiled scripts
+  mkdir(SCRIPT_CACHE_DIR, S_IRWXU | S_IRWXG);
+
   // initialize python
   Py_Initialize();
 
+  // raised in scripts that run past their time limit
+  ScriptTimeout = PyErr_NewException("mud.ScriptTimeout", NULL, NULL);
+  struct sigaction alarm_act;
+  memset(&alarm_act, 0, sizeof(alarm_act));
+  alarm_act.sa_handler = script_alarm;
+  alarm_act.sa_flags   = SA_RESTART;
+  sigaction(SIGPROF, &alarm_act, NULL);
+
   // initialize all of our modules written in C
   init_PyMudSys();
   init_PyAuxiliary();
@@ -398,13 +1061,64 @@ void init_scripts(void) {
   add_cmd("tlist",   NULL, cmd_tlist,  "scripter", FALSE);
   add_cmd("tdelete", NULL, cmd_tdelete,"scripter",FALSE);
   add_cmd("trename", NULL, cmd_trename,"scripter", FALSE);
+  add_cmd("scriptusage", NULL, cmd_scriptusage, "admin", FALSE);
+}
+
+//
+// Building a script's dictionary means importing half a dozen modules and
+// merging their contents together. Scripts are run constantly, so we build
+// the merged dictionaries once, and give each script its own copy of them.
+// They are rebuilt if a module is reloaded, or the contents of one of the
+// modules we merge in changes in size (e.g. a pymodule adds a function to
+// the mud module)
+
+// the modules whose contents we merge into our dictionaries
+const char *script_dict_modules[] = {
+  "mud", "char", "room", "obj", "event", NULL
+};
+
+PyObject            *base_script_dict = NULL; // without __builtins__
+PyObject      *restricted_script_base = NULL;
+PyObject    *unrestricted_script_base = NULL;
+PyObject *script_dict_module_dicts[6] = { NULL };
+int      script_dict_module_sizes[6] = { 0 };
+
+void invalidate_script_dicts(void) {
+  int i;
+  Py_XDECREF(base_script_dict);
+  Py_XDECREF(restricted_script_base);
+  Py_XDECREF(unrestricted_script_base);
+  base_script_dict         = NULL;
+  restricted_script_base   = NULL;
+  unrestricted_script_base = NULL;
+  for(i = 0; script_dict_modules[i] != NULL; i++) {
+    Py_XDECREF(script_dict_module_dicts[i]);
+    script_dict_module_dicts[i] = NULL;
+  }
+}
+
+//
+// have any of the modules we merged into our dictionaries changed?
+bool script_dicts_stale(void) {
+  int i;
+  if(base_script_dict == NULL)
+    return TRUE;
+  for(i = 0; script_dict_modules[i] != NULL; i++)
+    if(script_dict_module_dicts[i] != NULL &&
+       PyDict_Size(script_dict_module_dicts[i]) != script_dict_module_sizes[i])
+      return TRUE;
+  return FALSE;
 }
 
 //
 // makes a dictionary with all of the neccessary stuff in it, but without
 // a __builtin__ module set
-PyObject *mud_script_dict(void) {
+PyObject *build_mud_script_dict(void) {
   PyObject* dict = PyDict_New();
+  int i;
+
+  // let scripts catch running out of time
+  PyDict_SetItemString(dict, "ScriptTimeout", ScriptTimeout);
 
   // add the exit() function so people can terminate scripts
   PyObject *sys = PyImport_ImportModule("sys");
@@ -415,57 +1129,227 @@ PyObject *mud_script_dict(void) {
     Py_DECREF(sys);
   }
   
-  // merge all of the mud module contents with our current dict
-  PyObject *mudmod = PyImport_ImportModule("mud");
-  PyDict_Update(dict, PyModule_GetDict(mudmod));
-  Py_DECREF(mudmod);
-  mudmod = PyImport_ImportModule("char");
-  PyDict_Update(dict, PyModule_GetDict(mudmod));
-  Py_DECREF(mudmod);
-  mudmod = PyImport_ImportModule("room");
-  PyDict_Update(dict, PyModule_GetDict(mudmod));
-  Py_DECREF(mudmod);
-  mudmod = PyImport_ImportModule("obj");
-  PyDict_Update(dict, PyModule_GetDict(mudmod));
-  Py_DECREF(mudmod);
-  mudmod = PyImport_ImportModule("event");
-  PyDict_Update(dict, PyModule_GetDict(mudmod));
-  Py_DECREF(mudmod);
-  mudmod = PyImport_ImportModule("random");
-  PyDict_SetItemString(dict, "random", mudmod);
-  Py_DECREF(mudmod);
+  // merge all of the mud module contents with our current dict, and remember
+  // how big they were so we know when we need to rebuild
+  for(i = 0; script_dict_modules[i] != NULL; i++) {
+    PyObject *mudmod = PyImport_ImportModule(script_dict_modules[i]);
+    if(mudmod == NULL) {
+      PyErr_Clear();
+      continue;
+    }
+    PyObject *moddict = PyModule_GetDict(mudmod);
+    PyDict_Update(dict, moddict);
+    Py_INCREF(moddict);
+    script_dict_module_dicts[i] = moddict;
+    script_dict_module_sizes[i] = PyDict_Size(moddict);
+    Py_DECREF(mudmod);
+  }
+  PyObject *mudmod = PyImport_ImportModule("random");
+  if(mudmod != NULL) {
+    PyDict_SetItemString(dict, "random", mudmod);
+    Py_DECREF(mudmod);
+  }
+  else
+    PyErr_Clear();
 
   return dict;
 }
 
-PyObject *restricted_script_dict(void) {
-  // build up our basic dictionary
-  PyObject *dict = mud_script_dict();
-  
-  // add restricted builtin modules
-  PyObject *builtins = PyImport_ImportModule("__restricted_builtin__");
+//
+// make a copy of the base dictionary with the builtins module added
+PyObject *build_script_base(const char *builtin_module) {
+  PyObject *dict = PyDict_Copy(base_script_dict);
+  PyObject *builtins = PyImport_ImportModule(builtin_module);
   if(builtins != NULL) {
     PyDict_SetItemString(dict, "__builtins__", builtins);
     Py_DECREF(builtins);
   }
-
+  else
+    PyErr_Clear();
   return dict;
 }
 
+//
+// make sure our prebuilt dictionaries are up to date
+void prepare_script_dicts(void) {
+  if(script_dicts_stale()) {
+    invalidate_script_dicts();
+    base_script_dict         = build_mud_script_dict();
+    restricted_script_base   = build_script_base("__restricted_builtin__");
+    unrestricted_script_base = build_script_base("__builtin__");
+  }
+}
+
+PyObject *mud_script_dict(void) {
+  prepare_script_dicts();
+  return PyDict_Copy(base_script_dict);
+}
+
+PyObject *restricted_script_dict(void) {
+  prepare_script_dicts();
+  return PyDict_Copy(restricted_script_base);
+}
+
 PyObject *unrestricted_script_dict(void) {
-  PyObject *dict = mud_script_dict();
+  prepare_script_dicts();
+  return PyDict_Copy(unrestricted_script_base);
+}
 
-  // add builtins
-  PyObject *builtins = PyImport_ImportModule("__builtin__");
-  if(builtins != NULL) {
-    PyDict_SetItemString(dict, "__builtins__", builtins);
-    Py_DECREF(builtins);
+//
+// returns how many times obj is in the tuple
+int script_tuple_count(PyObject *tuple, PyObject *obj) {
+  int i, count = 0;
+  if(tuple != NULL)
+    for(i = 0; i < PyTuple_GET_SIZE(tuple); i++)
+      if(PyTuple_GET_ITEM(tuple, i) == obj)
+	count++;
+  return count;
+}
+
+//
+// returns the dictionary of a classic class or a class defined in Python, or
+// NULL if the value is neither
+PyObject *script_class_dict(PyObject *val) {
+  if(PyClass_Check(val))
+    return ((PyClassObject *)val)->cl_dict;
+  if(PyType_Check(val) &&
+     (((PyTypeObject *)val)->tp_flags & Py_TPFLAGS_HEAPTYPE))
+    return ((PyTypeObject *)val)->tp_dict;
+  return NULL;
+}
+
+//
+// returns how many references to a class the classes in the list hold: from
+// their bases and method resolution orders, and from the descriptors Python
+// puts in a new-style class's own dictionary
+int script_class_refs(PyObject *cls, LIST *classes) {
+  LIST_ITERATOR *cls_i = newListIterator(classes);
+  PyObject      *other = NULL;
+  int             refs = 0;
+  ITERATE_LIST(other, cls_i) {
+    if(PyClass_Check(other))
+      refs += script_tuple_count(((PyClassObject *)other)->cl_bases, cls);
+    else {
+      PyTypeObject *type = (PyTypeObject *)other;
+      refs += script_tuple_count(type->tp_bases, cls);
+      refs += script_tuple_count(type->tp_mro,   cls);
+      refs += ((PyObject *)type->tp_base == cls);
+    }
+  } deleteListIterator(cls_i);
+
+  if(PyType_Check(cls)) {
+    PyObject *key = NULL, *val = NULL;
+    Py_ssize_t pos = 0;
+    while(PyDict_Next(((PyTypeObject *)cls)->tp_dict, &pos, &key, &val))
+      if((Py_TYPE(val) == &PyGetSetDescr_Type ||
+	  Py_TYPE(val) == &PyMemberDescr_Type) &&
+	 (PyObject *)((PyDescrObject *)val)->d_type == cls)
+	refs++;
+  }
+  return refs;
+}
+
+//
+// returns whether the class, or any class it inherits from, has methods that
+// look things up in the script dictionary
+bool script_class_uses_dict(PyObject *cls, PyObject *dict) {
+  PyObject *cls_dict = script_class_dict(cls);
+  PyObject *key = NULL, *val = NULL;
+  Py_ssize_t pos = 0;
+  int i;
+  if(cls_dict == NULL)
+    return FALSE;
+  while(PyDict_Next(cls_dict, &pos, &key, &val))
+    if(PyFunction_Check(val) && PyFunction_GetGlobals(val) == dict)
+      return TRUE;
+
+  PyObject *bases = (PyClass_Check(cls) ? ((PyClassObject *)cls)->cl_bases :
+		     ((PyTypeObject *)cls)->tp_bases);
+  for(i = 0; bases != NULL && i < PyTuple_GET_SIZE(bases); i++)
+    if(script_class_uses_dict(PyTuple_GET_ITEM(bases, i), dict))
+      return TRUE;
+  return FALSE;
+}
+
+//
+// returns whether nothing that uses the script dictionary can be reached
+// except through the dictionary itself, so it can safely be emptied. Every
+// reference to the dictionary must be from a function the script defined,
+// found at the top level or in a class. Each of those functions must only be
+// referenced once, by where we found it, and any class with methods that use
+// the dictionary must only be referenced by the dictionary and its own
+// classes. Classes defined by the script that nothing else references are
+// added to unused; new-style ones have cycles of their own to break
+bool script_dict_contained(PyObject *dict, LIST *unused) {
+  LIST      *classes = newList();
+  PyObject      *key = NULL, *val = NULL, *fval = NULL;
+  Py_ssize_t     pos = 0, fpos = 0;
+  int          funcs = 0;
+  bool     contained = TRUE;
+
+  // find the functions that use the dictionary, and the classes they may be in
+  while(contained && PyDict_Next(dict, &pos, &key, &val)) {
+    PyObject *cls_dict = script_class_dict(val);
+    if(PyFunction_Check(val) && PyFunction_GetGlobals(val) == dict) {
+      funcs++;
+      contained = (val->ob_refcnt == 1);
+    }
+    else if(cls_dict != NULL && !listIn(classes, val)) {
+      listQueue(classes, val);
+      for(fpos = 0; contained && PyDict_Next(cls_dict, &fpos, &key, &fval); )
+	if(PyFunction_Check(fval) && PyFunction_GetGlobals(fval) == dict) {
+	  funcs++;
+	  contained = (fval->ob_refcnt == 1);
+	}
+    }
   }
 
-  return dict;
+  // something we did not find, like a lambda handed to an event, or a
+  // generator that has not finished, is using the dictionary
+  if(contained && dict->ob_refcnt != 1 + funcs)
+    contained = FALSE;
+
+  // make sure no class that uses the dictionary is referenced elsewhere, by
+  // an instance, a subclass, or anything else
+  LIST_ITERATOR *cls_i = newListIterator(classes);
+  PyObject        *cls = NULL;
+  ITERATE_LIST(cls, cls_i) {
+    if(!contained)
+      break;
+    int refs = script_class_refs(cls, classes);
+    for(pos = 0; PyDict_Next(dict, &pos, &key, &val); )
+      refs += (val == cls);
+    if(cls->ob_refcnt == refs)
+      listQueue(unused, cls);
+    else if(script_class_uses_dict(cls, dict))
+      contained = FALSE;
+  } deleteListIterator(cls_i);
+
+  deleteList(classes);
+  return contained;
 }
 
-void run_code(PyObject *code, PyObject *dict, const char *locale) {
+void release_script_dict(PyObject *dict) {
+  // functions and classes the script defined hold on to the dictionary as
+  // their globals, while the dictionary holds on to them. If nothing outside
+  // of the dictionary can reach them, empty it to break those cycles now,
+  // instead of waiting for Python's cyclic garbage collector. Otherwise,
+  // something may still need to look things up in it later, and it is left
+  // for the collector
+  LIST *unused = newList();
+  if(script_dict_contained(dict, unused)) {
+    PyObject *cls = NULL;
+    while((cls = listPop(unused)) != NULL)
+      if(PyType_Check(cls))
+	PyType_Type.tp_clear(cls);
+    PyDict_Clear(dict);
+  }
+  deleteList(unused);
+  Py_DECREF(dict);
+}
+
+void run_code(PyObject *code, PyObject *dict, const char *locale,
+	      const char *owner) {
   if(script_loop_depth >= MAX_LOOP_DEPTH) {
     // should we flag some sort of error, here?
     //***********
@@ -475,10 +1359,16 @@ void run_code(PyObject *code, PyObject *dict, const char *locale) {
     script_ok = FALSE;
   }
   else {
+    char   script_owner[SMALL_BUFFER];
     listPush(locale_stack, strdupsafe(locale));
+    if(owner == NULL) {
+      sprintf(script_owner, "script %s", (locale && *locale ? locale : "-"));
+      owner = script_owner;
+    }
 
     // try executing the code
-    script_ok = TRUE;
+    double start = script_time_start();
+    script_ok    = TRUE;
     script_loop_depth++;
     PyObject *retval = PyEval_EvalCode((PyCodeObject *)code, dict, dict);
     script_loop_depth--;
@@ -487,6 +1377,9 @@ void run_code(PyObject *code, PyObject *dict, const char *locale) {
     if(retval == NULL && PyErr_Occurred() != PyExc_SystemExit)
       script_ok = FALSE;
 
+    // record how long we took
+    script_time_stop(start, owner);
+
     // garbage collection
     free(listPop(locale_stack));
     Py_XDECREF(retval);
@@ -500,7 +1393,7 @@ PyObject *run_script_forcode(PyObject *dict, const char *script,
 
   // try running the code
   if(retval != NULL)
-    run_code(retval, dict, locale);
+    run_code(retval, dict, locale, NULL);
   
   // did we end up with an error?
   if(retval == NULL || !last_script_ok())
@@ -529,189 +1422,348 @@ PyObject *eval_script(PyObject *dict, const char *statement,const char *locale){
   return retval;
 }
 
+//*****************************************************************************
+// dynamic descriptions
 //
-// Tries to expand out a conditional statement. Returns whatever is expanded.
-// Moves i to the proper place after the conditional has been expanded in the
-// originating buffer.
-BUFFER *expand_dynamic_conditional(BUFFER *desc,     PyObject *dict, 
-				   PyObject *retval, const char *locale,
-				   int *pos) {
-  BUFFER *new_desc = newBuffer(bufferLength(desc)*2);
-  BUFFER     *code = newBuffer(1); // code we have to evaluate
-  int         j, i = *pos + 1;     // +1 to skip the current closing ]
-  bool       match = PyObject_IsTrue(retval);
-
-  while(TRUE) {
-    // copy over all of our contents for the new desc and increment i
-    while(*(bufferString(desc)+i) &&
-	  !startswith(bufferString(desc)+i, "[else]") &&
-	  !startswith(bufferString(desc)+i, "[elif ") &&
-	  !startswith(bufferString(desc)+i, "[/if]")) {
-      if(match == TRUE)
-	bprintf(new_desc, "%c", *(bufferString(desc) + i));
-      i++;
-    }
+// Descriptions with embedded Python are compiled once into a template: the
+// literal text, and code objects for each expression and conditional. Looking
+// at something only has to run the template. Templates are cached by the exact
+// text they were compiled from, so a description that is edited simply gets a
+// new template the next time it is seen.
+//*****************************************************************************
 
-    // did we terminate?
-    if(match == TRUE || startswith(bufferString(desc)+i, "[/if]"))
-      break;
-    // we haven't had a match yet. Are we trying an else or elif?
-    else if(startswith(bufferString(desc)+i, "[else]")) {
-      match  = TRUE;
-      i     += 6;
+// the types of pieces a template is made of
+#define DYN_DESC_TEXT      0 // literal text
+#define DYN_DESC_EXPR      1 // a Python expression to evaluate
+#define DYN_DESC_IF        2 // an if/elif/else block
+#define DYN_DESC_STOP      3 // the rest of the text could not be parsed
+
+// how many templates we keep around before we start again from scratch
+#define MAX_DYN_DESC_CACHE 2000
+
+typedef struct dyn_desc_data DYN_DESC;
+
+typedef struct {
+  int            type;
+  char          *text; // our literal text, or our expression's source
+  int             len;
+  PyObject      *code;
+  // for conditionals: the condition for each branch (NULL for an else), and
+  // the template to expand if it is the first branch whose condition is true
+  int    num_branches;
+  char    **cond_text;
+  PyObject **cond_code;
+  DYN_DESC     **body;
+} DYN_DESC_NODE;
+
+struct dyn_desc_data {
+  char          *src; // the text we were compiled from
+  DYN_DESC_NODE *nodes;
+  int            num_nodes;
+};
+
+// our compiled templates, keyed by their text
+HASHTABLE *dyn_desc_cache = NULL;
+
+// how many templates are being expanded right now. Templates can be expanded
+// from inside of other templates' code, and we can't remove templates from
+// our cache while they are being used
+int dyn_desc_depth = 0;
+
+DYN_DESC *compile_dyn_desc(const char *txt, int len);
+
+//
+// compile an expression, and log it if it has an error
+PyObject *compile_dyn_desc_code(const char *code) {
+  PyObject *retval = Py_CompileString(code, "<string>", Py_eval_input);
+  if(retval == NULL)
+    log_pyerr("dynamic desc terminated with an error:\r\n%s", code);
+  return retval;
+}
+
+//
+// add a new piece to the template, and return it
+DYN_DESC_NODE *dyn_desc_add(DYN_DESC *desc, int type) {
+  desc->nodes = realloc(desc->nodes, sizeof(DYN_DESC_NODE)*(desc->num_nodes+1));
+  DYN_DESC_NODE *node = desc->nodes + desc->num_nodes++;
+  bzero(node, sizeof(DYN_DESC_NODE));
+  node->type = type;
+  return node;
+}
+
+//
+// add a new branch to a conditional
+void dyn_desc_add_branch(DYN_DESC_NODE *node, const char *cond, 
+			 const char *body, int body_len) {
+  int n = node->num_branches++;
+  node->cond_text = realloc(node->cond_text, sizeof(char *)    * (n + 1));
+  node->cond_code = realloc(node->cond_code, sizeof(PyObject *)* (n + 1));
+  node->body      = realloc(node->body,      sizeof(DYN_DESC *)* (n + 1));
+  node->cond_text[n] = (cond ? strdup(cond) : NULL);
+  node->cond_code[n] = (cond ? compile_dyn_desc_code(cond) : NULL);
+  node->body[n]      = compile_dyn_desc(body, body_len);
+}
+
+//
+// returns where the next [else], [elif, or [/if] marker is in the text
+int dyn_desc_next_branch(const char *txt, int i, int len) {
+  while(i < len && !startswith(txt+i, "[else]") &&
+	!startswith(txt+i, "[elif ") && !startswith(txt+i, "[/if]"))
+    i++;
+  return i;
+}
+
+//
+// returns the position of the first ch in txt between i and len, or -1
+int dyn_desc_find(const char *txt, int i, int len, char ch) {
+  const char *pos = memchr(txt + i, ch, len - i);
+  return (pos == NULL ? -1 : pos - txt);
+}
+
+//
+// compile an if block whose condition has already been read. i is the position
+// of the ] after the condition. Returns the position of the ] closing the
+// block (or the end of the text, if it has no closing [/if])
+int compile_dyn_desc_if(DYN_DESC *desc, const char *cond, const char *txt,
+			int i, int len) {
+  DYN_DESC_NODE *node = dyn_desc_add(desc, DYN_DESC_IF);
+  BUFFER        *code = newBuffer(1);
+  int      body_start = i + 1;
+  int        body_end = dyn_desc_next_branch(txt, body_start, len);
+
+  dyn_desc_add_branch(node, cond, txt + body_start, body_end - body_start);
+  i = body_end;
+  while(i < len && !startswith(txt+i, "[/if]")) {
+    // the else branch
+    if(startswith(txt+i, "[else]")) {
+      body_start = i + 6;
+      body_end   = dyn_desc_next_branch(txt, body_start, len);
+      dyn_desc_add_branch(node, NULL, txt+body_start, body_end-body_start);
+      i = body_end;
     }
-    else if(startswith(bufferString(desc)+i, "[elif ")) {
+    // an elif branch
+    else {
       // skip the elif and spaces
       i += 6;
-      while(isspace(*(bufferString(desc)+i)))
+      while(i < len && isspace(txt[i]))
 	i++;
 
-      // find our end
-      int end = next_letter_in(bufferString(desc) + i, ']');
-
-      // make sure we have it
+      // find our end, and make sure we have it
+      int end = dyn_desc_find(txt, i, len, ']');
       if(end == -1)
 	break;
 
       // copy everything between start and end, and format the code
       bufferClear(code);
-      for(j = 0; j < end; j++)
-	bprintf(code, "%c", *(bufferString(desc) + i + j));
+      bufferCatLength(code, txt + i, end - i);
       bufferReplace(code, "\n", "", TRUE);
 
-      // skip i up to and beyond the ] marker
-      i = i + end + 1;
-      
-      // evaluate the code
-      PyObject *retval = eval_script(dict, bufferString(code), locale);
-      match            = retval && PyObject_IsTrue(retval);
-
-      // did we encounter an error?
-      if(retval == NULL)
-	break;
+      body_start = end + 1;
+      body_end   = dyn_desc_next_branch(txt, body_start, len);
+      dyn_desc_add_branch(node, bufferString(code), txt + body_start,
+			  body_end - body_start);
+      i = body_end;
     }
   }
+  deleteBuffer(code);
 
   // skip everything up to our closing [/if]
-  while(*(bufferString(desc)+i) && !startswith(bufferString(desc)+i, "[/if]"))
+  while(i < len && !startswith(txt+i, "[/if]"))
     i++;
-  if(startswith(bufferString(desc)+i, "[/if]"))
+  if(i < len)
     i += 4; // put us at the closing ], not the end of the ending if block
-
-  // garbage collection
-  deleteBuffer(code);
- 
-  // return our expansion and move our i
-  *pos = i;
-  return new_desc;
+  return i;
 }
 
-void expand_dynamic_descs_dict(BUFFER *desc, PyObject *dict,const char *locale){
-  // make our new buffer
-  BUFFER *new_desc = newBuffer(bufferLength(desc)*2);
-  BUFFER     *code = newBuffer(1); // for things we have to evaluate
-  bool   proc_cond = FALSE; // are we processing a conditional statement?
+DYN_DESC *compile_dyn_desc(const char *txt, int len) {
+  DYN_DESC *desc = calloc(1, sizeof(DYN_DESC));
+  BUFFER   *code = newBuffer(1);
+  int i, start, end;
+  desc->src = strndup(txt, len);
 
-  // copy over all of our description that is not dynamic text
-  int start, end, i, j, size = bufferLength(desc);
-  for(i = 0; i < size; i++) {
+  for(i = 0; i < len; i++) {
     // figure out when our next dynamic desc is.
-    start = next_letter_in(bufferString(desc) + i, '[');
+    start = dyn_desc_find(txt, i, len, '[');
 
-    // no more
+    // no more. The rest is plain text
     if(start == -1) {
-      // copy the rest and skip to the end of the buffer
-      bprintf(new_desc, "%s", bufferString(desc) + i);
-      i = size - 1;
+      DYN_DESC_NODE *node = dyn_desc_add(desc, DYN_DESC_TEXT);
+      node->text = strndup(txt + i, len - i);
+      node->len  = len - i;
+      break;
+    }
+
+    // everything up to start is plain text
+    if(start > i) {
+      DYN_DESC_NODE *node = dyn_desc_add(desc, DYN_DESC_TEXT);
+      node->text = strndup(txt + i, start - i);
+      node->len  = start - i;
+    }
+
+    // find our end, and make sure we have it
+    i   = start + 1;
+    end = dyn_desc_find(txt, i, len, ']');
+    if(end == -1) {
+      dyn_desc_add(desc, DYN_DESC_STOP);
+      break;
+    }
+
+    // copy everything between start and end, and format the code
+    bufferClear(code);
+    bufferCatLength(code, txt + i, end - i);
+    bufferReplace(code, "\n", " ", TRUE);
+    bufferReplace(code, "\r", "", TRUE);
+    i = end;
+
+    // are we compiling a conditional statement?
+    if(!strncasecmp(bufferString(code), "if ", 3)) {
+      const char *cond = bufferString(code) + 3;
+      while(isspace(*cond)) cond++;
+      i = compile_dyn_desc_if(desc, cond, txt, i, len);
     }
-    // we have another desc
     else {
-      // copy everything up to start
-      while(start > 0) {
-	bprintf(new_desc, "%c", *(bufferString(desc) + i));
-	start--;
-	i++;
-      }
+      DYN_DESC_NODE *node = dyn_desc_add(desc, DYN_DESC_EXPR);
+      node->text = strdup(bufferString(code));
+      node->code = compile_dyn_desc_code(node->text);
+    }
+  }
 
-      // skip the start marker
-      i++;
+  deleteBuffer(code);
+  return desc;
+}
 
-      // find our end
-      end = next_letter_in(bufferString(desc) + i, ']');
+void deleteDynDesc(DYN_DESC *desc) {
+  int i, j;
+  for(i = 0; i < desc->num_nodes; i++) {
+    DYN_DESC_NODE *node = desc->nodes + i;
+    if(node->text) free(node->text);
+    Py_XDECREF(node->code);
+    for(j = 0; j < node->num_branches; j++) {
+      if(node->cond_text[j]) free(node->cond_text[j]);
+      Py_XDECREF(node->cond_code[j]);
+      deleteDynDesc(node->body[j]);
+    }
+    if(node->cond_text) free(node->cond_text);
+    if(node->cond_code) free(node->cond_code);
+    if(node->body)      free(node->body);
+  }
+  if(desc->nodes) free(desc->nodes);
+  free(desc->src);
+  free(desc);
+}
 
-      // make sure we have it
-      if(end == -1)
-	break;
+//
+// evaluate one of a template's expressions. Returns a new reference, or NULL
+// if the expression could not be compiled or ran into an error
+PyObject *eval_dyn_desc_code(PyObject *code, const char *src, PyObject *dict,
+			     const char *locale) {
+  if(code == NULL)
+    return NULL;
+  else {
+    listPush(locale_stack, strdupsafe(locale));
+    PyObject *retval = PyEval_EvalCode((PyCodeObject *)code, dict, dict);
+    if(retval == NULL)
+      log_pyerr("dynamic desc terminated with an error:\r\n%s", src);
+    free(listPop(locale_stack));
+    return retval;
+  }
+}
 
-      // copy everything between start and end, and format the code
-      bufferClear(code);
-      for(j = 0; j < end; j++)
-	bprintf(code, "%c", *(bufferString(desc) + i + j));
-      bufferReplace(code, "\n", " ", TRUE);
-      bufferReplace(code, "\r", "", TRUE);
-
-      // skip i up to the end
-      i = i + end;
-
-      // are we trying to process a conditional statement?
-      if(!strncasecmp(bufferString(code), "if ", 3)) {
-	// strip out the leading if and whitespace
-	char *code_copy = strdup(bufferString(code));
-	char       *ptr = code_copy + 3;
-	while(isspace(*ptr)) ptr++;
-	
-	// copy over the cleaned-up code, signal we're processing a conditional
-	bufferClear(code);
-	bufferCat(code, ptr);
-	proc_cond = TRUE;
-
-	// garbage collection
-	free(code_copy);
-      }
+//
+// expand the template onto the end of the buffer. If an expression runs into
+// an error, the rest of the template is not expanded and FALSE is returned
+bool expand_dyn_desc(DYN_DESC *desc, BUFFER *buf, PyObject *dict,
+		     const char *locale) {
+  int i, j;
+  for(i = 0; i < desc->num_nodes; i++) {
+    DYN_DESC_NODE *node = desc->nodes + i;
+    PyObject    *retval = NULL;
+
+    switch(node->type) {
+    case DYN_DESC_TEXT:
+      bufferCatLength(buf, node->text, node->len);
+      break;
 
-      // evaluate the code
-      PyObject *retval = eval_script(dict, bufferString(code), locale);
+    case DYN_DESC_STOP:
+      return FALSE;
 
-      // did we encounter an error?
+    case DYN_DESC_EXPR:
+      retval = eval_dyn_desc_code(node->code, node->text, dict, locale);
       if(retval == NULL)
-	break;
-      // are we evaluating a conditional or no?
-      else if(proc_cond) {
-	BUFFER *cond_retval =
-	  expand_dynamic_conditional(desc, dict, retval, locale, &i);
-
-	// if we have something to print, expand its embedded python
-	if(*bufferString(cond_retval))
-	  expand_dynamic_descs_dict(cond_retval, dict, locale);
-
-	bufferCat(new_desc, bufferString(cond_retval));
-	deleteBuffer(cond_retval);
-	proc_cond = FALSE;
-      }
-      // append the output
+	return FALSE;
       else if(PyString_Check(retval))
-	bprintf(new_desc, "%s", PyString_AsString(retval));
+	bufferCat(buf, PyString_AsString(retval));
       else if(PyInt_Check(retval))
-	bprintf(new_desc, "%ld", PyInt_AsLong(retval));
+	bprintf(buf, "%ld", PyInt_AsLong(retval));
       else if(PyFloat_Check(retval))
-	bprintf(new_desc, "%lf", PyFloat_AsDouble(retval));
+	bprintf(buf, "%lf", PyFloat_AsDouble(retval));
       // invalid return type...
       else if(retval != Py_None)
-	log_string("dynamic desc had invalid evaluation: %s", 
-		   bufferString(code));
+	log_string("dynamic desc had invalid evaluation: %s", node->text);
+      Py_DECREF(retval);
+      break;
 
-      // oddly, freeing retval here corrupt memory. 
-      // And not freeing it doesn't cause a memory leak. So bizarre...
-      //   Py_XDECREF(retval);
+    case DYN_DESC_IF:
+      // find the first branch that is true, and expand it
+      for(j = 0; j < node->num_branches; j++) {
+	bool match = TRUE;
+	if(node->cond_text[j] != NULL) {
+	  retval = eval_dyn_desc_code(node->cond_code[j], node->cond_text[j],
+				      dict, locale);
+	  // an error in the if stops everything. An error in an elif just
+	  // stops the conditional
+	  if(retval == NULL)
+	    return (j == 0 ? FALSE : TRUE);
+	  match = PyObject_IsTrue(retval);
+	  Py_DECREF(retval);
+	}
+	if(match) {
+	  expand_dyn_desc(node->body[j], buf, dict, locale);
+	  break;
+	}
+      }
+      break;
     }
   }
+  return TRUE;
+}
+
+void expand_dynamic_descs_dict(BUFFER *desc, PyObject *dict,const char *locale){
+  // nothing to expand
+  if(strchr(bufferString(desc), '[') == NULL)
+    return;
+
+  if(dyn_desc_cache == NULL)
+    dyn_desc_cache = newHashtableSize(MAX_DYN_DESC_CACHE);
+
+  // find our template. Our cache keys are not case-sensitive, so make sure we
+  // really have the template for this text. If we're being expanded from
+  // inside another template's code, don't change anything another template
+  // might be using
+  DYN_DESC *tmpl = hashGet(dyn_desc_cache, bufferString(desc));
+  bool    cached = TRUE;
+  if(tmpl == NULL || strcmp(tmpl->src, bufferString(desc))) {
+    if(dyn_desc_depth > 0 && tmpl != NULL)
+      cached = FALSE;
+    else if(tmpl != NULL)
+      deleteDynDesc(hashRemove(dyn_desc_cache, bufferString(desc)));
+    else if(dyn_desc_depth == 0 && hashSize(dyn_desc_cache)>=MAX_DYN_DESC_CACHE)
+      hashClearWith(dyn_desc_cache, deleteDynDesc);
+    tmpl = compile_dyn_desc(bufferString(desc), bufferLength(desc));
+    if(cached)
+      hashPut(dyn_desc_cache, bufferString(desc), tmpl);
+  }
 
-  // copy over our contents
+  BUFFER *new_desc = newBuffer(bufferLength(desc)*2);
+  dyn_desc_depth++;
+  expand_dyn_desc(tmpl, new_desc, dict, locale);
+  dyn_desc_depth--;
   bufferCopyTo(new_desc, desc);
 
   // garbage collection
-  deleteBuffer(code);
   deleteBuffer(new_desc);
+  if(!cached)
+    deleteDynDesc(tmpl);
 }
 
 void expand_dynamic_descs(BUFFER *desc, PyObject *me, CHAR_DATA *ch, 
@@ -924,6 +1976,22 @@ void format_script_buffer(BUFFER *script) {
   bufferReplace(script, "\r", "", TRUE);
 }
 
+void trigger_cache_invalidate(void) {
+  trigger_generation++;
+}
+
+LIST *charGetTriggersOfType(CHAR_DATA *ch, const char *type) {
+  return triggerAuxGetCache(charGetAuxiliaryData(ch, "trigger_data"), type);
+}
+
+LIST *objGetTriggersOfType(OBJ_DATA *obj, const char *type) {
+  return triggerAuxGetCache(objGetAuxiliaryData(obj, "trigger_data"), type);
+}
+
+LIST *roomGetTriggersOfType(ROOM_DATA *room, const char *type) {
+  return triggerAuxGetCache(roomGetAuxiliaryData(room, "trigger_data"), type);
+}
+
 LIST *charGetTriggers(CHAR_DATA *ch) {
   TRIGGER_AUX_DATA *data = charGetAuxiliaryData(ch, "trigger_data");
   return data->triggers;
@@ -974,6 +2042,21 @@ PyObject *socketGetPyFormBorrowed(SOCKET_DATA *sock) {
   return data->pyform;
 }
 
+bool charPyFormHeld(CHAR_DATA *ch) {
+  TRIGGER_AUX_DATA *data = charGetAuxiliaryData(ch, "trigger_data");
+  return (data->pyform != NULL && data->pyform->ob_refcnt > 1);
+}
+
+bool roomPyFormHeld(ROOM_DATA *room) {
+  TRIGGER_AUX_DATA *data = roomGetAuxiliaryData(room, "trigger_data");
+  return (data->pyform != NULL && data->pyform->ob_refcnt > 1);
+}
+
+bool objPyFormHeld(OBJ_DATA *obj) {
+  TRIGGER_AUX_DATA *data = objGetAuxiliaryData(obj, "trigger_data");
+  return (data->pyform != NULL && data->pyform->ob_refcnt > 1);
+}
+
 PyObject *charGetPyForm(CHAR_DATA *ch) {
   PyObject *pyform = charGetPyFormBorrowed(ch);
   Py_INCREF(pyform);
@@ -1017,14 +2100,56 @@ PyObject *PyList_fromList(LIST *list, void *convertor) {
   return pylist;
 }
 
+PyObject *PyObject_CallReusingArgs(PyObject **args, PyObject *func,
+				   int nargs, ...) {
+  // take the tuple while we use it, so calls set off by this one make their own
+  PyObject *tuple = *args;
+  *args = NULL;
+  if(tuple == NULL || PyTuple_GET_SIZE(tuple) != nargs) {
+    Py_XDECREF(tuple);
+    tuple = PyTuple_New(nargs);
+  }
+
+  va_list vargs;
+  int i;
+  va_start(vargs, nargs);
+  for(i = 0; i < nargs; i++) {
+    PyObject *arg = va_arg(vargs, PyObject *);
+    Py_INCREF(arg);
+    PyTuple_SET_ITEM(tuple, i, arg);
+  }
+  va_end(vargs);
+
+  PyObject *retval = PyObject_Call(func, tuple, NULL);
+
+  // if the function did not hold on to its arguments, empty the tuple out and
+  // keep it for the next call
+  if(tuple->ob_refcnt == 1 && *args == NULL) {
+    for(i = 0; i < nargs; i++) {
+      PyObject *arg = PyTuple_GET_ITEM(tuple, i);
+      PyTuple_SET_ITEM(tuple, i, NULL);
+      Py_DECREF(arg);
+    }
+    *args = tuple;
+  }
+  else
+    Py_DECREF(tuple);
+  return retval;
+}
+
 void triggerListAdd(LIST *list, const char *trigger) {
-  if(!listGetWith(list, trigger, strcasecmp))
+  if(!listGetWith(list, trigger, strcasecmp)) {
     listPut(list, strdup(trigger));
+    trigger_cache_invalidate();
+  }
 }
 
 void triggerListRemove(LIST *list, const char *trigger) {
   char *val = listRemoveWith(list, trigger, strcasecmp);
-  if(val) free(val);
+  if(val) {
+    free(val);
+    trigger_cache_invalidate();
+  }
 }
 
 
@@ -80,6 +80,18 @@ LIST *charGetTriggers(CHAR_DATA *ch);
 LIST *objGetTriggers (OBJ_DATA  *obj);
 LIST *roomGetTriggers(ROOM_DATA *room);
 
+//
+// If any of the triggers attached to the thing are of the specified type,
+// returns a list of all the triggers attached to it (not just the ones of that
+// type). Otherwise, returns NULL. The list is cached, and must not be deleted
+// or changed. Any changes to the triggers themselves, or to a list of trigger
+// keys not made with triggerListAdd or triggerListRemove, must be followed by
+// a call to trigger_cache_invalidate.
+LIST  *charGetTriggersOfType(CHAR_DATA *ch,   const char *type);
+LIST   *objGetTriggersOfType(OBJ_DATA  *obj,  const char *type);
+LIST  *roomGetTriggersOfType(ROOM_DATA *room, const char *type);
+void trigger_cache_invalidate(void);
+
 //
 // get the python form for a character, object, or room. These are persistent
 // from the first time the python form is created. Before the pyform is 
@@ -100,6 +112,13 @@ PyObject     *objGetPyFormBorrowed(OBJ_DATA     *obj);
 PyObject  *socketGetPyFormBorrowed(SOCKET_DATA  *sock);
 PyObject *accountGetPyFormBorrowed(ACCOUNT_DATA *acc);
 
+//
+// returns whether anything besides the character, object, or room itself is
+// holding on to its python form, e.g. a script that has stored it away
+bool         charPyFormHeld(CHAR_DATA    *ch);
+bool         roomPyFormHeld(ROOM_DATA    *room);
+bool          objPyFormHeld(OBJ_DATA     *obj);
+
 //
 // the generic function for parsing a function keyword list and running a 
 // things's triggers from the arguments supplied. See documentation in
@@ -111,6 +130,15 @@ PyObject *py_gen_do_trigs(PyObject *self, PyObject *args, PyObject *kwds);
 // returns a Python form of the given list
 PyObject *PyList_fromList(LIST *list, void *convertor);
 
+//
+// calls a Python function with nargs arguments, all of them PyObjects, and
+// returns a new reference to its result. The argument tuple is kept in *args
+// between calls and reused, so calls that happen very often (commands, checks,
+// input handlers) do not have to build a new one each time. Each place that
+// makes such calls should have its own *args, initially NULL.
+PyObject *PyObject_CallReusingArgs(PyObject **args, PyObject *func,
+				   int nargs, ...);
+
 //
 // adds a trigger to the trigger list. Makes sure it's not a duplicate copy
 void triggerListAdd(LIST *list, const char *trigger);
@@ -143,6 +171,19 @@ bool trigger_list_parser (SOCKET_DATA *sock, LIST *triggers, int choice,
 PyObject   *restricted_script_dict(void);
 PyObject *unrestricted_script_dict(void);
 
+//
+// The modules merged into script dictionaries are only imported once, and the
+// dictionaries are copied from that. If a module that scripts use has been
+// reloaded, the prebuilt dictionaries must be thrown out.
+void invalidate_script_dicts(void);
+
+//
+// delete a dictionary made by one of the functions above, after the script
+// using it has been run. If nothing the script defined can be reached from
+// outside of the dictionary, it is emptied so the functions and classes in it
+// do not keep it alive. Otherwise it is left alone for Python to collect.
+void release_script_dict(PyObject *dict);
+
 //
 // Runs an arbitrary block of python code using the given dictionary. If the
 // script has a locale (i.e. zone) associated with it (for instance, running
@@ -155,11 +196,75 @@ void run_script(PyObject *dict, const char *script, const char *locale);
 PyObject *run_script_forcode(PyObject *dict, const char *script, 
 			     const char *locale);
 
+//
+// compiles a script into a code object, without running it. Prototypes and
+// triggers are compiled through here; their code is marshalled to a cache on
+// disk, keyed by a hash of the script's text and the Python version, and
+// reloaded from there instead of recompiled after a reboot or copyover.
+// Returns a new reference, or NULL (with the Python error set) if the script
+// does not compile.
+PyObject *compile_script_cached(const char *script);
+
+//
+// removes the cached code object for a script, if one exists. Called whenever
+// a prototype or trigger has its script replaced.
+void script_cache_forget(const char *script);
+
+//
+// how many compiled scripts have been found in, or missing from, the cache
+// since the mud booted
+void script_cache_stats(int *hits, int *misses);
+
+//
+// returns TRUE if the outcome of running a compiled script can only depend on
+// "me": it imports nothing, and reads no variables except ones it sets itself,
+// "me", and a few harmless builtins. Anything that touches random, the game
+// world, or other modules is not deterministic.
+bool script_is_deterministic(PyObject *code);
+
 //
 // runs a python code object wit hthe given dictionary. If the script has a 
 // locale (i.e. zone) associated with it (for instance, running code for a mob
-// proto) locale can be set. Otherwise, locale should be NULL.
-void run_code(PyObject *code, PyObject *dict, const char *locale);
+// proto) locale can be set. Otherwise, locale should be NULL. The time the
+// code takes to run is recorded under owner (e.g. "trigger bell@examples"). If
+// owner is NULL, it is recorded as a script run in the locale.
+//
+// Scripts are only allowed to use as much processor time as the
+// script_time_limit mud setting (in milliseconds) allows, including any other
+// scripts they set off. After that, a ScriptTimeout exception is raised in
+// them. A limit of 0 or less means scripts can run for as long as they like.
+void run_code(PyObject *code, PyObject *dict, const char *locale,
+	      const char *owner);
+
+//
+// returns how much processor time the game has used, in seconds, for timing
+// scripts with
+double script_clock(void);
+
+//
+// start timing a script, Python command check, etc... against the time limit
+// described for run_code, and return when it started. Every call must be
+// matched by a call to script_time_stop, which records how long it took under
+// owner, and returns whether it ran out of time
+double script_time_start(void);
+bool   script_time_stop (double start, const char *owner);
+
+//
+// add to the time recorded for a script, Python command, etc... See run_code
+void script_usage_add(const char *owner, double secs, bool timed_out);
+
+//
+// Python's garbage is collected by the game loop, when it has time left over
+// at the end of a pulse. The first call turns off Python's own collection.
+// Each call runs the collection that is due, if it is likely to take less than
+// slack seconds, or if it has been put off for too long. Returns how many
+// seconds were spent collecting.
+double script_gc_pulse(double slack);
+
+//
+// append statistics on garbage collections to the buffer, or clear them
+void script_gc_stats(BUFFER *buf);
+void script_gc_stats_clear(void);
 
 //
 // Evaluates a Python statement. If the statement has a locale (i.e. a zone)
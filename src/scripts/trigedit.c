@@ -67,10 +67,12 @@ bool trigger_list_parser(SOCKET_DATA *sock, LIST *triggers, int choice,
   case TRIGLIST_NEW:
     if(!listGetWith(triggers, arg, strcasecmp))
       listPutWith(triggers, strdup(arg), strcasecmp);
+    trigger_cache_invalidate();
     return TRUE;
   case TRIGLIST_DELETE: {
     char *found = listRemoveWith(triggers, arg, strcasecmp);
     if(found) free(found);
+    trigger_cache_invalidate();
     return TRUE;
   }
   default: return FALSE;
@@ -43,6 +43,7 @@ TRIGGER_DATA  *newTrigger(void) {
 }
 
 void deleteTrigger(TRIGGER_DATA *trigger) {
+  trigger_cache_invalidate();
   if(trigger->name) free(trigger->name);
   if(trigger->type) free(trigger->type);
   if(trigger->key)  free(trigger->key);
@@ -88,14 +89,19 @@ void triggerSetName(TRIGGER_DATA *trigger, const char *name) {
 void triggerSetType(TRIGGER_DATA *trigger, const char *type) {
   if(trigger->type) free(trigger->type);
   trigger->type = strdupsafe(type);
+  trigger_cache_invalidate();
 }
 
 void triggerSetKey(TRIGGER_DATA *trigger, const char *key) {
   if(trigger->key) free(trigger->key);
   trigger->key = strdupsafe(key);
+  trigger_cache_invalidate();
 }
 
 void triggerSetCode(TRIGGER_DATA *trigger, const char *code) {
+  // our old compiled code is no longer any good
+  if(strcmp(bufferString(trigger->code), code))
+    script_cache_forget(bufferString(trigger->code));
   bufferClear(trigger->code);
   bufferCat(trigger->code, code);
   Py_XDECREF(trigger->pycode);
@@ -123,13 +129,20 @@ BUFFER *triggerGetCodeBuffer(TRIGGER_DATA *trigger) {
 }
 
 void triggerRun(TRIGGER_DATA *trigger, PyObject *dict) {
-  // if we haven't yet run the trigger, compile the source code
+  // if we haven't yet run the trigger, get its code. Compiled code is cached
+  // on disk, so this is usually just a read
   if(trigger->pycode == NULL)
-    trigger->pycode = run_script_forcode(dict, bufferString(trigger->code),
-					 get_key_locale(triggerGetKey(trigger)));
+    trigger->pycode = compile_script_cached(bufferString(trigger->code));
+
   // run right from the code
+  if(trigger->pycode == NULL)
+    log_pyerr("Trigger %s failed to compile:\r\n%s",
+	      trigger->key, bufferString(trigger->code));
   else {
-    run_code(trigger->pycode, dict, get_key_locale(triggerGetKey(trigger)));
+    char owner[SMALL_BUFFER];
+    sprintf(owner, "trigger %s", trigger->key);
+    run_code(trigger->pycode, dict, get_key_locale(triggerGetKey(trigger)),
+	     owner);
 
     if(!last_script_ok())
       log_pyerr("Trigger %s terminated with an error:\r\n%s",
@@ -81,42 +81,35 @@ void gen_do_trig(TRIGGER_DATA *trig,
 		 const char *arg, LIST *optional) {
   // make our basic dictionary, and fill it up with these new variables
   PyObject *dict = restricted_script_dict();
-  LIST *varnames = newList(); 
   // now, import all of our variables
   if(command) {
     PyObject *pycmd = PyString_FromString(command);
     PyDict_SetItemString(dict, "cmd", pycmd);
-    listPut(varnames, strdup("cmd"));
     Py_DECREF(pycmd);
   }
   if(arg) {
     PyObject *pyarg = PyString_FromString(arg);
     PyDict_SetItemString(dict, "arg", pyarg);
-    listPut(varnames, strdup("arg"));
     Py_DECREF(pyarg);
   }
   if(ch) {
     PyObject *pych = charGetPyForm(ch);
     PyDict_SetItemString(dict, "ch", pych);
-    listPut(varnames, strdup("ch"));
     Py_DECREF(pych);
   }
   if(room) {
     PyObject *pyroom = roomGetPyForm(room);
     PyDict_SetItemString(dict, "room", pyroom);
-    listPut(varnames, strdup("room"));
     Py_DECREF(pyroom);
   }    
   if(obj) {
     PyObject *pyobj = objGetPyForm(obj);
     PyDict_SetItemString(dict, "obj", pyobj);
-    listPut(varnames, strdup("obj"));
     Py_DECREF(pyobj);
   }
   if(exit) {
     PyObject *pyexit = newPyExit(exit);
     PyDict_SetItemString(dict, "ex", pyexit);
-    listPut(varnames, strdup("ex"));
     Py_DECREF(pyexit);
   }
 
@@ -129,7 +122,6 @@ void gen_do_trig(TRIGGER_DATA *trig,
     case TRIGVAR_ROOM:  pyme = roomGetPyForm(me); break;
     }
     PyDict_SetItemString(dict, "me", pyme);
-    listPut(varnames, strdup("me"));
     Py_DECREF(pyme);
   }
 
@@ -146,25 +138,25 @@ void gen_do_trig(TRIGGER_DATA *trig,
       case TRIGVAR_ROOM:  pyopt = roomGetPyForm(opt->data); break;
       }
       PyDict_SetItemString(dict, opt->name, pyopt);
-      listPut(varnames, strdup(opt->name));
       Py_XDECREF(pyopt);
     } deleteListIterator(opt_i);
   }
 
   // run the script, then kill our dictionary
   triggerRun(trig, dict);
+  release_script_dict(dict);
+}
 
-  // if triggers create methods, it increases the reference count on our
-  // dictionary. This is a known memory leak. We'll try to mitigate it by
-  // cleaning out some of the contents. A better solution is needed, that
-  // makes sure the dictionary itself is not leaked
-  LIST_ITERATOR *vname_i = newListIterator(varnames);
-  char            *vname = NULL;
-  ITERATE_LIST(vname, vname_i) {
-    PyDict_DelItemString(dict, vname);
-  } deleteListIterator(vname_i);
-  deleteListWith(varnames, free);
-  Py_XDECREF(dict);
+//
+// returns the triggers attached to the thing, if it has any of the type
+LIST *get_trigs_of_type(void *me, int me_type, const char *type) {
+  if(me_type == TRIGVAR_CHAR)
+    return charGetTriggersOfType(me, type);
+  else if(me_type == TRIGVAR_OBJ)
+    return objGetTriggersOfType(me, type);
+  else if(me_type == TRIGVAR_ROOM)
+    return roomGetTriggersOfType(me, type);
+  return NULL;
 }
 
 //
@@ -172,37 +164,37 @@ void gen_do_trig(TRIGGER_DATA *trig,
 void gen_do_trigs(void *me, int me_type, const char *type,
 		  CHAR_DATA *ch,OBJ_DATA *obj, ROOM_DATA *room, EXIT_DATA *exit,
 		  const char *command, const char *arg, LIST *optional) {
-  // find our list of triggers
-  LIST *trig_keys = NULL;
-  if(me_type == TRIGVAR_CHAR)
-    trig_keys = charGetTriggers(me);
-  else if(me_type == TRIGVAR_OBJ)
-    trig_keys = objGetTriggers(me);
-  else if(me_type == TRIGVAR_ROOM)
-    trig_keys = roomGetTriggers(me);
-
-  if(trig_keys == NULL || listSize(trig_keys) == 0)
+  // find our list of triggers, if we have any of the right type
+  LIST *trigs = get_trigs_of_type(me, me_type, type);
+  if(trigs == NULL)
     return;
   
-  char        *trig_key = NULL;
-  LIST_ITERATOR *trig_i = newListIterator(trig_keys);
+  // running triggers might detach other triggers, or change our cached list
+  // out from under us. Work on a copy, and make sure each trigger is still
+  // attached before we run it
+  LIST          *to_run = listCopyWith(trigs, identity_func);
+  LIST_ITERATOR *trig_i = newListIterator(to_run);
   TRIGGER_DATA    *trig = NULL;
-  ITERATE_LIST(trig_key, trig_i) {
-    if((trig = worldGetType(gameworld, "trigger", trig_key)) != NULL &&
-       !strcasecmp(triggerGetType(trig), type))
+  ITERATE_LIST(trig, trig_i) {
+    if(trigs == NULL || !listIn(trigs, trig))
+      continue;
+    if(!strcasecmp(triggerGetType(trig), type)) {
       gen_do_trig(trig,me,me_type,ch,obj,room,exit,command,arg,optional);
+      trigs = get_trigs_of_type(me, me_type, type);
+    }
   } deleteListIterator(trig_i);
+  deleteList(to_run);
 }
 
 
 //*****************************************************************************
 // trighooks
 //*****************************************************************************
-void do_give_trighooks(const char *info) {
+void do_give_trighooks(HOOK_ARGS *args) {
   CHAR_DATA   *ch = NULL;
   CHAR_DATA *recv = NULL;
   OBJ_DATA   *obj = NULL;
-  hookParseInfo(info, &ch, &recv, &obj);
+  hookParseArgs(args, &ch, &recv, &obj);
 
   gen_do_trigs(ch,TRIGVAR_CHAR,"give",recv,obj,NULL,NULL,NULL,NULL,NULL);
   gen_do_trigs(recv,TRIGVAR_CHAR,"receive",ch,obj,NULL,NULL,NULL,NULL,NULL);
@@ -215,27 +207,27 @@ void do_give_trighooks(const char *info) {
   deleteListWith(opts, deleteOptVar);
 }
 
-void do_get_trighooks(const char *info) {
+void do_get_trighooks(HOOK_ARGS *args) {
   CHAR_DATA *ch = NULL;
   OBJ_DATA *obj = NULL;
-  hookParseInfo(info, &ch, &obj);
+  hookParseArgs(args, &ch, &obj);
 
   gen_do_trigs(obj,TRIGVAR_OBJ,"get",ch,NULL,NULL,NULL,NULL,NULL,NULL);
   gen_do_trigs(charGetRoom(ch),TRIGVAR_ROOM,"get",ch,obj,NULL,NULL,NULL,NULL,NULL);
 }
 
-void do_drop_trighooks(const char *info) {
+void do_drop_trighooks(HOOK_ARGS *args) {
   CHAR_DATA *ch = NULL;
   OBJ_DATA *obj = NULL;
-  hookParseInfo(info, &ch, &obj);
+  hookParseArgs(args, &ch, &obj);
   gen_do_trigs(obj,TRIGVAR_OBJ,"drop",ch,NULL,NULL,NULL,NULL,NULL,NULL);
   gen_do_trigs(charGetRoom(ch),TRIGVAR_ROOM,"drop",ch,obj,NULL,NULL,NULL,NULL,NULL);
 }
 
-void do_enter_trighooks(const char *info) {
+void do_enter_trighooks(HOOK_ARGS *args) {
   CHAR_DATA   *ch = NULL;
   ROOM_DATA *room = NULL;
-  hookParseInfo(info, &ch, &room);
+  hookParseArgs(args, &ch, &room);
 
   LIST_ITERATOR *mob_i = newListIterator(roomGetCharacters(room));
   CHAR_DATA       *mob = NULL;
@@ -247,11 +239,11 @@ void do_enter_trighooks(const char *info) {
   gen_do_trigs(ch,TRIGVAR_CHAR,"self enter",NULL,NULL,NULL,NULL,NULL,NULL,NULL);
 }
 
-void do_exit_trighooks(const char *info) {
+void do_exit_trighooks(HOOK_ARGS *args) {
   CHAR_DATA   *ch = NULL;
   ROOM_DATA *room = NULL;
   EXIT_DATA *exit = NULL;
-  hookParseInfo(info, &ch, &room, &exit);
+  hookParseArgs(args, &ch, &room, &exit);
 
   LIST_ITERATOR *mob_i = newListIterator(roomGetCharacters(room));
   CHAR_DATA       *mob = NULL;
@@ -263,21 +255,21 @@ void do_exit_trighooks(const char *info) {
   gen_do_trigs(ch,TRIGVAR_CHAR,"self exit",NULL,NULL,NULL,exit,NULL,NULL,NULL);
 }
 
-void do_ask_trighooks(const char *info) {
+void do_ask_trighooks(HOOK_ARGS *args) {
   CHAR_DATA       *ch = NULL;
   CHAR_DATA *listener = NULL;
   char        *speech = NULL;
-  hookParseInfo(info, &ch, &listener, &speech);
+  hookParseArgs(args, &ch, &listener, &speech);
   gen_do_trigs(listener,TRIGVAR_CHAR,"speech",ch,NULL,NULL,NULL,NULL,speech,NULL);
 
   // garbage collection
   free(speech);
 }
 
-void do_say_trighooks(const char *info) {
+void do_say_trighooks(HOOK_ARGS *args) {
   CHAR_DATA *ch = NULL;
   char  *speech = NULL;
-  hookParseInfo(info, &ch, &speech);
+  hookParseArgs(args, &ch, &speech);
 
   LIST_ITERATOR *mob_i = newListIterator(roomGetCharacters(charGetRoom(ch)));
   CHAR_DATA       *mob = NULL;
@@ -291,32 +283,32 @@ void do_say_trighooks(const char *info) {
   free(speech);
 }
 
-void do_greet_trighooks(const char *info) {
+void do_greet_trighooks(HOOK_ARGS *args) {
   CHAR_DATA      *ch = NULL;
   CHAR_DATA *greeted = NULL;
-  hookParseInfo(info, &ch, &greeted);
+  hookParseArgs(args, &ch, &greeted);
   gen_do_trigs(greeted,TRIGVAR_CHAR,"greet",ch,NULL,NULL,NULL,NULL,NULL,NULL);
 }
 
-void do_wear_trighooks(const char *info) {
+void do_wear_trighooks(HOOK_ARGS *args) {
   CHAR_DATA *ch = NULL;
   OBJ_DATA *obj = NULL;
-  hookParseInfo(info, &ch, &obj);
+  hookParseArgs(args, &ch, &obj);
   gen_do_trigs(ch,TRIGVAR_CHAR,"wear",NULL,obj,NULL,NULL,NULL,NULL,NULL);
   gen_do_trigs(obj,TRIGVAR_OBJ,"wear",ch,NULL,NULL,NULL,NULL,NULL,NULL);
 }
 
-void do_remove_trighooks(const char *info) {
+void do_remove_trighooks(HOOK_ARGS *args) {
   CHAR_DATA *ch = NULL;
   OBJ_DATA *obj = NULL;
-  hookParseInfo(info, &ch, &obj);
+  hookParseArgs(args, &ch, &obj);
   gen_do_trigs(ch,TRIGVAR_CHAR,"remove",NULL,obj,NULL,NULL,NULL,NULL,NULL);
   gen_do_trigs(obj,TRIGVAR_OBJ,"remove",ch,NULL,NULL,NULL,NULL,NULL,NULL);
 }
 
-void do_reset_trighooks(const char *info) {
+void do_reset_trighooks(HOOK_ARGS *args) {
   char  *zone_key = NULL;
-  hookParseInfo(info, &zone_key);
+  hookParseArgs(args, &zone_key);
   ZONE_DATA *zone = worldGetZone(gameworld, zone_key);
 
   LIST_ITERATOR *res_i = newListIterator(zoneGetResettable(zone));
@@ -333,70 +325,70 @@ void do_reset_trighooks(const char *info) {
   free(zone_key);
 }
 
-void do_open_door_trighooks(const char *info) {
+void do_open_door_trighooks(HOOK_ARGS *args) {
   CHAR_DATA *ch = NULL;
   EXIT_DATA *ex = NULL;
-  hookParseInfo(info, &ch, &ex);
+  hookParseArgs(args, &ch, &ex);
   gen_do_trigs(charGetRoom(ch),TRIGVAR_ROOM,"open",ch,NULL,NULL,ex,NULL,NULL,NULL);
 }
 
-void do_open_obj_trighooks(const char *info) {
+void do_open_obj_trighooks(HOOK_ARGS *args) {
   CHAR_DATA *ch = NULL;
   OBJ_DATA *obj = NULL;
-  hookParseInfo(info, &ch, &obj);
+  hookParseArgs(args, &ch, &obj);
   gen_do_trigs(obj,TRIGVAR_OBJ,"open",ch,NULL,NULL,NULL,NULL,NULL,NULL);
 }
 
-void do_close_door_trighooks(const char *info) {
+void do_close_door_trighooks(HOOK_ARGS *args) {
   CHAR_DATA *ch = NULL;
   EXIT_DATA *ex = NULL;
-  hookParseInfo(info, &ch, &ex);
+  hookParseArgs(args, &ch, &ex);
   gen_do_trigs(charGetRoom(ch),TRIGVAR_ROOM,"close",ch,NULL,NULL,ex,NULL,NULL,NULL);
 }
 
-void do_close_obj_trighooks(const char *info) {
+void do_close_obj_trighooks(HOOK_ARGS *args) {
   CHAR_DATA *ch = NULL;
   OBJ_DATA *obj = NULL;
-  hookParseInfo(info, &ch, &obj);
+  hookParseArgs(args, &ch, &obj);
   gen_do_trigs(obj,TRIGVAR_OBJ,"close",ch,NULL,NULL,NULL,NULL,NULL,NULL);
 }
 
-void do_look_at_obj_trighooks(const char *info) {
+void do_look_at_obj_trighooks(HOOK_ARGS *args) {
   OBJ_DATA     *obj = NULL;
   CHAR_DATA *looker = NULL;
-  hookParseInfo(info, &obj, &looker);
+  hookParseArgs(args, &obj, &looker);
   gen_do_trigs(obj,TRIGVAR_OBJ,"look",looker,NULL,NULL,NULL,NULL,NULL,NULL);
 }
 
-void do_look_at_room_trighooks(const char *info) {
+void do_look_at_room_trighooks(HOOK_ARGS *args) {
   ROOM_DATA   *room = NULL;
   CHAR_DATA *looker = NULL;
-  hookParseInfo(info, &room, &looker);
+  hookParseArgs(args, &room, &looker);
   gen_do_trigs(room,TRIGVAR_ROOM,"look",looker,NULL,NULL,NULL,NULL,NULL,NULL);
 }
 
-void do_look_at_char_trighooks(const char *info) {
+void do_look_at_char_trighooks(HOOK_ARGS *args) {
   CHAR_DATA     *ch = NULL;
   CHAR_DATA *looker = NULL;
-  hookParseInfo(info, &ch, &looker);
+  hookParseArgs(args, &ch, &looker);
   gen_do_trigs(ch,TRIGVAR_CHAR,"look",looker,NULL,NULL,NULL,NULL,NULL,NULL);
 }
 
-void do_obj_to_game_trighooks(const char *info) {
+void do_obj_to_game_trighooks(HOOK_ARGS *args) {
   OBJ_DATA *obj = NULL;
-  hookParseInfo(info, &obj);
+  hookParseArgs(args, &obj);
   gen_do_trigs(obj,TRIGVAR_OBJ,"to_game",NULL,NULL,NULL,NULL,NULL,NULL,NULL);
 }
 
-void do_char_to_game_trighooks(const char *info) {
+void do_char_to_game_trighooks(HOOK_ARGS *args) {
   CHAR_DATA *ch = NULL;
-  hookParseInfo(info, &ch);
+  hookParseArgs(args, &ch);
   gen_do_trigs(ch, TRIGVAR_CHAR,"to_game",NULL,NULL,NULL,NULL,NULL,NULL,NULL);
 }
 
-void do_room_to_game_trighooks(const char *info) {
+void do_room_to_game_trighooks(HOOK_ARGS *args) {
   ROOM_DATA *rm = NULL;
-  hookParseInfo(info, &rm);
+  hookParseArgs(args, &rm);
   gen_do_trigs(rm,TRIGVAR_ROOM,"to_game",NULL,NULL,NULL,NULL,NULL,NULL,NULL);
 }
 
@@ -23,6 +23,7 @@
 #include "../races.h"
 #include "../handler.h"
 #include "../save.h"
+#include "../broadcast.h"
 
 #include "set_val.h"
 
@@ -46,6 +47,7 @@
 void charSetUserGroups(CHAR_DATA *ch, const char *groups) {
   bitClear(charGetUserGroups(ch));
   bitSet(charGetUserGroups(ch), groups);
+  broadcast_update(ch);
 }
 
 
@@ -0,0 +1,432 @@
+//*****************************************************************************
+//
+// snapshot.c
+//
+// Writes the live state of the world to disk before a copyover, and reads it
+// back in afterwards. For a description of what snapshots do, see snapshot.h
+//
+//*****************************************************************************
+
+#include <unistd.h>
+
+#include "mud.h"
+#include "utils.h"
+#include "storage.h"
+#include "auxiliary.h"
+#include "world.h"
+#include "zone.h"
+#include "room.h"
+#include "character.h"
+#include "object.h"
+#include "body.h"
+#include "handler.h"
+#include "event.h"
+#include "idle_rooms.h"
+#include "snapshot.h"
+
+
+
+//*****************************************************************************
+// local datastructures, functions, and defines
+//*****************************************************************************
+
+// where we write our snapshot to. Lives beside the copyover file
+#define SNAPSHOT_FILE      "../.copyover.snapshot"
+
+// bump this whenever the layout of the snapshot changes. Old snapshots will
+// be ignored, and the world will be reset like normal
+#define SNAPSHOT_VERSION   1
+
+// are we in the middle of writing a snapshot?
+bool snapshotting = FALSE;
+
+// the snapshot we are restoring from, kept until its events are read
+STORAGE_SET *restoring = NULL;
+
+// how much we have stored or read in the current snapshot
+int snap_rooms = 0;
+int  snap_mobs = 0;
+int  snap_objs = 0;
+
+//
+// Objects, rooms, and non-player characters do not normally save their UIDs.
+// When we're snapshotting, this auxiliary data records the UID of its owner so
+// the owner can be given the same UID after a copyover. This lets things like
+// Python events and scripts that have remembered UIDs keep working.
+typedef struct {
+  int uid;
+} SNAPSHOT_AUX_DATA;
+
+SNAPSHOT_AUX_DATA *newSnapshotAuxData(void) {
+  SNAPSHOT_AUX_DATA *data = malloc(sizeof(SNAPSHOT_AUX_DATA));
+  data->uid = NOTHING;
+  return data;
+}
+
+void deleteSnapshotAuxData(SNAPSHOT_AUX_DATA *data) {
+  free(data);
+}
+
+void snapshotAuxDataCopyTo(SNAPSHOT_AUX_DATA *from, SNAPSHOT_AUX_DATA *to) {
+  // copies are new things. They do not get their original's UID
+  to->uid = NOTHING;
+}
+
+SNAPSHOT_AUX_DATA *snapshotAuxDataCopy(SNAPSHOT_AUX_DATA *data) {
+  return newSnapshotAuxData();
+}
+
+STORAGE_SET *snapshotAuxDataStore(SNAPSHOT_AUX_DATA *data) {
+  STORAGE_SET *set = new_storage_set();
+  if(snapshotting && data->uid != NOTHING)
+    store_int(set, "uid", data->uid);
+  return set;
+}
+
+SNAPSHOT_AUX_DATA *snapshotAuxDataRead(STORAGE_SET *set) {
+  SNAPSHOT_AUX_DATA *data = newSnapshotAuxData();
+  if(storage_contains(set, "uid"))
+    data->uid = read_int(set, "uid");
+  return data;
+}
+
+//
+// record the UIDs of an object and everything inside of it, and count them
+void snapshot_tag_obj(OBJ_DATA *obj) {
+  SNAPSHOT_AUX_DATA *data = objGetAuxiliaryData(obj, "snapshot_data");
+  data->uid = objGetUID(obj);
+  snap_objs++;
+
+  LIST_ITERATOR *cont_i = newListIterator(objGetContents(obj));
+  OBJ_DATA        *cont = NULL;
+  ITERATE_LIST(cont, cont_i) {
+    snapshot_tag_obj(cont);
+  } deleteListIterator(cont_i);
+}
+
+//
+// give an object (and everything inside of it) back the UID it had when it
+// was stored, and count them
+void snapshot_untag_obj(OBJ_DATA *obj) {
+  SNAPSHOT_AUX_DATA *data = objGetAuxiliaryData(obj, "snapshot_data");
+  if(data->uid != NOTHING)
+    objSetUID(obj, data->uid);
+  data->uid = NOTHING;
+  snap_objs++;
+
+  LIST_ITERATOR *cont_i = newListIterator(objGetContents(obj));
+  OBJ_DATA        *cont = NULL;
+  ITERATE_LIST(cont, cont_i) {
+    snapshot_untag_obj(cont);
+  } deleteListIterator(cont_i);
+}
+
+//
+// roomStore only stores the characters in a room, and not what they are
+// carrying or wearing. Store that, in the same way as player object files
+STORAGE_SET *snapshot_store_gear(CHAR_DATA *ch) {
+  STORAGE_SET *set = new_storage_set();
+  store_int (set, "uid", charGetUID(ch));
+  store_list(set, "inventory", gen_store_list(charGetInventory(ch), objStore));
+
+  STORAGE_SET_LIST *list = new_storage_list();
+  LIST          *eq_list = bodyGetAllEq(charGetBody(ch));
+  OBJ_DATA          *obj = NULL;
+  while((obj = listPop(eq_list)) != NULL) {
+    STORAGE_SET *eq_set = new_storage_set();
+    store_string(eq_set, "equipped", bodyEquippedWhere(charGetBody(ch), obj));
+    store_set   (eq_set, "object",   objStore(obj));
+    storage_list_put(list, eq_set);
+  }
+  deleteList(eq_list);
+  store_list(set, "equipment", list);
+  return set;
+}
+
+void snapshot_read_gear(CHAR_DATA *ch, STORAGE_SET *set) {
+  STORAGE_SET_LIST *list = read_list(set, "inventory");
+  STORAGE_SET   *obj_set = NULL;
+  OBJ_DATA          *obj = NULL;
+  while( (obj_set = storage_list_next(list)) != NULL) {
+    obj = objRead(obj_set);
+    snapshot_untag_obj(obj);
+    obj_to_char(obj, ch);
+  }
+
+  list = read_list(set, "equipment");
+  while( (obj_set = storage_list_next(list)) != NULL) {
+    obj = objRead(read_set(obj_set, "object"));
+    snapshot_untag_obj(obj);
+    if(!do_equip(ch, obj, read_string(obj_set, "equipped"), TRUE))
+      obj_to_char(obj, ch);
+  }
+}
+
+//
+// store one room, plus everything in it
+STORAGE_SET *snapshot_store_room(ROOM_DATA *room) {
+  STORAGE_SET           *set = new_storage_set();
+  STORAGE_SET_LIST *gear_set = new_storage_list();
+  SNAPSHOT_AUX_DATA    *data = roomGetAuxiliaryData(room, "snapshot_data");
+  data->uid = roomGetUID(room);
+  snap_rooms++;
+
+  // tag all of the non-player characters, and record what they are carrying
+  LIST_ITERATOR *ch_i = newListIterator(roomGetCharacters(room));
+  CHAR_DATA       *ch = NULL;
+  ITERATE_LIST(ch, ch_i) {
+    if(!charIsNPC(ch))
+      continue;
+    data = charGetAuxiliaryData(ch, "snapshot_data");
+    data->uid = charGetUID(ch);
+    snap_mobs++;
+
+    LIST *eq = bodyGetAllEq(charGetBody(ch));
+    OBJ_DATA *obj = NULL;
+    while( (obj = listPop(eq)) != NULL)
+      snapshot_tag_obj(obj);
+    deleteList(eq);
+    LIST_ITERATOR *inv_i = newListIterator(charGetInventory(ch));
+    ITERATE_LIST(obj, inv_i) {
+      snapshot_tag_obj(obj);
+    } deleteListIterator(inv_i);
+    storage_list_put(gear_set, snapshot_store_gear(ch));
+  } deleteListIterator(ch_i);
+
+  // and all of the objects in the room
+  LIST_ITERATOR *obj_i = newListIterator(roomGetContents(room));
+  OBJ_DATA        *obj = NULL;
+  ITERATE_LIST(obj, obj_i) {
+    snapshot_tag_obj(obj);
+  } deleteListIterator(obj_i);
+
+  store_bool(set, "in_world",
+	     worldRoomLoaded(gameworld, roomGetClass(room)) &&
+	     worldGetRoom(gameworld, roomGetClass(room)) == room);
+  store_set (set, "room",     roomStore(room));
+  store_list(set, "gear",     gear_set);
+  return set;
+}
+
+//
+// read one room and everything in it. Nothing is put into the game yet
+ROOM_DATA *snapshot_read_room(STORAGE_SET *set) {
+  ROOM_DATA         *room = roomRead(read_set(set, "room"));
+  SNAPSHOT_AUX_DATA *data = roomGetAuxiliaryData(room, "snapshot_data");
+  if(data->uid != NOTHING)
+    roomSetUID(room, data->uid);
+  data->uid = NOTHING;
+  snap_rooms++;
+
+  LIST_ITERATOR *ch_i = newListIterator(roomGetCharacters(room));
+  CHAR_DATA       *ch = NULL;
+  ITERATE_LIST(ch, ch_i) {
+    data = charGetAuxiliaryData(ch, "snapshot_data");
+    if(data->uid != NOTHING)
+      charSetUID(ch, data->uid);
+    data->uid = NOTHING;
+    snap_mobs++;
+  } deleteListIterator(ch_i);
+
+  LIST_ITERATOR *obj_i = newListIterator(roomGetContents(room));
+  OBJ_DATA        *obj = NULL;
+  ITERATE_LIST(obj, obj_i) {
+    snapshot_untag_obj(obj);
+  } deleteListIterator(obj_i);
+
+  // give everyone back what they were carrying
+  STORAGE_SET_LIST *gear_list = read_list(set, "gear");
+  STORAGE_SET       *gear_set = NULL;
+  while( (gear_set = storage_list_next(gear_list)) != NULL) {
+    ch_i = newListIterator(roomGetCharacters(room));
+    ITERATE_LIST(ch, ch_i) {
+      if(charGetUID(ch) == read_int(gear_set, "uid")) {
+	snapshot_read_gear(ch, gear_set);
+	break;
+      }
+    } deleteListIterator(ch_i);
+  }
+
+  return room;
+}
+
+//
+// remember how long each zone has until it next resets
+STORAGE_SET_LIST *snapshot_store_zones(void) {
+  STORAGE_SET_LIST *list = new_storage_list();
+  LIST             *keys = worldGetZoneKeys(gameworld);
+  char              *key = NULL;
+  while( (key = listPop(keys)) != NULL) {
+    STORAGE_SET *set = new_storage_set();
+    store_string(set, "zone",  key);
+    store_int   (set, "pulse", zoneGetPulse(worldGetZone(gameworld, key)));
+    storage_list_put(list, set);
+    free(key);
+  }
+  deleteList(keys);
+  return list;
+}
+
+//
+// restore zone reset timers. Zones we have no record of start their timers
+// over, as they would after a normal reset
+void snapshot_read_zones(STORAGE_SET_LIST *list) {
+  LIST   *keys = worldGetZoneKeys(gameworld);
+  char    *key = NULL;
+  while( (key = listPop(keys)) != NULL) {
+    ZONE_DATA *zone = worldGetZone(gameworld, key);
+    zoneSetPulse(zone, zoneGetPulseTimer(zone));
+    free(key);
+  }
+  deleteList(keys);
+
+  STORAGE_SET *set = NULL;
+  while( (set = storage_list_next(list)) != NULL) {
+    ZONE_DATA *zone = worldGetZone(gameworld, read_string(set, "zone"));
+    if(zone != NULL)
+      zoneSetPulse(zone, read_int(set, "pulse"));
+  }
+}
+
+
+
+//*****************************************************************************
+// implementation of snapshot.h
+//*****************************************************************************
+void init_snapshot(void) {
+  auxiliariesInstall("snapshot_data",
+		     newAuxiliaryFuncs(AUXILIARY_TYPE_CHAR |
+				       AUXILIARY_TYPE_ROOM |
+				       AUXILIARY_TYPE_OBJ,
+				       newSnapshotAuxData, deleteSnapshotAuxData,
+				       snapshotAuxDataCopyTo, snapshotAuxDataCopy,
+				       snapshotAuxDataStore,snapshotAuxDataRead));
+}
+
+bool snapshot_store(void) {
+  // make sure an old snapshot is never mistaken for this copyover's
+  unlink(SNAPSHOT_FILE);
+  if(!mudsettingGetBool("copyover_snapshot"))
+    return FALSE;
+
+  STORAGE_SET          *set = new_storage_set();
+  STORAGE_SET_LIST *room_set = new_storage_list();
+  int               unstored = 0;
+  snapshotting = TRUE;
+  snap_rooms = snap_mobs = snap_objs = 0;
+
+  LIST_ITERATOR *room_i = newListIterator(room_list);
+  ROOM_DATA       *room = NULL;
+  ITERATE_LIST(room, room_i) {
+    if(!roomIsExtracted(room))
+      storage_list_put(room_set, snapshot_store_room(room));
+  } deleteListIterator(room_i);
+
+  store_int   (set, "version", SNAPSHOT_VERSION);
+  store_int   (set, "top_uid", top_uid());
+  store_int   (set, "rooms",   snap_rooms);
+  store_int   (set, "mobs",    snap_mobs);
+  store_int   (set, "objs",    snap_objs);
+  store_list  (set, "roomlist",room_set);
+  store_list  (set, "zones",   snapshot_store_zones());
+  store_list  (set, "events",  store_events(&unstored));
+  store_list  (set, "unloaded",idle_rooms_store());
+  storage_write(set, SNAPSHOT_FILE);
+  storage_close(set);
+  snapshotting = FALSE;
+
+  log_string("Snapshot: stored %d rooms, %d mobiles, %d objects. "
+	     "%d events could not be stored.",
+	     snap_rooms, snap_mobs, snap_objs, unstored);
+  return TRUE;
+}
+
+bool snapshot_restore_world(void) {
+  if(!file_exists(SNAPSHOT_FILE))
+    return FALSE;
+
+  STORAGE_SET *set = storage_read(SNAPSHOT_FILE);
+  unlink(SNAPSHOT_FILE);
+  if(read_int(set, "version") != SNAPSHOT_VERSION) {
+    log_string("Snapshot: version %d is not understood, resetting world.",
+	       read_int(set, "version"));
+    storage_close(set);
+    return FALSE;
+  }
+
+  // anything created while we read must not take a UID we are restoring
+  reserve_uids(read_int(set, "top_uid"));
+
+  // read everything in before putting any of it into the game, so we can
+  // back out cleanly if the snapshot turns out to be incomplete
+  LIST           *rooms = newList();
+  STORAGE_SET_LIST *list = read_list(set, "roomlist");
+  STORAGE_SET *room_set = NULL;
+  snap_rooms = snap_mobs = snap_objs = 0;
+  while( (room_set = storage_list_next(list)) != NULL) {
+    ROOM_DATA *room = snapshot_read_room(room_set);
+    listQueue(rooms, room);
+    if(read_bool(room_set, "in_world") &&
+       worldRoomLoaded(gameworld, roomGetClass(room))) {
+      log_string("Snapshot: room %s was already loaded.", roomGetClass(room));
+      snap_rooms = -1;
+    }
+    else if(read_bool(room_set, "in_world"))
+      worldPutRoom(gameworld, roomGetClass(room), room);
+  }
+
+  // make sure we got everything we were expecting
+  if(snap_rooms != read_int(set, "rooms") ||
+     snap_mobs  != read_int(set, "mobs")  ||
+     snap_objs  != read_int(set, "objs")) {
+    log_string("Snapshot: expected %d rooms, %d mobiles, %d objects but read "
+	       "%d, %d, %d. Resetting world.",
+	       read_int(set, "rooms"), read_int(set, "mobs"),
+	       read_int(set, "objs"), snap_rooms, snap_mobs, snap_objs);
+    ROOM_DATA *room = NULL;
+    while( (room = listPop(rooms)) != NULL) {
+      if(worldRoomLoaded(gameworld, roomGetClass(room)) &&
+	 worldGetRoom(gameworld, roomGetClass(room)) == room)
+	worldRemoveRoom(gameworld, roomGetClass(room));
+      deleteRoom(room);
+    }
+    deleteList(rooms);
+    storage_close(set);
+    return FALSE;
+  }
+
+  // everything checks out. Put it all in the game
+  ROOM_DATA *room = NULL;
+  while( (room = listPop(rooms)) != NULL)
+    room_to_game(room);
+  deleteList(rooms);
+  snapshot_read_zones(read_list(set, "zones"));
+  idle_rooms_read(read_list(set, "unloaded"));
+
+  log_string("Snapshot: restored %d rooms, %d mobiles, %d objects.",
+	     snap_rooms, snap_mobs, snap_objs);
+
+  // hold on to the rest of the snapshot until players are back in the game
+  restoring = set;
+  return TRUE;
+}
+
+STORAGE_SET *snapshot_room_store(ROOM_DATA *room) {
+  snapshotting = TRUE;
+  STORAGE_SET *set = snapshot_store_room(room);
+  snapshotting = FALSE;
+  return set;
+}
+
+ROOM_DATA *snapshot_room_read(STORAGE_SET *set) {
+  return snapshot_read_room(set);
+}
+
+void snapshot_restore_events(void) {
+  if(restoring != NULL) {
+    int read = read_events(read_list(restoring, "events"));
+    log_string("Snapshot: restored %d events.", read);
+    storage_close(restoring);
+    restoring = NULL;
+  }
+}
@@ -0,0 +1,60 @@
+#ifndef __SNAPSHOT_H
+#define __SNAPSHOT_H
+//*****************************************************************************
+//
+// snapshot.h
+//
+// Normally, a copyover only remembers who was connected. The new process loads
+// the world up from its prototypes and force-resets every zone, so everything
+// that has happened in the world since boot (mobs that have been killed or
+// wandered off, objects that were dropped, doors that were opened, events that
+// were pending) is lost. Snapshots let the mud write the live state of the
+// world to disk just before a copyover and read it back in afterwards, instead
+// of doing a full reset. Rooms, mobiles, objects, and their auxiliary data keep
+// the same UIDs they had before the copyover.
+//
+// Snapshots are only taken if the "copyover_snapshot" mud setting is on. If
+// a snapshot cannot be restored, the world is reset like normal.
+//
+//*****************************************************************************
+
+//
+// prepare snapshots for use
+//
+void init_snapshot(void);
+
+
+//
+// if snapshots are turned on, write the state of the world to disk. Should be
+// called by copyover right before the mud exec's itself. Returns TRUE if a
+// snapshot was written.
+//
+bool snapshot_store(void);
+
+
+//
+// read the rooms, mobiles, and objects from a snapshot back into the game.
+// Must be called after the gameworld is loaded, but before any of its rooms
+// are created. If this returns FALSE, nothing was restored and the world
+// should be reset like normal.
+//
+bool snapshot_restore_world(void);
+
+
+//
+// read back in the pending events from a snapshot. This should be done after
+// the players have been brought back into the game, so events involving them
+// can be restored as well. Must be called after snapshot_restore_world.
+//
+void snapshot_restore_events(void);
+
+
+//
+// store one room and everything in it, in the same way snapshots do. The room
+// can be read back in later with snapshot_room_read, and it and everything in
+// it will have the same UIDs they have now. Nothing is removed from the game.
+//
+STORAGE_SET *snapshot_room_store(ROOM_DATA *room);
+ROOM_DATA     *snapshot_room_read(STORAGE_SET *set);
+
+#endif // __SNAPSHOT_H
@@ -22,9 +22,12 @@
 #include "socket.h"
 #include "auxiliary.h"
 #include "hooks.h"
+#include "snapshot.h"
+#include "colour.h"
 #include "scripts/scripts.h"
 #include "scripts/pyplugs.h"
 #include "dyn_vars/dyn_vars.h"
+#include "jobs.h"
 
 
 
@@ -57,6 +60,7 @@ struct socket_data {
   int             lookup_status;
   int             control;
   int             uid;
+  int             colour;        // what sort of colour can we display?
   double          idle;          // how many pulses have we been idle for?
 
   char          * page_string;   // the string that has been paged to us
@@ -89,6 +93,10 @@ typedef struct input_handler_data {
   char   *state; // what state does this input handler represent?
 } IH_PAIR;
 
+// argument tuples we reuse when calling Python input handlers and prompts
+PyObject *py_handler_args = NULL;
+PyObject  *py_prompt_args = NULL;
+
 
 //
 // required for looking up a socket's IP in a new thread
@@ -509,8 +517,7 @@ int read_iac_sequence(SOCKET_DATA *dsock, int start) {
 
   // broadcast the message we parsed, and prepare for the next sequence
   if(done == TRUE) {
-    hookRun("receive_iac", 
-	    hookBuildInfo("sk str", dsock,bufferString(dsock->iac_sequence)));
+    hookRun("receive_iac", "sk str", dsock,bufferString(dsock->iac_sequence));
     bufferClear(dsock->iac_sequence);
   }
   return len;
@@ -576,7 +583,7 @@ bool flush_output(SOCKET_DATA *dsock) {
   BUFFER   *buf = NULL;
 
   // run any hooks prior to flushing our text
-  hookRun("flush", hookBuildInfo("sk", dsock));
+  hookRun("flush", "sk", dsock);
 
   // quit if we have no output and don't need/can't have a prompt
   if(bufferLength(dsock->outbuf) <= 0 && 
@@ -587,8 +594,9 @@ bool flush_output(SOCKET_DATA *dsock) {
 
   // send our outbound text
   if(bufferLength(dsock->outbuf) > 0) {
-    hookRun("process_outbound_text",  hookBuildInfo("sk", dsock));
-    hookRun("finalize_outbound_text", hookBuildInfo("sk", dsock));
+    hookRun("process_outbound_text",  "sk", dsock);
+    bufferExpandColour(dsock->outbuf, dsock->colour);
+    hookRun("finalize_outbound_text", "sk", dsock);
     //success = text_to_socket(dsock, bufferString(dsock->outbuf));
     bufferCat(buf, bufferString(dsock->outbuf));
     bufferClear(dsock->outbuf);
@@ -597,8 +605,9 @@ bool flush_output(SOCKET_DATA *dsock) {
   // send our prompt
   if(dsock->bust_prompt && success) {
     socketShowPrompt(dsock);
-    hookRun("process_outbound_prompt",  hookBuildInfo("sk", dsock));
-    hookRun("finalize_outbound_prompt", hookBuildInfo("sk", dsock));
+    hookRun("process_outbound_prompt",  "sk", dsock);
+    bufferExpandColour(dsock->outbuf, dsock->colour);
+    hookRun("finalize_outbound_prompt", "sk", dsock);
     //success = text_to_socket(dsock, bufferString(dsock->outbuf));
     bufferCat(buf, bufferString(dsock->outbuf));
     bufferClear(dsock->outbuf);
@@ -657,6 +666,7 @@ void clear_socket(SOCKET_DATA *sock_new, int sock)
   sock_new->control        = sock;
   sock_new->lookup_status  = TSTATE_LOOKUP;
   sock_new->uid            = next_sock_uid++;
+  sock_new->colour         = COLOUR_16;
 
   sock_new->text_editor    = newBuffer(1);
   sock_new->outbuf         = newBuffer(MAX_OUTPUT);
@@ -674,6 +684,8 @@ void *lookup_address(void *arg)
   //  char buf[16384];
   //  int err;
 
+  block_thread_signals();
+
   /* do the lookup and store the result at &from */
   from = gethostbyaddr(lData->buf, sizeof(lData->buf), AF_INET);
 
@@ -811,7 +823,7 @@ void copyover_recover() {
     dsock->lookup_status  =  TSTATE_DONE;
 
     // let our modules know we've finished copying over a socket
-    hookRun("copyover_complete", hookBuildInfo("sk", dsock));
+    hookRun("copyover_complete", "sk", dsock);
 
     // negotiate compression
     text_to_buffer(dsock, (char *) compress_will2);
@@ -821,6 +833,9 @@ void copyover_recover() {
 
   // now, set all of the sockets' control to the new fSet
   reconnect_copyover_sockets();
+
+  // everyone is back in the game. Pick up any events we left pending
+  snapshot_restore_events();
 }     
 
 void output_handler() {
@@ -868,9 +883,11 @@ void input_handler() {
 	free(cmddup);
       }
       else {
-	PyObject *arglist = Py_BuildValue("Os", socketGetPyFormBorrowed(sock),
-					  bufferString(sock->next_command));
-	PyObject *retval  = PyEval_CallObject(pair->handler, arglist);
+	PyObject *input  = PyString_FromString(bufferString(sock->next_command));
+	PyObject *retval = PyObject_CallReusingArgs(&py_handler_args,
+						    pair->handler, 2,
+						    socketGetPyFormBorrowed(sock),
+						    input);
 
 	// check for an error:
 	if(retval == NULL)
@@ -878,7 +895,7 @@ void input_handler() {
 	
 	// garbage collection
 	Py_XDECREF(retval);
-	Py_XDECREF(arglist);
+	Py_DECREF(input);
       }
 
       // append our last command to the command history. History buffer is
@@ -1046,6 +1063,9 @@ void do_copyover(void) {
   if ((fp = fopen(COPYOVER_FILE, "w+")) == NULL)
     return;
 
+  // finish any work in progress, so its results are not lost
+  jobs_finish();
+
   sprintf(buf, "\n\r <*>            The world starts spinning             <*>\n\r");
 
   // For each playing descriptor, save its character and account
@@ -1072,6 +1092,9 @@ void do_copyover(void) {
   fprintf (fp, "-1\n");
   fclose (fp);
 
+  // write out the state of the world, so we don't have to reset it
+  snapshot_store();
+
   // close any pending sockets
   recycle_sockets();
 
@@ -1079,6 +1102,9 @@ void do_copyover(void) {
   // if we have a webserver set up, finalize that
   finalize_webserver();
 #endif
+
+  // make sure everything waiting to be logged gets written
+  flush_appends();
   
   // exec - descriptors are inherited
   sprintf(control_buf, "%d", control);
@@ -1191,15 +1217,14 @@ void socketShowPrompt( SOCKET_DATA *sock) {
     ((void (*)(SOCKET_DATA *))pair->prompt)(sock);
   }
   else {
-    PyObject *arglist = Py_BuildValue("(O)", socketGetPyFormBorrowed(sock));
-    PyObject *retval  = PyEval_CallObject(pair->prompt, arglist);
+    PyObject *retval = PyObject_CallReusingArgs(&py_prompt_args, pair->prompt,
+						1, socketGetPyFormBorrowed(sock));
     // check for an error:
     if(retval == NULL)
       log_pyerr("Error with a Python prompt");
     
     // garbage collection
     Py_XDECREF(retval);
-    Py_XDECREF(arglist);
   }
 }
 
@@ -1231,6 +1256,14 @@ double socketGetIdleTime(SOCKET_DATA *sock) {
   return sock->idle;
 }
 
+int socketGetColour(SOCKET_DATA *sock) {
+  return sock->colour;
+}
+
+void socketSetColour(SOCKET_DATA *sock, int mode) {
+  sock->colour = mode;
+}
+
 
 
 //*****************************************************************************
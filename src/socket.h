@@ -68,5 +68,7 @@ bool socketHasCommand         ( SOCKET_DATA *sock);
 const char *socketGetLastCmd  ( SOCKET_DATA *sock);
 const char *socketGetState    ( SOCKET_DATA *sock);
 double socketGetIdleTime      ( SOCKET_DATA *sock);
+int  socketGetColour          ( SOCKET_DATA *sock);
+void socketSetColour          ( SOCKET_DATA *sock, int mode);
 
 #endif // SOCKET_H
@@ -570,6 +570,21 @@ STORAGE_SET *storage_read(const char *fname) {
   return set;
 }
 
+STORAGE_SET *storage_read_string(const char *data) {
+  FILEBUF      *fb = fbopen_string(data);
+  STORAGE_SET *set = parse_storage_set(fb, 0);
+  fbclose(fb);
+  return set;
+}
+
+char *storage_write_string(STORAGE_SET *set) {
+  FILEBUF *fb = fbopen_memory();
+  write_storage_set(set, fb, 0);
+  char   *str = strdup(fbstring(fb));
+  fbclose(fb);
+  return str;
+}
+
 STORAGE_SET_LIST *new_storage_list() {
   STORAGE_SET_LIST *list = malloc(sizeof(STORAGE_SET_LIST));
   list->list = newList();
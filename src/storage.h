@@ -38,6 +38,20 @@ void storage_write(STORAGE_SET *set, const char *fname);
 STORAGE_SET *storage_read(const char *fname);
 
 
+//
+// read a storage set from a string that is already in memory, in the same
+// format it would be written to a file in
+//
+STORAGE_SET *storage_read_string(const char *data);
+
+
+//
+// write the storage set to a string, in the same format it would be written
+// to a file in. The string must be freed after use
+//
+char *storage_write_string(STORAGE_SET *set);
+
+
 //
 // close and delete the specified storage set
 //
@@ -14,6 +14,8 @@
 #include <unistd.h>
 #include <dirent.h> 
 #include <time.h>
+#include <signal.h>
+#include <pthread.h>
 
 // include main header file
 #include "mud.h"
@@ -33,6 +35,8 @@
 #include "event.h"
 #include "action.h"
 #include "hooks.h"
+#include "keyword_index.h"
+#include "visibility.h"
 
 
 
@@ -114,6 +118,24 @@ void extract_room_final(ROOM_DATA *room) {
   deleteRoom(room);
 }
 
+void extract_pending(void) {
+  CHAR_DATA *ch = NULL;
+  while((ch = (CHAR_DATA *)listPop(mobs_to_delete)) != NULL)
+    extract_mobile_final(ch);
+  OBJ_DATA *obj = NULL;
+  while((obj = (OBJ_DATA *)listPop(objs_to_delete)) != NULL)
+    extract_obj_final(obj);
+  ROOM_DATA *room = NULL;
+  while((room = (ROOM_DATA *)listPop(rooms_to_delete)) != NULL)
+    extract_room_final(room);
+  char *str = NULL;
+  while((str = (char *)listPop(strs_to_delete)) != NULL)
+    free(str);
+  BUFFER *buf = NULL;
+  while((buf = (BUFFER *)listPop(bufs_to_delete)) != NULL)
+    deleteBuffer(buf);
+}
+
 void extract_room(ROOM_DATA *room) {
   roomSetExtracted(room);
 
@@ -329,7 +351,7 @@ bool  can_see_char(CHAR_DATA *ch, CHAR_DATA *target) {
     return FALSE;
 
   bool ret = TRUE;
-  if(char_see_checks != NULL) {
+  if(char_see_checks != NULL && !visibility_recall(ch, target, &ret)) {
     LIST_ITERATOR *chk_i = newListIterator(char_see_checks);
     bool (*chk)(CHAR_DATA *, CHAR_DATA *) = NULL;
     ITERATE_LIST(chk, chk_i) {
@@ -337,6 +359,7 @@ bool  can_see_char(CHAR_DATA *ch, CHAR_DATA *target) {
       if(ret == FALSE)
 	break;
     } deleteListIterator(chk_i);
+    visibility_remember(ch, target, ret);
   }
   return ret;
 }
@@ -346,7 +369,7 @@ bool can_see_obj(CHAR_DATA *ch, OBJ_DATA  *target) {
     return FALSE;
 
   bool ret = TRUE;
-  if(obj_see_checks != NULL) {
+  if(obj_see_checks != NULL && !visibility_recall(ch, target, &ret)) {
     LIST_ITERATOR *chk_i = newListIterator(obj_see_checks);
     bool (*chk)(CHAR_DATA *, OBJ_DATA *) = NULL;
     ITERATE_LIST(chk, chk_i) {
@@ -354,6 +377,7 @@ bool can_see_obj(CHAR_DATA *ch, OBJ_DATA  *target) {
       if(ret == FALSE)
 	break;
     } deleteListIterator(chk_i);
+    visibility_remember(ch, target, ret);
   }
   return ret;
 }
@@ -363,7 +387,7 @@ bool can_see_exit(CHAR_DATA *ch, EXIT_DATA *target) {
     return FALSE;
 
   bool ret = TRUE;
-  if(exit_see_checks != NULL) {
+  if(exit_see_checks != NULL && !visibility_recall(ch, target, &ret)) {
     LIST_ITERATOR *chk_i = newListIterator(exit_see_checks);
     bool (*chk)(CHAR_DATA *, EXIT_DATA *) = NULL;
     ITERATE_LIST(chk, chk_i) {
@@ -371,6 +395,7 @@ bool can_see_exit(CHAR_DATA *ch, EXIT_DATA *target) {
       if(ret == FALSE)
 	break;
     } deleteListIterator(chk_i);
+    visibility_remember(ch, target, ret);
   }
   return ret;
 }
@@ -447,10 +472,14 @@ int name_as_uid(const char *name) {
 
 int count_objs(CHAR_DATA *looker, LIST *list, const char *name, 
 	       const char *prototype, bool must_see) {
+  int   uid = name_as_uid(name);
+  // only things that might be called name need to be looked at, unless we
+  // might also be looking for something by its UID
+  if(uid == NOTHING)
+    list = keyword_narrow_objs(list, name, prototype);
   LIST_ITERATOR *obj_i = newListIterator(list);
   OBJ_DATA *obj;
   int count = 0;
-  int   uid = name_as_uid(name);
 
   ITERATE_LIST(obj, obj_i) {
     if(must_see && !can_see_obj(looker, obj))
@@ -468,10 +497,12 @@ int count_objs(CHAR_DATA *looker, LIST *list, const char *name,
 
 int count_chars(CHAR_DATA *looker, LIST *list, const char *name,
 		const char *prototype, bool must_see) {
+  int   uid = name_as_uid(name);
+  if(uid == NOBODY)
+    list = keyword_narrow_chars(list, name, prototype);
   LIST_ITERATOR *char_i = newListIterator(list);
   CHAR_DATA *ch;
   int count = 0;
-  int   uid = name_as_uid(name);
 
   ITERATE_LIST(ch, char_i) {
     if(must_see && !can_see_char(looker, ch))
@@ -502,12 +533,14 @@ CHAR_DATA *find_char(CHAR_DATA *looker, LIST *list, int num, const char *name,
   int uid = name_as_uid(name);
   if(uid != NOBODY) {
     ch = propertyTableGet(mob_table, uid);
-    if(listIn(list, ch) && can_see_char(looker, ch))
+    if((list == mobile_list ? setIn(mobile_set, ch) : listIn(list, ch)) &&
+       can_see_char(looker, ch))
       return ch;
     return NULL;
   }
 
-  LIST_ITERATOR *char_i = newListIterator(list);
+  LIST_ITERATOR *char_i = newListIterator(keyword_narrow_chars(list, name,
+							       prototype));
   ITERATE_LIST(ch, char_i) {
     if(must_see && !can_see_char(looker, ch))
       continue;
@@ -538,12 +571,14 @@ OBJ_DATA *find_obj(CHAR_DATA *looker, LIST *list, int num,
   int uid = name_as_uid(name);
   if(uid != NOTHING) {
     obj = propertyTableGet(obj_table, uid);
-    if(listIn(list, obj) && can_see_obj(looker, obj))
+    if((list == object_list ? setIn(object_set, obj) : listIn(list, obj)) &&
+       can_see_obj(looker, obj))
       return obj;
     return NULL;
   }
 
-  LIST_ITERATOR *obj_i = newListIterator(list);
+  LIST_ITERATOR *obj_i = newListIterator(keyword_narrow_objs(list, name,
+							     prototype));
   ITERATE_LIST(obj, obj_i) {
     if(must_see && !can_see_obj(looker, obj))
       continue;
@@ -566,9 +601,11 @@ OBJ_DATA *find_obj(CHAR_DATA *looker, LIST *list, int num,
 //
 LIST *find_all_chars(CHAR_DATA *looker, LIST *list, const char *name,
 		     const char *prototype, bool must_see) {
+  int         uid = name_as_uid(name);
+  if(uid == NOBODY)
+    list = keyword_narrow_chars(list, name, prototype);
   LIST_ITERATOR *char_i = newListIterator(list);
   LIST *char_list = newList();
-  int         uid = name_as_uid(name);
   CHAR_DATA *ch;
 
   ITERATE_LIST(ch, char_i) {
@@ -589,10 +626,11 @@ LIST *find_all_chars(CHAR_DATA *looker, LIST *list, const char *name,
 //
 LIST *find_all_objs(CHAR_DATA *looker, LIST *list, const char *name, 
 		    const char *prototype, bool must_see) {
-
+  int              uid = name_as_uid(name);
+  if(uid == NOTHING)
+    list = keyword_narrow_objs(list, name, prototype);
   LIST_ITERATOR *obj_i = newListIterator(list);
   LIST       *obj_list = newList();
-  int              uid = name_as_uid(name);
   OBJ_DATA *obj;
 
   ITERATE_LIST(obj, obj_i) {
@@ -1693,3 +1731,9 @@ bool do_rename(CHAR_DATA *ch,const char *type,const char *from,const char *to) {
   // failed!
   return FALSE;
 }
+
+void block_thread_signals(void) {
+  sigset_t signals;
+  sigfillset(&signals);
+  pthread_sigmask(SIG_BLOCK, &signals, NULL);
+}
@@ -162,6 +162,11 @@ const char *strcpyto      (char *to, const char *from, char end);
 // utilities for game functioning
 //*****************************************************************************
 
+// called at the start of every thread besides the game's, so signals meant for
+// the game (like the timer that stops scripts that run too long) always go to
+// the game's thread
+void block_thread_signals(void);
+
 // remove the thing from the game, and delete it
 void         extract_mobile(CHAR_DATA *ch);
 void            extract_obj(OBJ_DATA  *obj);
@@ -173,6 +178,11 @@ void   extract_mobile_final(CHAR_DATA *ch);
 void      extract_obj_final(OBJ_DATA  *obj);
 void     extract_room_final(ROOM_DATA *room);
 
+// run the final extractions on everything that has been extracted so far. This
+// is done at the end of every pulse, but can be done early if something needs
+// what it has extracted to be gone right away
+void extract_pending(void);
+
 char *get_time             ( void );
 void  communicate          ( CHAR_DATA *dMob, char *txt, int range );
 void  load_muddata         ( void );
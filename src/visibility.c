@@ -0,0 +1,128 @@
+//*****************************************************************************
+//
+// visibility.c
+//
+// Remembers who could see what for the rest of a pulse. Instead of hunting
+// down everything remembered about a thing when it changes, we count changes.
+// Each thing that changes notes which change it was, and each thing remembered
+// notes how many changes there had been when it was worked out. If either the
+// viewer or the target has changed since then, it is worked out again.
+//
+//*****************************************************************************
+
+#include "mud.h"
+#include "utils.h"
+#include "visibility.h"
+
+
+
+//*****************************************************************************
+// local datastructures, functions, and defines
+//*****************************************************************************
+
+// viewer : map of target : what we remember. What we remember is stored
+// directly as the value; how many changes there had been when it was worked
+// out, shifted up one bit, with whether it was seen in the lowest bit
+MAP            *sights = NULL;
+
+// thing : the change it last had, stored directly as the value
+MAP      *last_changes = NULL;
+unsigned long  changes = 1;
+
+// are we remembering anything this pulse?
+bool  visibility_on = FALSE;
+
+// how often we have been asked, and been able to answer
+int   visibility_hits = 0;
+int visibility_misses = 0;
+
+//
+// returns the last change that happened to the thing, or 0 if it has not
+// changed this pulse
+unsigned long visibility_last_change(const void *thing) {
+  return (unsigned long)mapGet(last_changes, thing);
+}
+
+//
+// delete everything we remember
+void visibility_forget_all(void) {
+  MAP_ITERATOR *viewer_i = newMapIterator(sights);
+  const void     *viewer = NULL;
+  MAP            *seen = NULL;
+  ITERATE_MAP(viewer, seen, viewer_i)
+    deleteMap(seen);
+  deleteMapIterator(viewer_i);
+  deleteMap(sights);
+  deleteMap(last_changes);
+  sights       = newMap(NULL, NULL);
+  last_changes = newMap(NULL, NULL);
+}
+
+
+
+//*****************************************************************************
+// implementation of visibility.h
+//*****************************************************************************
+void init_visibility(void) {
+  sights        = newMap(NULL, NULL);
+  last_changes  = newMap(NULL, NULL);
+  visibility_on = mudsettingGetBool("visibility_cache");
+}
+
+void visibility_pulse(void) {
+  if(mapSize(sights) > 0 || mapSize(last_changes) > 0)
+    visibility_forget_all();
+  visibility_on = mudsettingGetBool("visibility_cache");
+}
+
+bool visibility_recall(CHAR_DATA *ch, const void *target, bool *seen) {
+  if(!visibility_on)
+    return FALSE;
+
+  MAP         *seen_by = mapGet(sights, ch);
+  unsigned long  sight = 0;
+  if(seen_by != NULL)
+    sight = (unsigned long)mapGet(seen_by, target);
+  if(sight == 0 ||
+     visibility_last_change(ch)     > (sight >> 1) ||
+     visibility_last_change(target) > (sight >> 1)) {
+    visibility_misses++;
+    return FALSE;
+  }
+
+  visibility_hits++;
+  *seen = (sight & 1);
+  return TRUE;
+}
+
+void visibility_remember(CHAR_DATA *ch, const void *target, bool seen) {
+  if(!visibility_on)
+    return;
+
+  MAP *seen_by = mapGet(sights, ch);
+  if(seen_by == NULL) {
+    seen_by = newMap(NULL, NULL);
+    mapPut(sights, ch, seen_by);
+  }
+  mapPut(seen_by, target, (void *)((changes << 1) | (seen ? 1 : 0)));
+}
+
+void visibility_changed(const void *thing) {
+  // there is nothing remembered to forget, and nowhere to note it yet
+  if(!visibility_on || last_changes == NULL)
+    return;
+  mapPut(last_changes, thing, (void *)++changes);
+}
+
+void visibility_stats(BUFFER *buf) {
+  int asked = visibility_hits + visibility_misses;
+  bprintf(buf, "Visibility remembered: %s\r\n",
+	  (visibility_on ? "yes" : "no (set visibility_cache to turn on)"));
+  bprintf(buf, "Visibility checks:     %d (%d remembered, %.1f%%)\r\n",
+	  asked, visibility_hits,
+	  (asked ? visibility_hits * 100.0 / asked : 0));
+}
+
+void visibility_stats_clear(void) {
+  visibility_hits = visibility_misses = 0;
+}
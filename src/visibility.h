@@ -0,0 +1,51 @@
+#ifndef VISIBILITY_H
+#define VISIBILITY_H
+//*****************************************************************************
+//
+// visibility.h
+//
+// Remembers, for the rest of a pulse, whether one character could see another
+// character, object, or exit, so can_see_char, can_see_obj and can_see_exit
+// only have to run their checks once per pair each pulse. Messages to a room,
+// room descriptions, and searches otherwise ask the same questions over and
+// over again.
+//
+// Remembering is off unless the mud setting "visibility_cache" is turned on,
+// and only takes effect from the next pulse. What was remembered about a thing
+// is forgotten when its position, room, or hidden level changes, when it
+// enters or leaves the game, or when visibility_changed is called for it.
+// Anything else see checks depend on (light, or the state of a check added
+// from Python) may be up to a pulse out of date; checks that need to see such
+// changes straight away should call visibility_changed themselves.
+//
+//*****************************************************************************
+
+//
+// prepare visibility remembering for use
+void init_visibility(void);
+
+//
+// forget everything we remember. Called once each pulse
+void visibility_pulse(void);
+
+//
+// if we remember whether ch could see the target this pulse, set seen and
+// return TRUE. Otherwise, return FALSE
+bool visibility_recall(CHAR_DATA *ch, const void *target, bool *seen);
+
+//
+// remember whether ch could see the target, for the rest of the pulse
+void visibility_remember(CHAR_DATA *ch, const void *target, bool seen);
+
+//
+// something about the character, object, or exit has changed that could change
+// who it can see, or who can see it; forget what we remember about it
+void visibility_changed(const void *thing);
+
+//
+// append how often we were able to use what we remembered to the buffer, or
+// start counting again from zero
+void visibility_stats      (BUFFER *buf);
+void visibility_stats_clear(void);
+
+#endif // VISIBILITY_H
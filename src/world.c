@@ -7,13 +7,17 @@
 //*****************************************************************************
 
 #include <sys/stat.h>
+#include <dirent.h>
 
 #include "mud.h"
 #include "utils.h"
 #include "zone.h"
 #include "storage.h"
 #include "prototype.h"
+#include "world_image.h"
 #include "world.h"
+#include "idle_rooms.h"
+#include "path.h"
 
 
 
@@ -49,6 +53,9 @@ struct world_data {
   HASHTABLE      *rooms; // this table is a communal table for rooms. Used for
   HASHTABLE *type_table; // types, and their functions
   HASHTABLE      *zones; // a table of all the zones we have
+  WORLD_IMAGE    *image; // our files, packed into one image, if we have one
+  LIST   **phase_zones; // the zones pulsed on each pulse of the minute
+  int       num_phases; // how many pulses there were in a minute, when built
 };
 
 WORLD_TYPE_DATA *newWorldTypeData(void *reader, void *storer, void *deleter,
@@ -67,6 +74,51 @@ void deleteWorldTypeData(WORLD_TYPE_DATA *data) {
 }
 
 
+//
+// add the zone to the list of zones pulsed on its pulse of the minute
+void world_phase_add(WORLD_DATA *world, ZONE_DATA *zone) {
+  zoneSetPhase(zone, string_hash(zoneGetKey(zone)) % world->num_phases);
+  listPut(world->phase_zones[zoneGetPhase(zone)], zone);
+}
+
+//
+// forget which zones are pulsed when
+void world_phase_clear(WORLD_DATA *world) {
+  int i;
+  if(world->phase_zones != NULL) {
+    for(i = 0; i < world->num_phases; i++)
+      deleteList(world->phase_zones[i]);
+    free(world->phase_zones);
+  }
+  world->phase_zones = NULL;
+  world->num_phases  = 0;
+}
+
+//
+// sort our zones by which pulse of the minute they are pulsed on. Done the
+// first time we pulse, since the length of a pulse is not known until our
+// settings are loaded, and again if it changes
+void world_phase_build(WORLD_DATA *world) {
+  HASH_ITERATOR *zone_i = NULL;
+  const char       *key = NULL;
+  ZONE_DATA       *zone = NULL;
+  int                 i;
+
+  world_phase_clear(world);
+  if((world->num_phases = 1 MINUTE) <= 0) {
+    world->num_phases = 0;
+    return;
+  }
+  world->phase_zones = malloc(sizeof(LIST *) * world->num_phases);
+  for(i = 0; i < world->num_phases; i++)
+    world->phase_zones[i] = newList();
+
+  zone_i = newHashIterator(world->zones);
+  ITERATE_HASH(key, zone, zone_i)
+    world_phase_add(world, zone);
+  deleteHashIterator(zone_i);
+}
+
 //
 // transfers all of the types from the world to the zone
 void world_types_to_zone_types(WORLD_DATA *world, ZONE_DATA *zone) {
@@ -90,6 +142,9 @@ WORLD_DATA *newWorld(void) {
   world->zones      = newHashtable();
   world->rooms      = newHashtableSize(SMALL_WORLD);
   world->path       = strdup("");
+  world->image      = NULL;
+  world->phase_zones = NULL;
+  world->num_phases  = 0;
   return world;
 }
 
@@ -111,15 +166,20 @@ void deleteWorld(WORLD_DATA *world) {
     zoneSetWorld(zone, NULL);
   deleteHashIterator(zone_i);
   deleteHashtable(world->zones);
+  world_phase_clear(world);
 
   deleteHashtable(world->rooms);
+  if(world->image) worldImageClose(world->image);
   free(world->path);
 
   free(world);
 }
 
 ZONE_DATA *worldRemoveZone(WORLD_DATA *world, const char *key) {
-  return hashRemove(world->zones, key);
+  ZONE_DATA *zone = hashRemove(world->zones, key);
+  if(zone != NULL && world->phase_zones != NULL)
+    listRemove(world->phase_zones[zoneGetPhase(zone)], zone);
+  return zone;
 }
 
 bool worldSave(WORLD_DATA *world, const char *dirpath) {
@@ -144,14 +204,20 @@ bool worldSave(WORLD_DATA *world, const char *dirpath) {
   sprintf(buf, "%s/world", dirpath);
   storage_write(set, buf);
   storage_close(set);
+  if(world->image)
+    worldImageInvalidate(world->image, "world");
   return TRUE;
 }
 
 void worldInit(WORLD_DATA *world) {
-  char buf[MAX_BUFFER];
-  sprintf(buf, "%s/world", world->path);
+  // see if we can load our files from a packed image instead of from disk
+  if(mudsettingGetBool("world_image")) {
+    if(world->image) worldImageClose(world->image);
+    if((world->image = worldImageOpen(world->path)) != NULL)
+      log_string("Loading world from the image of %s.", world->path);
+  }
 
-  STORAGE_SET       *set = storage_read(buf);
+  STORAGE_SET       *set = worldStorageRead(world, "world");
   STORAGE_SET_LIST *list = read_list(set, "zones");
   STORAGE_SET  *zone_set = NULL;
 
@@ -162,20 +228,26 @@ void worldInit(WORLD_DATA *world) {
 
     if(zone != NULL) {
       hashPut(world->zones, key, zone);
+      if(world->phase_zones != NULL)
+	world_phase_add(world, zone);
       world_types_to_zone_types(world, zone);
     }
   }
   storage_close(set);
 }
 
-void worldPulse(WORLD_DATA *world) {
-  HASH_ITERATOR *zone_i = newHashIterator(world->zones);
-  const char       *key = NULL;
-  ZONE_DATA       *zone = NULL;
+void worldPulse(WORLD_DATA *world, int pulse) {
+  if(world->num_phases != 1 MINUTE)
+    world_phase_build(world);
+  if(world->num_phases == 0)
+    return;
 
-  ITERATE_HASH(key, zone, zone_i)
+  LIST_ITERATOR *zone_i = 
+    newListIterator(world->phase_zones[pulse % world->num_phases]);
+  ZONE_DATA       *zone = NULL;
+  ITERATE_LIST(zone, zone_i) {
     zonePulse(zone);
-  deleteHashIterator(zone_i);
+  } deleteListIterator(zone_i);
 }
 
 void worldForceReset(WORLD_DATA *world) {
@@ -225,9 +297,14 @@ void worldPutRoom(WORLD_DATA *world, const char *key, ROOM_DATA *room) {
 }
 
 ROOM_DATA *worldGetRoom(WORLD_DATA *world, const char *key) {
-  ROOM_DATA *room = NULL;
-  // see if we have it in the room hashtable
-  if( (room = hashGet(world->rooms, key)) == NULL) {
+  // see if we have it in the room hashtable, or it was unloaded for idling
+  ROOM_DATA *room = hashGet(world->rooms, key);
+  bool    loading = (room == NULL && world == gameworld);
+  if(loading) {
+    path_room_loading();
+    room = idle_room_restore(key);
+  }
+  if(room == NULL) {
 #ifdef MODULE_PERSISTENT
     if( (room = worldGetPersistentRoom(world, key)) == NULL) {
 #endif
@@ -236,14 +313,18 @@ ROOM_DATA *worldGetRoom(WORLD_DATA *world, const char *key) {
 	ZONE_DATA *zone = hashGet(world->zones, locale);
 	if(zone != NULL) {
 	  PROTO_DATA *rproto = zoneGetType(zone, "rproto", name);
-	  if(rproto != NULL && (room = protoRoomRun(rproto)) != NULL)
+	  if(rproto != NULL && (room = protoRoomRun(rproto)) != NULL) {
 	    worldPutRoom(world, protoGetKey(rproto), room);
+	    idle_room_born(room);
+	  }
 	}
       }
 #ifdef MODULE_PERSISTENT
     }
 #endif
   }
+  if(loading)
+    path_room_loaded(key, room);
   return room;
 }
 
@@ -266,6 +347,8 @@ void worldPutZone(WORLD_DATA *world, ZONE_DATA *zone) {
 
   // connect the world and zone
   hashPut(world->zones, zoneGetKey(zone), zone);
+  if(world->phase_zones != NULL)
+    world_phase_add(world, zone);
   zoneSetWorld(zone, world);
 
   // make the zone's directory
@@ -348,3 +431,56 @@ void worldAddForgetfulType(WORLD_DATA *world, const char *type, void *reader,
 ZONE_DATA *worldGetZone(WORLD_DATA *world, const char *key) {
   return hashGet(world->zones, key);
 }
+
+
+
+//*****************************************************************************
+// access to the files in the world directory
+//*****************************************************************************
+STORAGE_SET *worldStorageRead(WORLD_DATA *world, const char *path) {
+  const char *data = NULL;
+  if(world->image && (data = worldImageGetFile(world->image, path)) != NULL)
+    return storage_read_string(data);
+  else {
+    char buf[MAX_BUFFER];
+    sprintf(buf, "%s/%s", world->path, path);
+    return storage_read(buf);
+  }
+}
+
+void worldStorageWrite(WORLD_DATA *world, const char *path, STORAGE_SET *set){
+  char buf[MAX_BUFFER];
+  sprintf(buf, "%s/%s", world->path, path);
+  storage_write(set, buf);
+  if(world->image)
+    worldImageInvalidate(world->image, path);
+}
+
+void worldStorageRemove(WORLD_DATA *world, const char *path) {
+  char buf[MAX_BUFFER];
+  sprintf(buf, "%s/%s", world->path, path);
+  unlink(buf);
+  if(world->image)
+    worldImageInvalidate(world->image, path);
+}
+
+LIST *worldStorageList(WORLD_DATA *world, const char *path) {
+  LIST *key_list = NULL;
+  if(world->image && (key_list = worldImageGetDir(world->image, path)) != NULL)
+    return key_list;
+  else {
+    char buf[MAX_BUFFER];
+    sprintf(buf, "%s/%s", world->path, path);
+    DIR *dir = opendir(buf);
+    struct dirent *entry = NULL;
+    key_list = newList();
+    if(dir != NULL) {
+      for(entry = readdir(dir); entry; entry = readdir(dir)) {
+	if(!startswith(entry->d_name, "."))
+	  listPut(key_list, strdup(entry->d_name));
+      }
+      closedir(dir);
+    }
+    return key_list;
+  }
+}
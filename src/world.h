@@ -28,8 +28,11 @@ bool worldSave(WORLD_DATA *world, const char *dirpath);
 void worldInit(WORLD_DATA *world);
 
 //
-// Pulse all of the zones in the world
-void worldPulse(WORLD_DATA *world);
+// Pulse the zones in the world. Should be called every game pulse, with the
+// number of pulses run so far. Each zone is pulsed once a minute, but zones
+// are spread out over the minute by their keys, so they do not all pulse (and
+// reset) at the same time
+void worldPulse(WORLD_DATA *world, int pulse);
 void worldForceReset(WORLD_DATA *world);
 
 //
@@ -64,4 +67,15 @@ const char *worldGetZonePath(WORLD_DATA *world, const char *key);
 void            worldSetPath(WORLD_DATA *world, const char *path);
 const char     *worldGetPath(WORLD_DATA *world);
 
+//
+// read, write, remove, and list files in the world directory. Paths are
+// relative to the directory (e.g. zones/examples/zone). If the world was
+// loaded with a world image, reads and listings are resolved from the image
+// where possible. See world_image.h
+STORAGE_SET *worldStorageRead(WORLD_DATA *world, const char *path);
+void        worldStorageWrite(WORLD_DATA *world, const char *path,
+			      STORAGE_SET *set);
+void       worldStorageRemove(WORLD_DATA *world, const char *path);
+LIST        *worldStorageList(WORLD_DATA *world, const char *path);
+
 #endif // __WORLD_H
@@ -0,0 +1,458 @@
+//*****************************************************************************
+//
+// world_image.c
+//
+// Packs a world directory into a single, indexed file that can be mapped
+// into memory, and resolves lookups of files and directory listings from it.
+// Paths are looked up through a perfect hash table built when the image is
+// packed, so every lookup costs two hashes and one string comparison.
+//
+//*****************************************************************************
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <dirent.h>
+
+#include "mud.h"
+#include "utils.h"
+#include "world_image.h"
+
+
+
+//*****************************************************************************
+// local datastructures, defines, and functions
+//*****************************************************************************
+
+// change the version whenever the layout of images changes
+#define WORLD_IMAGE_MAGIC      "NMWIMAGE"
+#define WORLD_IMAGE_VERSION             1
+
+// the most seeds we will try for one bucket before giving up on our image
+#define MAX_DISPLACEMENT          1000000
+
+// an image is laid out as its header, followed by the bucket displacements,
+// then the slots of the hash table, then the entries, and then the paths and
+// contents of every entry. All offsets are from the start of the image.
+typedef struct {
+  char           magic[8];
+  unsigned int    version;
+  unsigned int    entries; // how many files and directories do we have?
+  unsigned int    buckets; // how many buckets in the first level of the hash?
+  unsigned int      slots; // how many slots in the second level of the hash?
+  unsigned int       size; // how big is the whole image?
+} IMAGE_HEADER;
+
+typedef struct {
+  unsigned int       path; // the offset of our path
+  unsigned int       data; // the offset of our contents
+  unsigned int        len; // how long are our contents?
+  unsigned int        dir; // are we a directory?
+} IMAGE_ENTRY;
+
+struct world_image {
+  char                *map; // the image, mapped into memory
+  unsigned int        size; // how large is the map?
+  IMAGE_HEADER     *header;
+  unsigned int       *disp; // the seed used to hash each bucket's contents
+  unsigned int      *slots; // the entry in each slot, or -1 if empty
+  IMAGE_ENTRY     *entries;
+  HASHTABLE         *dirty; // directories that have been written to
+};
+
+// an entry before it has been packed into an image
+typedef struct {
+  char               *path;
+  char               *data;
+  unsigned int        len;
+  bool                dir;
+} IMAGE_FILE;
+
+//
+// hash a path with the specified seed. Based on FNV-1a, with a final mix so
+// different seeds scatter the same paths differently
+unsigned int image_hash(unsigned int seed, const char *key) {
+  unsigned int h = 2166136261u;
+  int i;
+  for(i = 0; i < 4; i++) {
+    h ^= (seed >> (i * 8)) & 0xFF;
+    h *= 16777619u;
+  }
+  for(; *key; key++) {
+    h ^= (unsigned char)*key;
+    h *= 16777619u;
+  }
+  h ^= h >> 16;
+  h *= 0x85ebca6bu;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35u;
+  h ^= h >> 16;
+  return h;
+}
+
+//
+// returns the path for something in the world directory
+void image_full_path(char *buf, const char *world_path, const char *path) {
+  if(*path)
+    sprintf(buf, "%s/%s", world_path, path);
+  else
+    strcpy(buf, world_path);
+}
+
+//
+// read in the entire contents of a file
+char *image_read_file(const char *fname, unsigned int *len) {
+  FILE *fl = fopen(fname, "r");
+  if(fl == NULL)
+    return NULL;
+  else {
+    unsigned int size = 0, max = MAX_BUFFER, amnt = 0;
+    char         *buf = malloc(max + 1);
+    while((amnt = fread(buf + size, 1, max - size, fl)) > 0) {
+      size += amnt;
+      if(size == max) {
+	max *= 2;
+	buf  = realloc(buf, max + 1);
+      }
+    }
+    fclose(fl);
+    buf[size] = '\0';
+    *len      = size;
+    return buf;
+  }
+}
+
+//
+// add the directory at the path, and everything in it, to our list of files.
+// Like zoneGetTypeKeys, anything starting with a . is skipped
+void image_collect(LIST *files, const char *world_path, const char *path) {
+  char   full[MAX_BUFFER];
+  image_full_path(full, world_path, path);
+
+  DIR *dir = opendir(full);
+  if(dir == NULL)
+    return;
+  else {
+    BUFFER        *names = newBuffer(1);
+    struct dirent *entry = NULL;
+    IMAGE_FILE     *file = NULL;
+
+    for(entry = readdir(dir); entry; entry = readdir(dir)) {
+      char child[MAX_BUFFER], child_full[MAX_BUFFER];
+      struct stat sbuf;
+      if(startswith(entry->d_name, "."))
+	continue;
+      if(*path)
+	sprintf(child, "%s/%s", path, entry->d_name);
+      else
+	strcpy(child, entry->d_name);
+      image_full_path(child_full, world_path, child);
+      if(stat(child_full, &sbuf) != 0)
+	continue;
+
+      bprintf(names, "%s\n", entry->d_name);
+      if(S_ISDIR(sbuf.st_mode))
+	image_collect(files, world_path, child);
+      else if(S_ISREG(sbuf.st_mode)) {
+	file       = calloc(1, sizeof(IMAGE_FILE));
+	file->path = strdup(child);
+	file->data = image_read_file(child_full, &file->len);
+	if(file->data == NULL)
+	  file->data = strdup("");
+	listQueue(files, file);
+      }
+    }
+    closedir(dir);
+
+    file       = calloc(1, sizeof(IMAGE_FILE));
+    file->path = strdup(path);
+    file->data = strdup(bufferString(names));
+    file->len  = bufferLength(names);
+    file->dir  = TRUE;
+    listQueue(files, file);
+    deleteBuffer(names);
+  }
+}
+
+void deleteImageFile(IMAGE_FILE *file) {
+  if(file->path) free(file->path);
+  if(file->data) free(file->data);
+  free(file);
+}
+
+//
+// used for sorting our buckets from the fullest to the emptiest
+int   *image_bucket_sizes = NULL;
+int image_bucket_cmp(const void *a, const void *b) {
+  return image_bucket_sizes[*(const int *)b] - image_bucket_sizes[*(const int *)a];
+}
+
+//
+// build a perfect hash table for the files. Every file is placed in a bucket
+// by its hash, and then for each bucket we search for a seed that puts all
+// of its files into empty slots. Returns FALSE if no table could be found
+bool image_perfect_hash(IMAGE_FILE **files, unsigned int num,
+			unsigned int buckets, unsigned int num_slots,
+			unsigned int *disp, unsigned int *slots) {
+  int      *sizes = calloc(buckets, sizeof(int));
+  int      *start = calloc(buckets + 1, sizeof(int));
+  int     *member = calloc(num, sizeof(int));
+  int      *order = calloc(buckets, sizeof(int));
+  unsigned int *tried = calloc(num, sizeof(unsigned int));
+  unsigned int i, j, b;
+  bool     ok = TRUE;
+
+  // sort our files by which bucket they belong to
+  for(i = 0; i < num; i++)
+    sizes[image_hash(0, files[i]->path) % buckets]++;
+  for(b = 0; b < buckets; b++) {
+    start[b+1] = start[b] + sizes[b];
+    order[b]   = b;
+  }
+  for(i = 0; i < num; i++) {
+    b = image_hash(0, files[i]->path) % buckets;
+    member[start[b]++] = i;
+  }
+  for(b = 0; b < buckets; b++)
+    start[b] -= sizes[b];
+
+  // place the biggest buckets first, while the table is still empty
+  image_bucket_sizes = sizes;
+  qsort(order, buckets, sizeof(int), image_bucket_cmp);
+  for(i = 0; i < num_slots; i++)
+    slots[i] = (unsigned int)-1;
+
+  for(i = 0; ok && i < buckets && sizes[order[i]] > 0; i++) {
+    unsigned int d = 0;
+    b = order[i];
+    for(d = 1; d < MAX_DISPLACEMENT; d++) {
+      bool fits = TRUE;
+      for(j = 0; fits && j < sizes[b]; j++) {
+	unsigned int slot =
+	  image_hash(d, files[member[start[b]+j]]->path) % num_slots;
+	tried[j] = slot;
+	if(slots[slot] != (unsigned int)-1)
+	  fits = FALSE;
+	else {
+	  unsigned int k;
+	  for(k = 0; fits && k < j; k++)
+	    if(tried[k] == slot)
+	      fits = FALSE;
+	}
+      }
+      if(fits)
+	break;
+    }
+
+    if(d == MAX_DISPLACEMENT)
+      ok = FALSE;
+    else {
+      disp[b] = d;
+      for(j = 0; j < sizes[b]; j++)
+	slots[tried[j]] = member[start[b]+j];
+    }
+  }
+
+  free(sizes);
+  free(start);
+  free(member);
+  free(order);
+  free(tried);
+  return ok;
+}
+
+//
+// find the entry for the path, or -1 if it is not in the image
+int image_find(WORLD_IMAGE *image, const char *path) {
+  if(image->header->entries == 0)
+    return -1;
+  else {
+    unsigned int b = image_hash(0, path) % image->header->buckets;
+    unsigned int s = image_hash(image->disp[b], path) % image->header->slots;
+    unsigned int e = image->slots[s];
+    if(e >= image->header->entries ||
+       strcmp(image->map + image->entries[e].path, path))
+      return -1;
+    return e;
+  }
+}
+
+//
+// returns the directory the path is in
+void image_parent(char *buf, const char *path) {
+  char *last = NULL;
+  strcpy(buf, path);
+  if((last = strrchr(buf, '/')) != NULL)
+    *last = '\0';
+  else
+    *buf = '\0';
+}
+
+
+
+//*****************************************************************************
+// implementation of world_image.h
+//*****************************************************************************
+bool worldImageBuild(const char *world_path) {
+  LIST          *list = newList();
+  image_collect(list, world_path, "");
+
+  unsigned int    num = listSize(list);
+  unsigned int   i, buckets = num / 2 + 1, num_slots = num + num / 4 + 1;
+  IMAGE_FILE  **files = calloc(num + 1, sizeof(IMAGE_FILE *));
+  unsigned int  *disp = calloc(buckets, sizeof(unsigned int));
+  unsigned int *slots = calloc(num_slots, sizeof(unsigned int));
+  IMAGE_ENTRY *entries = calloc(num + 1, sizeof(IMAGE_ENTRY));
+  IMAGE_FILE    *file = NULL;
+  bool        success = FALSE;
+
+  i = 0;
+  LIST_ITERATOR *file_i = newListIterator(list);
+  ITERATE_LIST(file, file_i) {
+    files[i++] = file;
+  } deleteListIterator(file_i);
+
+  if(!image_perfect_hash(files, num, buckets, num_slots, disp, slots))
+    log_string("ERROR: could not build an index for world image of %s.",
+	       world_path);
+  else {
+    IMAGE_HEADER header;
+    char fname[MAX_BUFFER], tmpname[MAX_BUFFER];
+    FILE *fl = NULL;
+
+    // figure out where everything goes
+    unsigned int offset = sizeof(IMAGE_HEADER) +
+      sizeof(unsigned int) * (buckets + num_slots) + sizeof(IMAGE_ENTRY) * num;
+    for(i = 0; i < num; i++) {
+      entries[i].path = offset;
+      offset         += strlen(files[i]->path) + 1;
+      entries[i].data = offset;
+      entries[i].len  = files[i]->len;
+      entries[i].dir  = files[i]->dir;
+      offset         += files[i]->len + 1;
+    }
+
+    memset(&header, 0, sizeof(IMAGE_HEADER));
+    memcpy(header.magic, WORLD_IMAGE_MAGIC, sizeof(header.magic));
+    header.version = WORLD_IMAGE_VERSION;
+    header.entries = num;
+    header.buckets = buckets;
+    header.slots   = num_slots;
+    header.size    = offset;
+
+    // write to a temporary file, so nothing ever maps a half-written image
+    sprintf(fname,   "%s.image", world_path);
+    sprintf(tmpname, "%s.image.tmp", world_path);
+    if((fl = fopen(tmpname, "w")) == NULL)
+      log_string("ERROR: could not open %s for writing.", tmpname);
+    else {
+      fwrite(&header, sizeof(IMAGE_HEADER), 1, fl);
+      fwrite(disp,    sizeof(unsigned int), buckets, fl);
+      fwrite(slots,   sizeof(unsigned int), num_slots, fl);
+      fwrite(entries, sizeof(IMAGE_ENTRY), num, fl);
+      for(i = 0; i < num; i++) {
+	fwrite(files[i]->path, 1, strlen(files[i]->path) + 1, fl);
+	fwrite(files[i]->data, 1, files[i]->len + 1, fl);
+      }
+      success = (ferror(fl) == 0);
+      fclose(fl);
+      if(success && rename(tmpname, fname) == 0)
+	log_string("Packed %d files and directories from %s into %s.",
+		   num, world_path, fname);
+      else {
+	log_string("ERROR: could not write world image %s.", fname);
+	unlink(tmpname);
+	success = FALSE;
+      }
+    }
+  }
+
+  free(files);
+  free(disp);
+  free(slots);
+  free(entries);
+  deleteListWith(list, deleteImageFile);
+  return success;
+}
+
+WORLD_IMAGE *worldImageOpen(const char *world_path) {
+  char fname[MAX_BUFFER];
+  struct stat sbuf;
+  int fd = -1;
+  sprintf(fname, "%s.image", world_path);
+
+  if((fd = open(fname, O_RDONLY)) < 0)
+    return NULL;
+  if(fstat(fd, &sbuf) != 0 || sbuf.st_size < sizeof(IMAGE_HEADER)) {
+    close(fd);
+    return NULL;
+  }
+
+  char *map = mmap(NULL, sbuf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if(map == MAP_FAILED)
+    return NULL;
+
+  // make sure it's an image we understand, and it's all there
+  IMAGE_HEADER *header = (IMAGE_HEADER *)map;
+  if(memcmp(header->magic, WORLD_IMAGE_MAGIC, sizeof(header->magic)) ||
+     header->version != WORLD_IMAGE_VERSION ||
+     header->size    != sbuf.st_size) {
+    log_string("ERROR: %s is not a valid world image. Ignoring it.", fname);
+    munmap(map, sbuf.st_size);
+    return NULL;
+  }
+
+  WORLD_IMAGE *image = malloc(sizeof(WORLD_IMAGE));
+  image->map     = map;
+  image->size    = sbuf.st_size;
+  image->header  = header;
+  image->disp    = (unsigned int *)(map + sizeof(IMAGE_HEADER));
+  image->slots   = image->disp + header->buckets;
+  image->entries = (IMAGE_ENTRY *)(image->slots + header->slots);
+  image->dirty   = newHashtable();
+  return image;
+}
+
+void worldImageClose(WORLD_IMAGE *image) {
+  munmap(image->map, image->size);
+  deleteHashtable(image->dirty);
+  free(image);
+}
+
+const char *worldImageGetFile(WORLD_IMAGE *image, const char *path) {
+  char parent[MAX_BUFFER];
+  int entry = image_find(image, path);
+  if(entry < 0 || image->entries[entry].dir)
+    return NULL;
+  image_parent(parent, path);
+  if(hashIn(image->dirty, parent))
+    return NULL;
+  return image->map + image->entries[entry].data;
+}
+
+LIST *worldImageGetDir(WORLD_IMAGE *image, const char *path) {
+  int entry = image_find(image, path);
+  if(entry < 0 || !image->entries[entry].dir || hashIn(image->dirty, path))
+    return NULL;
+  else {
+    LIST         *names = newList();
+    const char    *data = image->map + image->entries[entry].data;
+    const char     *end = NULL;
+    char name[MAX_BUFFER];
+    for(; (end = strchr(data, '\n')) != NULL; data = end + 1) {
+      strncpy(name, data, end - data);
+      name[end - data] = '\0';
+      listQueue(names, strdup(name));
+    }
+    return names;
+  }
+}
+
+void worldImageInvalidate(WORLD_IMAGE *image, const char *path) {
+  char parent[MAX_BUFFER];
+  image_parent(parent, path);
+  if(!hashIn(image->dirty, parent))
+    hashPut(image->dirty, parent, image);
+}
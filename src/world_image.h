@@ -0,0 +1,58 @@
+#ifndef __WORLD_IMAGE_H
+#define __WORLD_IMAGE_H
+//*****************************************************************************
+//
+// world_image.h
+//
+// Loading the world from its directory means an opendir for every type in
+// every zone, and an open and read for every single prototype, reset list,
+// and trigger. A world image packs the whole world directory into one file,
+// with an index for looking up any file or directory listing in it by its
+// path. At boot, the image is mapped into memory and lookups are resolved
+// from it directly.
+//
+// The world directory stays the source of truth. Images are built from it
+// with "make world-image" (or ./NakedMud -worldimage), and are only used if
+// the "world_image" mud setting is on. When something is written back to the
+// world directory, e.g. by OLC, the directory it was written to is no longer
+// trusted from the image, and is read from disk instead. If the directory is
+// edited by hand, the image must be rebuilt.
+//
+//*****************************************************************************
+
+typedef struct world_image WORLD_IMAGE;
+
+//
+// pack the world at the specified directory into an image, which is written
+// next to it (e.g. ../lib/world is packed into ../lib/world.image). Returns
+// TRUE if the image was successfully written.
+bool worldImageBuild(const char *world_path);
+
+//
+// map the image for the world at the specified directory into memory. Returns
+// NULL if no image exists, or it is not a valid image.
+WORLD_IMAGE *worldImageOpen(const char *world_path);
+
+//
+// unmap the image, and delete it from memory
+void worldImageClose(WORLD_IMAGE *image);
+
+//
+// returns the contents of the file at the path, relative to the world
+// directory (e.g. zones/examples/rproto/the_bar). Returns NULL if the file is
+// not in the image, or has been written to since the image was built.
+const char *worldImageGetFile(WORLD_IMAGE *image, const char *path);
+
+//
+// returns a list of the names of everything in the directory at the specified
+// path, relative to the world directory. Returns NULL if the directory is not
+// in the image, or has been written to since the image was built. List and
+// contents must be deleted after use.
+LIST *worldImageGetDir(WORLD_IMAGE *image, const char *path);
+
+//
+// The file at the path has been written to or deleted. From now on, lookups
+// for anything in its directory should go to disk.
+void worldImageInvalidate(WORLD_IMAGE *image, const char *path);
+
+#endif // __WORLD_IMAGE_H
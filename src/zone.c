@@ -9,7 +9,6 @@
 //*****************************************************************************
 
 #include <sys/stat.h>
-#include <dirent.h>
 
 #include "mud.h"
 #include "storage.h"
@@ -101,6 +100,7 @@ struct zone_data {
   HASHTABLE       *type_table; // a table of our types and their functions
   int             pulse_timer; // the timer duration
   int                   pulse; // how far down have we gone?
+  int                   phase; // which pulse of the minute we are pulsed on
   AUX_TABLE   *auxiliary_data; // additional data installed on us
 };
 
@@ -116,6 +116,7 @@ ZONE_DATA *newZone(const char *key) {
 
   zone->pulse_timer    = -1; // never resets
   zone->pulse          = -1;
+  zone->phase          = 0;
   zone->world          = NULL;
   zone->auxiliary_data = newAuxiliaryData(AUXILIARY_TYPE_ZONE);
 
@@ -137,6 +138,7 @@ void zoneCopyTo(ZONE_DATA *from, ZONE_DATA *to) {
   to->resettable = listCopyWith(from->resettable, strdup);
   to->pulse_timer = from->pulse_timer;
   to->pulse = from->pulse;
+  to->phase = from->phase;
   auxiliaryDataCopyTo(from->auxiliary_data, to->auxiliary_data);
 }
 
@@ -167,7 +169,7 @@ void zonePulse(ZONE_DATA *zone) {
   zone->pulse--;
   if(zone->pulse == 0) {
     zone->pulse = zone->pulse_timer;
-    hookRun("reset_zone", hookBuildInfo("str", zoneGetKey(zone)));
+    hookRun("reset_zone", "str", zoneGetKey(zone));
   }
 }
 
@@ -188,8 +190,8 @@ ZONE_DATA *zoneLoad(WORLD_DATA *world, const char *key) {
   zone->world = world;
 
   // first, load all of the zone data
-  sprintf(fname, "%s/zone", worldGetZonePath(world, zone->key));
-  STORAGE_SET  *set = storage_read(fname);
+  sprintf(fname, "zones/%s/zone", zone->key);
+  STORAGE_SET  *set = worldStorageRead(world, fname);
   zone->pulse_timer = read_int   (set, "pulse_timer");
   zoneSetName(zone,   read_string(set, "name"));
   zoneSetDesc(zone,   read_string(set, "desc"));
@@ -222,7 +224,7 @@ bool zoneSave(ZONE_DATA *zone) {
   char fname[MAX_BUFFER];
   
   // first, for our zone data
-  sprintf(fname, "%s/zone", worldGetZonePath(zone->world, zone->key));
+  sprintf(fname, "zones/%s/zone", zone->key);
   STORAGE_SET *set = new_storage_set();
   store_int   (set, "pulse_timer", zone->pulse_timer);
   store_string(set, "name",        zone->name);
@@ -232,7 +234,7 @@ bool zoneSave(ZONE_DATA *zone) {
   store_list  (set, "resettable",  gen_store_list(zone->resettable,
 						  store_resettable_room));
 
-  storage_write(set, fname);
+  worldStorageWrite(zone->world, fname, set);
   storage_close(set);
   return TRUE;
 }
@@ -254,6 +256,10 @@ int zoneGetPulse(ZONE_DATA *zone) {
   return zone->pulse;
 }
 
+int zoneGetPhase(ZONE_DATA *zone) {
+  return zone->phase;
+}
+
 WORLD_DATA *zoneGetWorld(ZONE_DATA *zone) { 
   return zone->world;
 }
@@ -289,6 +295,10 @@ void zoneSetPulse(ZONE_DATA *zone, int pulse_left) {
   zone->pulse = pulse_left;
 }
 
+void zoneSetPhase(ZONE_DATA *zone, int phase) {
+  zone->phase = phase;
+}
+
 void zoneSetWorld(ZONE_DATA *zone, WORLD_DATA *world) { 
   zone->world = world;
 }
@@ -319,19 +329,9 @@ void zoneSetEditors(ZONE_DATA *zone, const char *names) {
 // include the locale in the key. Just the name. List and contents must be
 // deleted after use.
 LIST *zoneGetTypeKeys(ZONE_DATA *zone, const char *type) {
-  LIST *key_list = newList();
   char path[MAX_BUFFER];
-  sprintf(path, "%s/%s", worldGetZonePath(zone->world, zone->key), type);
-  DIR *dir = opendir(path);
-  struct dirent *entry = NULL;
-  if(dir != NULL) {
-    for(entry = readdir(dir); entry; entry = readdir(dir)) {
-      if(!startswith(entry->d_name, "."))
-	listPut(key_list, strdup(entry->d_name));
-    }
-    closedir(dir);
-  }
-  return key_list;
+  sprintf(path, "zones/%s/%s", zone->key, type);
+  return worldStorageList(zone->world, path);
 }
 
 //
@@ -343,9 +343,8 @@ void *zoneLoadType(ZONE_DATA *zone, const char *type, const char *key) {
   else {
     char buf[MAX_BUFFER];
     void *data = NULL;
-    sprintf(buf, "%s/%s/%s", worldGetZonePath(zone->world, zone->key), 
-	    type, key);
-    STORAGE_SET *set = storage_read(buf);
+    sprintf(buf, "zones/%s/%s/%s", zone->key, type, key);
+    STORAGE_SET *set = worldStorageRead(zone->world, buf);
     if(set != NULL) {
       data = do_zone_read(tdata, set);
       hashPut(tdata->key_map, key, data);
@@ -376,8 +375,8 @@ void zoneSaveType(ZONE_DATA *zone, const char *type, const char *key) {
     STORAGE_SET      *set = do_zone_store(tdata, data);
     if(set != NULL) {
       char buf[MAX_BUFFER];
-      sprintf(buf,"%s/%s/%s",worldGetZonePath(zone->world,zone->key),type,key);
-      storage_write(set, buf);
+      sprintf(buf, "zones/%s/%s/%s", zone->key, type, key);
+      worldStorageWrite(zone->world, buf, set);
       storage_close(set);
     }
   }
@@ -390,8 +389,8 @@ void *zoneRemoveType(ZONE_DATA *zone, const char *type, const char *key) {
   else {
     // first, delete the file for it
     char buf[MAX_BUFFER];
-    sprintf(buf, "%s/%s/%s",worldGetZonePath(zone->world,zone->key),type,key);
-    unlink(buf);
+    sprintf(buf, "zones/%s/%s/%s", zone->key, type, key);
+    worldStorageRemove(zone->world, buf);
     // then remove it from the key map
     void *data = hashRemove(tdata->key_map, key);
     if(data != NULL)
@@ -54,6 +54,7 @@ void     zoneCopyTo(ZONE_DATA *from, ZONE_DATA *to);
 // various get functions for zones
 int      zoneGetPulseTimer(ZONE_DATA *zone);
 int           zoneGetPulse(ZONE_DATA *zone);
+int           zoneGetPhase(ZONE_DATA *zone);
 WORLD_DATA   *zoneGetWorld(ZONE_DATA *zone);
 const char    *zoneGetName(ZONE_DATA *zone);
 const char    *zoneGetDesc(ZONE_DATA *zone);
@@ -67,6 +68,7 @@ LIST    *zoneGetResettable(ZONE_DATA *zone);
 // various set functions for zones
 void zoneSetPulseTimer(ZONE_DATA *zone, int timer);
 void      zoneSetPulse(ZONE_DATA *zone, int pulse_left);
+void      zoneSetPhase(ZONE_DATA *zone, int phase);
 void      zoneSetWorld(ZONE_DATA *zone, WORLD_DATA *world);
 void       zoneSetName(ZONE_DATA *zone, const char *name);
 void       zoneSetDesc(ZONE_DATA *zone, const char *description);